@@ -0,0 +1,159 @@
+# Sources and modules of the plugin, shared by CrossTalk.pro and the benchmarks in bench/
+
+QT += sql network widgets
+
+INCLUDEPATH += $$PWD/includes
+
+HEADERS += \
+    $$PWD/includes/teamlog/logtypes.h \
+    $$PWD/includes/teamspeak/clientlib_publicdefinitions.h \
+    $$PWD/includes/teamspeak/public_rare_definitions.h \
+    $$PWD/includes/teamspeak/public_errors_rare.h \
+    $$PWD/includes/teamspeak/public_errors.h \
+    $$PWD/includes/teamspeak/public_definitions.h \
+    $$PWD/includes/plugin_definitions.h \
+    $$PWD/includes/ts3_functions.h \
+    $$PWD/includes/db.h \
+    $$PWD/includes/MMtoDB.h \
+    $$PWD/includes/ts_missing_definitions.h \
+    $$PWD/includes/dsp_helpers.h \
+    $$PWD/src/ts_settings_qt.h \
+    $$PWD/src/ts_infodata_qt.h \
+    $$PWD/src/ts_context_menu_qt.h \
+    $$PWD/src/ts_logging_qt.h \
+    $$PWD/src/ts_helpers_qt.h \
+    $$PWD/src/ts_ptt_qt.h \
+    $$PWD/src/ts_serverinfo_qt.h \
+    $$PWD/src/ts_serversinfo.h \
+    $$PWD/src/updater.h \
+    $$PWD/src/translator.h \
+    $$PWD/src/banner.h \
+    $$PWD/src/plugin.h \
+    $$PWD/src/config.h \
+    $$PWD/src/snt.h \
+    $$PWD/src/talkers.h \
+    $$PWD/src/simplepanner.h \
+    $$PWD/src/dsp_kernels.h \
+    $$PWD/src/dsp_oscillator.h \
+    $$PWD/src/dsp_random.h \
+    $$PWD/src/dsp_simd.h \
+    $$PWD/src/module.h \
+    $$PWD/src/dsp_volume.h \
+    $$PWD/src/dsp_volume_ducker.h \
+    $$PWD/src/dsp_volume_agmu.h \
+    $$PWD/src/volumes.h \
+    $$PWD/src/mod_ducker_channel.h \
+    $$PWD/src/mod_ducker_global.h \
+    $$PWD/src/mod_muter_channel.h \
+    $$PWD/src/mod_position_spread.h \
+    $$PWD/src/config_ducking.h \
+    $$PWD/src/fader_vertical.h \
+    $$PWD/src/settings_duck.h \
+    $$PWD/src/groupbox_position_spread.h \
+    $$PWD/src/settings_position_spread.h \
+    $$PWD/src/banner_frame.h \
+    $$PWD/src/mod_agmu.h \
+    $$PWD/src/voice_chain.h \
+    $$PWD/src/spsc_ring.h \
+    $$PWD/src/slot_table.h \
+    $$PWD/src/speaker_routing.h \
+    $$PWD/src/vbap.h \
+    $$PWD/src/triple_buffer.h \
+    $$PWD/src/dsp_fft.h \
+    $$PWD/src/telemetry.h \
+    $$PWD/src/plugin_qt.h \
+    $$PWD/src/sse_server.h \
+    $$PWD/src/http_request_parser.h \
+    $$PWD/src/event_history.h \
+    $$PWD/src/state_link.h \
+    $$PWD/src/groupbox_ducking.h \
+    $$PWD/src/pipeserver.h \
+    $$PWD/src/coalescing_queue.h \
+    $$PWD/src/version_qt.h
+
+SOURCES += \
+    $$PWD/src/ts_settings_qt.cpp \
+    $$PWD/src/ts_infodata_qt.cpp \
+    $$PWD/src/ts_context_menu_qt.cpp \
+    $$PWD/src/ts_logging_qt.cpp \
+    $$PWD/src/ts_helpers_qt.cpp \
+    $$PWD/src/ts_ptt_qt.cpp \
+    $$PWD/src/ts_serverinfo_qt.cpp \
+    $$PWD/src/ts_serversinfo.cpp \
+    $$PWD/src/updater.cpp \
+    $$PWD/src/translator.cpp \
+    $$PWD/src/banner.cpp \
+    $$PWD/src/plugin.cpp \
+    $$PWD/src/config.cpp \
+    $$PWD/src/snt.cpp \
+    $$PWD/src/talkers.cpp \
+    $$PWD/src/simplepanner.cpp \
+    $$PWD/src/vbap.cpp \
+    $$PWD/src/dsp_kernels.cpp \
+    $$PWD/src/dsp_oscillator.cpp \
+    $$PWD/src/dsp_fft.cpp \
+    $$PWD/src/module.cpp  \
+    $$PWD/src/dsp_volume.cpp \
+    $$PWD/src/dsp_volume_ducker.cpp \
+    $$PWD/src/dsp_volume_agmu.cpp \
+    $$PWD/src/volumes.cpp \
+    $$PWD/src/mod_ducker_channel.cpp \
+    $$PWD/src/mod_ducker_global.cpp \
+    $$PWD/src/mod_muter_channel.cpp \
+    $$PWD/src/mod_position_spread.cpp \
+    $$PWD/src/config_ducking.cpp \
+    $$PWD/src/fader_vertical.cpp \
+    $$PWD/src/settings_duck.cpp \
+    $$PWD/src/groupbox_position_spread.cpp \
+    $$PWD/src/settings_position_spread.cpp \
+    $$PWD/src/banner_frame.cpp \
+    $$PWD/src/mod_agmu.cpp \
+    $$PWD/src/voice_chain.cpp \
+    $$PWD/src/telemetry.cpp \
+    $$PWD/src/plugin_qt.cpp \
+    $$PWD/src/sse_server.cpp \
+    $$PWD/src/http_request_parser.cpp \
+    $$PWD/src/event_history.cpp \
+    $$PWD/src/state_link.cpp \
+    $$PWD/src/groupbox_ducking.cpp \
+    $$PWD/src/pipeserver.cpp \
+    $$PWD/src/version_qt.cpp
+
+FORMS += \
+    $$PWD/src/config.ui \
+    $$PWD/src/config_ducking.ui \
+    $$PWD/src/fader_vertical.ui \
+    $$PWD/src/groupbox_position_spread.ui \
+    $$PWD/src/banner_frame.ui \
+    $$PWD/src/groupbox_ducking.ui
+
+RESOURCES += \
+    $$PWD/CrossTalkRes.qrc
+
+# Radio Module
+include($$PWD/src/radio/Radio.pri) {
+    DEFINES += USE_RADIO
+    !build_pass:message( "Radio module included." )
+}
+
+# Positional Audio Module
+include($$PWD/src/positional_audio/PositionalAudio.pri) {
+    DEFINES += USE_POSITIONAL_AUDIO
+    !build_pass:message( "Positional Audio module included." )
+}
+
+#greaterThan(QT_MAJOR_VERSION, 4): include($$PWD/QtWebApp/QtWebApp.pri) {
+#    DEFINES += USE_QT_WEB_APP
+#    !build_pass:message( "QtWebApp included." )
+#}
+include ($$PWD/QtWebsocket/QtWebsocket.pri) {
+    DEFINES += USE_WEBSOCKET
+    !build_pass:message( "Websockets included." )
+}
+
+#DEFINES += CT_VERBOSE
+#DEFINES += CONSOLE_OUTPUT
+beta {
+    DEFINES += CROSSTALK_BETA
+    !build_pass:message( "Beta." )
+}
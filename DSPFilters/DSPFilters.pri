@@ -20,6 +20,7 @@ HEADERS += \
     $$PWD/includes/DspFilters/Params.h \
     $$PWD/includes/DspFilters/RBJ.h \
     $$PWD/includes/DspFilters/RootFinder.h \
+    $$PWD/includes/DspFilters/SimdCascade.h \
     $$PWD/includes/DspFilters/SmoothedFilter.h \
     $$PWD/includes/DspFilters/State.h \
     $$PWD/includes/DspFilters/Types.h \
@@ -42,4 +43,5 @@ SOURCES += \
     $$PWD/source/PoleFilter.cpp \
     $$PWD/source/RBJ.cpp \
     $$PWD/source/RootFinder.cpp \
+    $$PWD/source/SimdCascade.cpp \
     $$PWD/source/State.cpp
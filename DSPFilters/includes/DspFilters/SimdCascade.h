@@ -0,0 +1,162 @@
+/*******************************************************************************
+
+Vectorised cascade state, an addition to
+"A Collection of Useful C++ Classes for Digital Signal Processing"
+distributed under the same license as the rest of the collection.
+
+*******************************************************************************/
+
+#ifndef DSPFILTERS_SIMDCASCADE_H
+#define DSPFILTERS_SIMDCASCADE_H
+
+#include "DspFilters/Common.h"
+#include "DspFilters/Cascade.h"
+#include "DspFilters/MathSupplement.h"
+
+namespace Dsp {
+
+/*
+ * Runs a cascade of second order sections in Direct Form II on several
+ * independent signals at once, one signal per SIMD lane.
+ *
+ * Every lane has its own coefficients and state, so the lanes can be the
+ * channels of one stream as well as different streams with different
+ * filter settings. Coefficients and state are kept structure-of-arrays,
+ * one row of Lanes values per stage and coefficient.
+ *
+ * Samples are lane-interleaved: frames[n * Lanes + lane].
+ *
+ *  float:  8 lanes (one AVX register, two SSE registers)
+ *  double: 4 lanes (one AVX register, two SSE2 registers)
+ *
+ * Without SSE2 / AVX the same layout is processed lane by lane.
+ *
+ */
+
+namespace SimdCascadeKernel {
+
+// Raw kernels, coefficients are laid out [stage][b0 b1 b2 a1 a2][lane],
+// state [stage][v1 v2][lane]. vsa is the anti denormal alternating current.
+void process (int numFrames, float* frames, int numStages,
+              const float* coefficients, float* state, float& vsa);
+
+void process (int numFrames, double* frames, int numStages,
+              const double* coefficients, double* state, double& vsa);
+
+}
+
+template <int MaxStages, typename Sample>
+class SimdCascade
+{
+public:
+  static const int Lanes = 32 / sizeof (Sample);
+
+  SimdCascade ()
+    : m_numStages (0)
+    , m_vsa (static_cast<Sample> (anti_denormal_vsa))
+  {
+    for (int lane = 0; lane < Lanes; ++lane)
+      clearLane (lane);
+  }
+
+  // Loads the sections of a designed cascade into a lane, keeping its state.
+  // Stages the cascade doesn't use pass the signal through.
+  void setLane (int lane, Cascade& cascade)
+  {
+    assert (lane >= 0 && lane < Lanes);
+    assert (cascade.getNumStages () <= MaxStages);
+
+    const int numStages = cascade.getNumStages ();
+    for (int i = 0; i < MaxStages; ++i)
+    {
+      if (i < numStages)
+      {
+        const Cascade::Stage& stage = cascade[i];
+        m_coefficients[i][b0][lane] = static_cast<Sample> (stage.m_b0);
+        m_coefficients[i][b1][lane] = static_cast<Sample> (stage.m_b1);
+        m_coefficients[i][b2][lane] = static_cast<Sample> (stage.m_b2);
+        m_coefficients[i][a1][lane] = static_cast<Sample> (stage.m_a1);
+        m_coefficients[i][a2][lane] = static_cast<Sample> (stage.m_a2);
+      }
+      else
+      {
+        setIdentity (i, lane);
+      }
+    }
+
+    if (numStages > m_numStages)
+      m_numStages = numStages;
+  }
+
+  // Makes a lane pass its signal through and clears its state
+  void clearLane (int lane)
+  {
+    assert (lane >= 0 && lane < Lanes);
+
+    for (int i = 0; i < MaxStages; ++i)
+      setIdentity (i, lane);
+
+    resetLane (lane);
+  }
+
+  void resetLane (int lane)
+  {
+    assert (lane >= 0 && lane < Lanes);
+
+    for (int i = 0; i < MaxStages; ++i)
+    {
+      m_state[i][v1][lane] = 0;
+      m_state[i][v2][lane] = 0;
+    }
+  }
+
+  void reset ()
+  {
+    for (int lane = 0; lane < Lanes; ++lane)
+      resetLane (lane);
+  }
+
+  int getNumStages () const
+  {
+    return m_numStages;
+  }
+
+  // Process a block of lane-interleaved frames in place
+  void process (int numFrames, Sample* frames)
+  {
+    SimdCascadeKernel::process (numFrames, frames, m_numStages,
+                                &m_coefficients[0][0][0], &m_state[0][0][0],
+                                m_vsa);
+  }
+
+private:
+  enum
+  {
+    b0, b1, b2, a1, a2,
+    numCoefficients
+  };
+
+  enum
+  {
+    v1, v2,
+    numStateVariables
+  };
+
+  void setIdentity (int stage, int lane)
+  {
+    m_coefficients[stage][b0][lane] = 1;
+    m_coefficients[stage][b1][lane] = 0;
+    m_coefficients[stage][b2][lane] = 0;
+    m_coefficients[stage][a1][lane] = 0;
+    m_coefficients[stage][a2][lane] = 0;
+  }
+
+  Sample m_coefficients [MaxStages][numCoefficients][Lanes];
+  Sample m_state [MaxStages][numStateVariables][Lanes];
+  int m_numStages;
+  Sample m_vsa;
+};
+
+}
+
+#endif
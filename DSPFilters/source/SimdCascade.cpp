@@ -0,0 +1,177 @@
+/*******************************************************************************
+
+Vectorised cascade state, an addition to
+"A Collection of Useful C++ Classes for Digital Signal Processing"
+distributed under the same license as the rest of the collection.
+
+*******************************************************************************/
+
+#include "DspFilters/Common.h"
+#include "DspFilters/SimdCascade.h"
+
+#if defined(__AVX__)
+#  define DSPFILTERS_SIMD_AVX
+#  include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define DSPFILTERS_SIMD_SSE2
+#  include <emmintrin.h>
+#endif
+
+namespace Dsp {
+
+namespace {
+
+//------------------------------------------------------------------------------
+
+// One register worth of lanes, the kernel below is written against these
+
+template <typename Sample>
+struct ScalarOps
+{
+  typedef Sample reg;
+  static const int Width = 1;
+  static reg load (const Sample* p) { return *p; }
+  static void store (Sample* p, reg v) { *p = v; }
+  static reg set1 (Sample v) { return v; }
+  static reg add (reg a, reg b) { return a + b; }
+  static reg sub (reg a, reg b) { return a - b; }
+  static reg mul (reg a, reg b) { return a * b; }
+};
+
+#if defined(DSPFILTERS_SIMD_AVX)
+
+struct FloatOps
+{
+  typedef __m256 reg;
+  static const int Width = 8;
+  static reg load (const float* p) { return _mm256_loadu_ps (p); }
+  static void store (float* p, reg v) { _mm256_storeu_ps (p, v); }
+  static reg set1 (float v) { return _mm256_set1_ps (v); }
+  static reg add (reg a, reg b) { return _mm256_add_ps (a, b); }
+  static reg sub (reg a, reg b) { return _mm256_sub_ps (a, b); }
+  static reg mul (reg a, reg b) { return _mm256_mul_ps (a, b); }
+};
+
+struct DoubleOps
+{
+  typedef __m256d reg;
+  static const int Width = 4;
+  static reg load (const double* p) { return _mm256_loadu_pd (p); }
+  static void store (double* p, reg v) { _mm256_storeu_pd (p, v); }
+  static reg set1 (double v) { return _mm256_set1_pd (v); }
+  static reg add (reg a, reg b) { return _mm256_add_pd (a, b); }
+  static reg sub (reg a, reg b) { return _mm256_sub_pd (a, b); }
+  static reg mul (reg a, reg b) { return _mm256_mul_pd (a, b); }
+};
+
+#elif defined(DSPFILTERS_SIMD_SSE2)
+
+struct FloatOps
+{
+  typedef __m128 reg;
+  static const int Width = 4;
+  static reg load (const float* p) { return _mm_loadu_ps (p); }
+  static void store (float* p, reg v) { _mm_storeu_ps (p, v); }
+  static reg set1 (float v) { return _mm_set1_ps (v); }
+  static reg add (reg a, reg b) { return _mm_add_ps (a, b); }
+  static reg sub (reg a, reg b) { return _mm_sub_ps (a, b); }
+  static reg mul (reg a, reg b) { return _mm_mul_ps (a, b); }
+};
+
+struct DoubleOps
+{
+  typedef __m128d reg;
+  static const int Width = 2;
+  static reg load (const double* p) { return _mm_loadu_pd (p); }
+  static void store (double* p, reg v) { _mm_storeu_pd (p, v); }
+  static reg set1 (double v) { return _mm_set1_pd (v); }
+  static reg add (reg a, reg b) { return _mm_add_pd (a, b); }
+  static reg sub (reg a, reg b) { return _mm_sub_pd (a, b); }
+  static reg mul (reg a, reg b) { return _mm_mul_pd (a, b); }
+};
+
+#else
+
+typedef ScalarOps <float> FloatOps;
+typedef ScalarOps <double> DoubleOps;
+
+#endif
+
+//------------------------------------------------------------------------------
+
+// Stage by stage over the whole block, so the state of a stage stays in
+// registers and the block stays in L1 between stages. Each stage:
+//
+//  v[n] =         x[n] - a1*v[n-1] - a2*v[n-2]
+//  y[n] = b0*v[n] + b1*v[n-1] + b2*v[n-2]
+//
+template <class Ops, typename Sample>
+void processCascade (int numFrames, Sample* frames, int numStages,
+                     const Sample* coefficients, Sample* state, Sample& vsa)
+{
+  const int Lanes = 32 / sizeof (Sample);
+  typedef typename Ops::reg reg;
+
+  for (int stage = 0; stage < numStages; ++stage)
+  {
+    const Sample* c = coefficients + stage * 5 * Lanes;
+    Sample* s = state + stage * 2 * Lanes;
+
+    for (int offset = 0; offset < Lanes; offset += Ops::Width)
+    {
+      const reg b0 = Ops::load (c + 0 * Lanes + offset);
+      const reg b1 = Ops::load (c + 1 * Lanes + offset);
+      const reg b2 = Ops::load (c + 2 * Lanes + offset);
+      const reg a1 = Ops::load (c + 3 * Lanes + offset);
+      const reg a2 = Ops::load (c + 4 * Lanes + offset);
+      reg v1 = Ops::load (s + 0 * Lanes + offset);
+      reg v2 = Ops::load (s + 1 * Lanes + offset);
+
+      // the first stage gets the alternating current, like Cascade::StateBase
+      Sample ac = vsa;
+      Sample* frame = frames + offset;
+      for (int n = 0; n < numFrames; ++n, frame += Lanes)
+      {
+        reg w = Ops::sub (Ops::sub (Ops::load (frame), Ops::mul (a1, v1)), Ops::mul (a2, v2));
+        if (stage == 0)
+        {
+          ac = -ac;
+          w = Ops::add (w, Ops::set1 (ac));
+        }
+
+        const reg out = Ops::add (Ops::add (Ops::mul (b0, w), Ops::mul (b1, v1)), Ops::mul (b2, v2));
+        v2 = v1;
+        v1 = w;
+        Ops::store (frame, out);
+      }
+
+      Ops::store (s + 0 * Lanes + offset, v1);
+      Ops::store (s + 1 * Lanes + offset, v2);
+    }
+  }
+
+  if ((numStages > 0) && (numFrames & 1))
+    vsa = -vsa;
+}
+
+}
+
+//------------------------------------------------------------------------------
+
+namespace SimdCascadeKernel {
+
+void process (int numFrames, float* frames, int numStages,
+              const float* coefficients, float* state, float& vsa)
+{
+  processCascade <FloatOps> (numFrames, frames, numStages, coefficients, state, vsa);
+}
+
+void process (int numFrames, double* frames, int numStages,
+              const double* coefficients, double* state, double& vsa)
+{
+  processCascade <DoubleOps> (numFrames, frames, numStages, coefficients, state, vsa);
+}
+
+}
+
+}
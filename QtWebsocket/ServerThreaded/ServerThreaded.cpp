@@ -89,6 +89,8 @@ void ServerThreaded::processNewConnection()
 
 	// Starting the thread
     thread->start();
+
+    emit clientConnected(thread);
 }
 
 void ServerThreaded::start()
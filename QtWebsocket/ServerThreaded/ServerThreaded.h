@@ -58,6 +58,7 @@ signals:
     void portChanged(quint16);
 	void broadcastMessage(QString message);
     void messageReceived(QString message);
+    void clientConnected(QObject *thread);  // a SocketThread, its sendMessage slot reaches this client only
 
 private:
     QtWebsocket::QWsServer* m_Server;
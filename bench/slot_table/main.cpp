@@ -0,0 +1,115 @@
+// Lookups per second of per client dsp state: the former QHash<QPair<uint64,anyID>,QPointer<>> + qobject_cast
+// versus the SlotTable, once with a lookup per block and once with a SlotRef resolved ahead (as the voice chain does).
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QPointer>
+#include <QVector>
+#include <QTextStream>
+
+#include <utility>
+
+#include "volumes.h"
+
+class BenchVolume : public QObject
+{
+    Q_OBJECT
+public:
+    int processed = 0;
+};
+
+// the production table (VolumeTable) at the load of four crowded server tabs
+const int SERVER_TABS = 4;
+const int CLIENTS_PER_TAB = 500;
+const int ROUNDS = 2000;
+static_assert(SERVER_TABS * CLIENTS_PER_TAB <= VOLUMES_CAPACITY, "bench load exceeds the production capacity");
+
+typedef SlotTable<QObject*, VOLUMES_CAPACITY> BenchTable;
+
+static void report(QTextStream &out, const char* name, qint64 nsecs, qint64 lookups)
+{
+    out << QString("%1 %2 Mlookups/s").arg(name, -40).arg((lookups * 1000.0) / nsecs, 8, 'f', 2) << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QVector<BenchVolume*> objects;
+    QVector<QPair<uint64,anyID> > keys;
+    QHash<QPair<uint64,anyID>, QPointer<QObject> > hash;
+    auto table = new BenchTable;    // heap, too big for the stack
+    for (uint64 sc = 1; sc <= SERVER_TABS; ++sc)
+    {
+        for (int i = 0; i < CLIENTS_PER_TAB; ++i)
+        {
+            const auto kClientID = (anyID)(1 + i * 7);  // sparse, like runtime ids
+            auto obj = new BenchVolume;
+            objects.append(obj);
+            keys.append(qMakePair(sc, kClientID));
+            hash.insert(qMakePair(sc, kClientID), obj);
+            table->insert(sc, kClientID, obj);
+        }
+    }
+
+    // voice events don't come in insertion order
+    for (int i = keys.size() - 1; i > 0; --i)
+        std::swap(keys[i], keys[qrand() % (i + 1)]);
+
+    QVector<SlotRef<QObject*> > refs;
+    for (const auto &key : keys)
+        refs.append(table->find(key.first, key.second));
+
+    const qint64 kLookups = (qint64)ROUNDS * keys.size();
+    QElapsedTimer timer;
+
+    timer.start();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (const auto &key : keys)
+        {
+            auto vol = qobject_cast<BenchVolume*>(hash.value(key).data());
+            if (vol)
+                ++vol->processed;
+        }
+    }
+    report(out, "QHash + QPointer + qobject_cast", timer.nsecsElapsed(), kLookups);
+
+    timer.restart();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (const auto &key : keys)
+        {
+            auto vol = static_cast<BenchVolume*>(table->find(key.first, key.second).get());
+            if (vol)
+                ++vol->processed;
+        }
+    }
+    report(out, "SlotTable find", timer.nsecsElapsed(), kLookups);
+
+    timer.restart();
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (const auto &ref : refs)
+        {
+            auto vol = static_cast<BenchVolume*>(ref.get());
+            if (vol)
+                ++vol->processed;
+        }
+    }
+    report(out, "SlotRef generation check", timer.nsecsElapsed(), kLookups);
+
+    qint64 checksum = 0;
+    for (auto obj : objects)
+        checksum += obj->processed;
+
+    out << "checksum " << checksum << " (expected " << (kLookups * 3) << ")" << endl;
+
+    qDeleteAll(objects);
+    delete table;
+    return 0;
+}
+
+#include "main.moc"
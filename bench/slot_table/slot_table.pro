@@ -0,0 +1,16 @@
+QT -= gui
+QT += core
+
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TARGET = bench_slot_table
+TEMPLATE = app
+
+INCLUDEPATH += ../../includes ../../src
+
+HEADERS += \
+    ../../src/slot_table.h
+
+SOURCES += \
+    main.cpp
@@ -0,0 +1,552 @@
+// Offline cost of the voice processing modules.
+// Links the plugin sources against a stub ts3Functions table describing M server tabs with N talkers each,
+// all in our channel, and feeds 48kHz PCM through ts3plugin_onEditPlaybackVoiceDataEvent and
+// ts3plugin_onEditPostProcessVoiceDataEvent, once per module and once with everything enabled.
+//
+// usage: bench_voice_chain [-t talkers] [-m tabs] [-r rounds] [pcm file, raw 48kHz mono int16]
+//
+// Allocations are counted on the benchmark thread. With glibc malloc, calloc, realloc and memalign are interposed,
+// which covers the Qt libraries' containers too; elsewhere only the global operator new of this binary is seen and
+// the table says so.
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTextStream>
+#include <QVector>
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <new>
+
+#include "teamspeak/public_errors.h"
+#include "teamspeak/public_definitions.h"
+#include "ts3_functions.h"
+#include "plugin.h"
+
+#include "mod_muter_channel.h"
+#include "mod_agmu.h"
+#include "mod_ducker_global.h"
+#include "mod_ducker_channel.h"
+#include "mod_position_spread.h"
+#include "voice_chain.h"
+#include "telemetry.h"
+#ifdef USE_RADIO
+#include "mod_radio.h"
+#endif
+
+// the module instances of plugin.cpp
+extern ChannelMuter channel_Muter;
+extern Agmu agmu;
+extern Ducker_Global ducker_G;
+extern Ducker_Channel ducker_C;
+extern PositionSpread positionSpread;
+#ifdef USE_RADIO
+extern Radio radio;
+#endif
+
+const int SAMPLE_RATE = 48000;
+const double TWO_PI = 6.283185307179586;
+const int BLOCK_FRAMES = 480;   // 10ms, what the client hands us per talker
+const int OUTPUT_CHANNELS = 2;
+const int WARMUP_ROUNDS = 20;
+const anyID MY_ID = 1;
+const uint64 MY_CHANNEL_ID = 1;
+
+// Allocation counting
+
+static thread_local bool g_isCountingAllocations = false;  // the audio path runs on the benchmark thread
+static quint64 g_allocations = 0;
+
+static inline void countAllocation()
+{
+    if (g_isCountingAllocations)
+        ++g_allocations;
+}
+
+#if defined(__GLIBC__)
+// The executable's definitions take precedence over libc's for every shared object, Qt included.
+#define COUNTS_MALLOC
+
+extern "C" void* __libc_malloc(std::size_t size);
+extern "C" void* __libc_calloc(std::size_t count, std::size_t size);
+extern "C" void* __libc_realloc(void* p, std::size_t size);
+extern "C" void* __libc_memalign(std::size_t alignment, std::size_t size);
+
+extern "C" void* malloc(std::size_t size)
+{
+    countAllocation();
+    return __libc_malloc(size);
+}
+
+extern "C" void* calloc(std::size_t count, std::size_t size)
+{
+    countAllocation();
+    return __libc_calloc(count, size);
+}
+
+extern "C" void* realloc(void* p, std::size_t size)
+{
+    countAllocation();
+    return __libc_realloc(p, size);
+}
+
+extern "C" void* memalign(std::size_t alignment, std::size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" void* aligned_alloc(std::size_t alignment, std::size_t size)
+{
+    countAllocation();
+    return __libc_memalign(alignment, size);
+}
+
+extern "C" int posix_memalign(void** result, std::size_t alignment, std::size_t size)
+{
+    countAllocation();
+    *result = __libc_memalign(alignment, size);
+    return *result ? 0 : ENOMEM;
+}
+#endif
+
+void* operator new(std::size_t size)
+{
+#ifndef COUNTS_MALLOC
+    countAllocation();
+#endif
+    if (auto p = std::malloc(size ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept
+{
+    std::free(p);
+}
+
+// Stub client: every tab is connected, we are client 1, all talkers sit in our channel and are talking
+
+namespace Stub
+{
+    static int tabs = 1;
+    static int talkers = 1;
+    static QByteArray configPath;
+
+    static char* dup(const QByteArray &value)
+    {
+        auto result = static_cast<char*>(std::malloc(value.size() + 1));
+        std::memcpy(result, value.constData(), value.size() + 1);
+        return result;
+    }
+
+    static anyID* clientList()
+    {
+        auto result = static_cast<anyID*>(std::malloc(sizeof(anyID) * (talkers + 2)));
+        result[0] = MY_ID;
+        for (int i = 0; i < talkers; ++i)
+            result[i + 1] = MY_ID + 1 + i;
+        result[talkers + 1] = 0;
+        return result;
+    }
+
+    static unsigned int getErrorMessage(unsigned int errorCode, char** error)
+    {
+        *error = dup(QByteArray("stub error ") + QByteArray::number(errorCode));
+        return ERROR_ok;
+    }
+    static unsigned int freeMemory(void* pointer) {std::free(pointer); return ERROR_ok;}
+    static unsigned int logMessage(const char*, enum LogLevel, const char*, uint64) {return ERROR_ok;}
+    static unsigned int playWaveFile(uint64, const char*) {return ERROR_ok;}
+    static unsigned int getClientID(uint64, anyID* result) {*result = MY_ID; return ERROR_ok;}
+    static unsigned int getClientSelfVariableAsInt(uint64, size_t, int* result) {*result = 0; return ERROR_ok;}
+    static unsigned int getClientVariableAsInt(uint64, anyID clientID, size_t flag, int* result)
+    {
+        *result = ((flag == CLIENT_FLAG_TALKING) && (clientID != MY_ID)) ? STATUS_TALKING : 0;
+        return ERROR_ok;
+    }
+    static unsigned int getClientVariableAsString(uint64 serverConnectionHandlerID, anyID clientID, size_t, char** result)
+    {
+        *result = dup(QString("bench-%1-%2").arg(serverConnectionHandlerID).arg(clientID).toUtf8());
+        return ERROR_ok;
+    }
+    static unsigned int getClientList(uint64, anyID** result) {*result = clientList(); return ERROR_ok;}
+    static unsigned int getChannelOfClient(uint64, anyID, uint64* result) {*result = MY_CHANNEL_ID; return ERROR_ok;}
+    static unsigned int getChannelVariableAsString(uint64, uint64, size_t, char** result) {*result = dup("Bench"); return ERROR_ok;}
+    static unsigned int getChannelList(uint64, uint64** result)
+    {
+        *result = static_cast<uint64*>(std::malloc(sizeof(uint64) * 2));
+        (*result)[0] = MY_CHANNEL_ID;
+        (*result)[1] = 0;
+        return ERROR_ok;
+    }
+    static unsigned int getChannelClientList(uint64, uint64, anyID** result) {*result = clientList(); return ERROR_ok;}
+    static unsigned int getParentChannelOfChannel(uint64, uint64, uint64* result) {*result = 0; return ERROR_ok;}
+    static unsigned int getServerConnectionHandlerList(uint64** result)
+    {
+        *result = static_cast<uint64*>(std::malloc(sizeof(uint64) * (tabs + 1)));
+        for (int i = 0; i < tabs; ++i)
+            (*result)[i] = i + 1;
+        (*result)[tabs] = 0;
+        return ERROR_ok;
+    }
+    static unsigned int getServerVariableAsUInt64(uint64, size_t, uint64* result) {*result = 0; return ERROR_ok;}
+    static unsigned int getServerVariableAsString(uint64 serverConnectionHandlerID, size_t, char** result)
+    {
+        *result = dup(QByteArray("bench-server-") + QByteArray::number(serverConnectionHandlerID));
+        return ERROR_ok;
+    }
+    static unsigned int getConnectionStatus(uint64, int* result) {*result = STATUS_CONNECTION_ESTABLISHED; return ERROR_ok;}
+    static void getPath(char* path, size_t maxLen) {qstrncpy(path, configPath.constData(), (uint)maxLen);}
+    static uint64 getCurrentServerConnectionHandlerID() {return 1;}
+    static void printMessage(uint64, const char*, enum PluginMessageTarget) {}
+    static void printMessageToCurrentTab(const char*) {}
+    static unsigned int requestInfoUpdate(uint64, enum PluginItemType, uint64) {return ERROR_ok;}
+    static unsigned int isWhispering(uint64, anyID, int* result) {*result = 0; return ERROR_ok;}
+    static void setPluginMenuEnabled(const char*, int, int) {}
+    static unsigned int getClientDisplayName(uint64, anyID clientID, char* result, size_t maxLen)
+    {
+        qsnprintf(result, (size_t)maxLen, "Talker %d", (int)clientID);
+        return ERROR_ok;
+    }
+
+    // everything the voice path and the module setup touch; the rest stays null and crashes loudly if used
+    static TS3Functions functions()
+    {
+        TS3Functions funcs;
+        std::memset(&funcs, 0, sizeof(funcs));
+        funcs.getErrorMessage = getErrorMessage;
+        funcs.freeMemory = freeMemory;
+        funcs.logMessage = logMessage;
+        funcs.playWaveFile = playWaveFile;
+        funcs.getClientID = getClientID;
+        funcs.getClientSelfVariableAsInt = getClientSelfVariableAsInt;
+        funcs.getClientVariableAsInt = getClientVariableAsInt;
+        funcs.getClientVariableAsString = getClientVariableAsString;
+        funcs.getClientList = getClientList;
+        funcs.getChannelOfClient = getChannelOfClient;
+        funcs.getChannelVariableAsString = getChannelVariableAsString;
+        funcs.getChannelList = getChannelList;
+        funcs.getChannelClientList = getChannelClientList;
+        funcs.getParentChannelOfChannel = getParentChannelOfChannel;
+        funcs.getServerConnectionHandlerList = getServerConnectionHandlerList;
+        funcs.getServerVariableAsUInt64 = getServerVariableAsUInt64;
+        funcs.getServerVariableAsString = getServerVariableAsString;
+        funcs.getConnectionStatus = getConnectionStatus;
+        funcs.getResourcesPath = getPath;
+        funcs.getConfigPath = getPath;
+        funcs.getCurrentServerConnectionHandlerID = getCurrentServerConnectionHandlerID;
+        funcs.printMessage = printMessage;
+        funcs.printMessageToCurrentTab = printMessageToCurrentTab;
+        funcs.requestInfoUpdate = requestInfoUpdate;
+        funcs.isWhispering = isWhispering;
+        funcs.setPluginMenuEnabled = setPluginMenuEnabled;
+        funcs.getClientDisplayName = getClientDisplayName;
+        return funcs;
+    }
+}
+
+// PCM
+
+static QVector<short> loadPcm(const QString &fileName)
+{
+    QVector<short> pcm;
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return pcm;
+
+    const auto kData = file.readAll();
+    pcm.resize(kData.size() / (int)sizeof(short));
+    std::memcpy(pcm.data(), kData.constData(), pcm.size() * sizeof(short));
+    return pcm;
+}
+
+// 10s of a voice-like signal: a gliding harmonic series with syllable envelope and some breath noise
+static QVector<short> synthesizePcm()
+{
+    QVector<short> pcm(SAMPLE_RATE * 10);
+    double phase = 0.0;
+    quint32 noise = 0x12345678u;
+    for (int i = 0; i < pcm.size(); ++i)
+    {
+        const double t = (double)i / SAMPLE_RATE;
+        const double f0 = 140.0 + 40.0 * std::sin(TWO_PI * 0.7 * t);
+        phase += TWO_PI * f0 / SAMPLE_RATE;
+
+        double value = 0.0;
+        for (int harmonic = 1; harmonic <= 12; ++harmonic)
+            value += std::sin(phase * harmonic) / harmonic;
+
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        value += ((double)(noise >> 8) / 8388608.0 - 1.0) * 0.05;
+
+        const double envelope = std::pow(std::fabs(std::sin(TWO_PI * 2.0 * t)), 0.5);
+        pcm[i] = (short)qBound(-32768.0, value * envelope * 9000.0, 32767.0);
+    }
+    return pcm;
+}
+
+// Scenarios
+
+struct Scenario
+{
+    const char* name;
+    std::function<void()> setUp;
+    std::function<void()> tearDown;
+};
+
+struct Result
+{
+    double playbackNs = 0.0;
+    double postProcessNs = 0.0;
+    double allocationsPerBlock = 0.0;
+};
+
+static void pumpEvents()
+{
+    QCoreApplication::processEvents();
+    QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+}
+
+static void setTalkStatus(int status)
+{
+    for (int sc = 1; sc <= Stub::tabs; ++sc)
+    {
+        for (int i = 0; i < Stub::talkers; ++i)
+            ts3plugin_onTalkStatusChangeEvent(sc, status, 0, MY_ID + 1 + i);
+    }
+    pumpEvents();
+}
+
+static Result run(const Scenario &scenario, const QVector<short> &pcm, int rounds)
+{
+    scenario.setUp();
+    setTalkStatus(STATUS_TALKING);
+
+    const auto kBlockCount = Stub::tabs * Stub::talkers;
+    QVector<short> playback(kBlockCount * BLOCK_FRAMES);
+    QVector<short> postProcess(kBlockCount * BLOCK_FRAMES * OUTPUT_CHANNELS);
+    const unsigned int kSpeakers[OUTPUT_CHANNELS] = {SPEAKER_FRONT_LEFT, SPEAKER_FRONT_RIGHT};
+
+    Result result;
+    qint64 playbackNs = 0;
+    qint64 postProcessNs = 0;
+    QElapsedTimer timer;
+    for (int round = -WARMUP_ROUNDS; round < rounds; ++round)
+    {
+        // every talker reads the recording at its own offset
+        for (int block = 0; block < kBlockCount; ++block)
+        {
+            const auto kOffset = ((qint64)(round + WARMUP_ROUNDS) * BLOCK_FRAMES + (qint64)block * 4801) % (pcm.size() - BLOCK_FRAMES);
+            std::memcpy(playback.data() + block * BLOCK_FRAMES, pcm.constData() + kOffset, BLOCK_FRAMES * sizeof(short));
+            for (int frame = 0; frame < BLOCK_FRAMES; ++frame)
+            {
+                for (int channel = 0; channel < OUTPUT_CHANNELS; ++channel)
+                    postProcess[(block * BLOCK_FRAMES + frame) * OUTPUT_CHANNELS + channel] = pcm.at(kOffset + frame);
+            }
+        }
+
+        const auto kIsMeasured = (round >= 0);
+        g_isCountingAllocations = kIsMeasured;
+
+        timer.start();
+        for (int sc = 1; sc <= Stub::tabs; ++sc)
+        {
+            for (int i = 0; i < Stub::talkers; ++i)
+            {
+                const auto kBlock = (sc - 1) * Stub::talkers + i;
+                ts3plugin_onEditPlaybackVoiceDataEvent(sc, MY_ID + 1 + i, playback.data() + kBlock * BLOCK_FRAMES, BLOCK_FRAMES, 1);
+            }
+        }
+        if (kIsMeasured)
+            playbackNs += timer.nsecsElapsed();
+
+        timer.start();
+        for (int sc = 1; sc <= Stub::tabs; ++sc)
+        {
+            for (int i = 0; i < Stub::talkers; ++i)
+            {
+                const auto kBlock = (sc - 1) * Stub::talkers + i;
+                unsigned int fillMask = (1 << OUTPUT_CHANNELS) - 1;
+                ts3plugin_onEditPostProcessVoiceDataEvent(sc, MY_ID + 1 + i, postProcess.data() + kBlock * BLOCK_FRAMES * OUTPUT_CHANNELS,
+                                                          BLOCK_FRAMES, OUTPUT_CHANNELS, kSpeakers, &fillMask);
+            }
+        }
+        if (kIsMeasured)
+            postProcessNs += timer.nsecsElapsed();
+
+        g_isCountingAllocations = false;
+        pumpEvents();   // telemetry drain and queued rebuilds, like the client's event loop would
+    }
+
+    const double kBlocks = (double)kBlockCount * rounds;
+    result.playbackNs = playbackNs / kBlocks;
+    result.postProcessNs = postProcessNs / kBlocks;
+    result.allocationsPerBlock = g_allocations / kBlocks;
+    g_allocations = 0;
+
+    setTalkStatus(STATUS_NOT_TALKING);
+    scenario.tearDown();
+    pumpEvents();
+    return result;
+}
+
+static void forEachTalker(std::function<void(uint64, anyID)> f)
+{
+    for (int sc = 1; sc <= Stub::tabs; ++sc)
+    {
+        for (int i = 0; i < Stub::talkers; ++i)
+            f(sc, MY_ID + 1 + i);
+    }
+}
+
+#ifdef USE_RADIO
+static void setUpRadio()
+{
+    RadioFX_Settings settings;
+    settings.enabled = true;
+    settings.freq_low = 300.0;
+    settings.freq_hi = 3000.0;
+    settings.fudge = 2.0;
+    settings.rm_mod_freq = 30.0;
+    settings.rm_mix = 0.2;
+    settings.o_freq_lo = 300.0;
+    settings.o_freq_hi = 3000.0;
+    for (auto name : {"Home", "Whisper", "Other"})
+    {
+        settings.name = name;
+        radio.GetSettingsMapRef().insert(name, settings);
+    }
+    radio.setEnabled(true);
+}
+#endif
+
+static void setUpDuckerGlobal()
+{
+    ducker_G.setEnabled(true);
+    forEachTalker([](uint64 serverConnectionHandlerID, anyID clientID) {ducker_G.AddMusicBot(serverConnectionHandlerID, clientID);});
+}
+
+static void setMuted(bool val)
+{
+    for (int sc = 1; sc <= Stub::tabs; ++sc)
+    {
+        if (channel_Muter.isChannelMuted(sc, MY_CHANNEL_ID) != val)
+            channel_Muter.toggleChannelMute(sc, MY_CHANNEL_ID);
+    }
+}
+
+static void setUpPositionSpread()
+{
+    positionSpread.setSpreadWidth(1.0f);
+    positionSpread.setEnabled(true);
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream out(stdout);
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption talkersOption("t", "Talkers per server tab.", "talkers", "30");
+    QCommandLineOption tabsOption("m", "Server tabs.", "tabs", "2");
+    QCommandLineOption roundsOption("r", "Measured rounds of 10ms blocks.", "rounds", "500");
+    parser.addOption(talkersOption);
+    parser.addOption(tabsOption);
+    parser.addOption(roundsOption);
+    parser.addPositionalArgument("pcm", "Raw 48kHz mono int16 recording; a synthetic voice is used if omitted.");
+    parser.process(app);
+
+    Stub::talkers = qBound(1, parser.value(talkersOption).toInt(), 2000);
+    Stub::tabs = qBound(1, parser.value(tabsOption).toInt(), 16);
+    const auto kRounds = qMax(1, parser.value(roundsOption).toInt());
+
+    auto pcm = (parser.positionalArguments().isEmpty()) ? synthesizePcm() : loadPcm(parser.positionalArguments().first());
+    if (pcm.size() < BLOCK_FRAMES * 2)
+    {
+        out << "Could not load PCM." << endl;
+        return 1;
+    }
+
+    // the modules save settings next to the client config, keep that out of the way
+    Stub::configPath = QDir::toNativeSeparators(QDir::tempPath() + "/crosstalk_bench/").toLocal8Bit();
+    QDir().mkpath(QString::fromLocal8Bit(Stub::configPath));
+    ts3plugin_setFunctionPointers(Stub::functions());
+
+    // the parts of ts3plugin_init the voice path depends on; the rest starts servers, the updater and the ui
+#ifdef USE_RADIO
+    VoiceChain::instance()->Init(&channel_Muter, &radio, &agmu, &ducker_G, &ducker_C);
+#else
+    VoiceChain::instance()->Init(&channel_Muter, nullptr, &agmu, &ducker_G, &ducker_C);
+#endif
+    Telemetry::instance()->Start();
+    ts3plugin_currentServerConnectionChanged(1);
+    pumpEvents();
+
+    QVector<Scenario> scenarios;
+    scenarios.append({"none", []{}, []{}});
+    scenarios.append({"ChannelMuter (channel muted)", []{channel_Muter.setEnabled(true); setMuted(true);}, []{setMuted(false); channel_Muter.setEnabled(false);}});
+#ifdef USE_RADIO
+    scenarios.append({"Radio", setUpRadio, []{radio.setEnabled(false);}});
+#endif
+    scenarios.append({"Agmu", []{agmu.setEnabled(true);}, []{agmu.setEnabled(false);}});
+    scenarios.append({"Ducker_Global (all music bots)", setUpDuckerGlobal, []{ducker_G.setEnabled(false);}});
+    scenarios.append({"Ducker_Channel", []{ducker_C.setEnabled(true);}, []{ducker_C.setEnabled(false);}});
+    scenarios.append({"PositionSpread", setUpPositionSpread, []{positionSpread.setEnabled(false);}});
+    scenarios.append({"all but muter", []{
+#ifdef USE_RADIO
+            setUpRadio();
+#endif
+            agmu.setEnabled(true);
+            setUpDuckerGlobal();
+            ducker_C.setEnabled(true);
+            setUpPositionSpread();
+        }, []{
+#ifdef USE_RADIO
+            radio.setEnabled(false);
+#endif
+            agmu.setEnabled(false);
+            ducker_G.setEnabled(false);
+            ducker_C.setEnabled(false);
+            positionSpread.setEnabled(false);
+        }});
+
+    out << QString("%1 tabs x %2 talkers, %3 rounds of %4 frames").arg(Stub::tabs).arg(Stub::talkers).arg(kRounds).arg(BLOCK_FRAMES) << endl;
+#ifndef COUNTS_MALLOC
+    out << "allocs/block only counts operator new of this binary, malloc inside the Qt libraries isn't seen" << endl;
+#endif
+    out << QString("%1 %2 %3 %4").arg("module", -32).arg("playback ns/block", 18).arg("postprocess ns/block", 21).arg("allocs/block", 13) << endl;
+    for (const auto &scenario : scenarios)
+    {
+        const auto kResult = run(scenario, pcm, kRounds);
+        out << QString("%1 %2 %3 %4")
+               .arg(scenario.name, -32)
+               .arg(kResult.playbackNs, 18, 'f', 1)
+               .arg(kResult.postProcessNs, 21, 'f', 1)
+               .arg(kResult.allocationsPerBlock, 13, 'f', 3) << endl;
+    }
+
+    Telemetry::instance()->Stop();
+    return 0;
+}
@@ -0,0 +1,15 @@
+QT += core
+
+CONFIG += console c++14
+CONFIG -= app_bundle
+
+TARGET = bench_voice_chain
+TEMPLATE = app
+
+# the whole plugin, driven through its exported ts3plugin_* entry points
+include(../../CrossTalk.pri)
+
+INCLUDEPATH += ../../src
+
+SOURCES += \
+    main.cpp
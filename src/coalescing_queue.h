@@ -0,0 +1,87 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QIODevice>
+#include <QQueue>
+
+//! Send queue of a slow reader, keeping the latest message per key
+/*!
+ * Messages go straight to the device while its write buffer is below HIGH_WATER_MARK; a client that doesn't read
+ * (a stalled browser tab, a hung tool) would otherwise grow it without limit. Beyond, they wait here.
+ * Messages are deltas, none may be dropped: a lost removal would leave a ghost, a lost last position a stale player.
+ * Instead a queued message is replaced in place by a newer one of the same key, which bounds the queue by the number
+ * of keys; a key updated faster than the reader drains keeps its place and can't starve.
+ * Messages with an empty key (Key()) are never replaced. Messages of replaced keys may go out of order across keys.
+ */
+template <typename Key>
+class CoalescingQueue
+{
+public:
+    static const qint64 HIGH_WATER_MARK = 64 * 1024;    // bytes in the device's write buffer
+
+    bool isEmpty() const {return m_queue.isEmpty();}
+    int size() const {return m_queue.size();}
+
+    //! Writes the message, or queues it while the device is backed up
+    void send(QIODevice *device, const Key &key, const QByteArray &message)
+    {
+        if (m_queue.isEmpty() && (device->bytesToWrite() < HIGH_WATER_MARK))
+        {
+            device->write(message);
+            return;
+        }
+
+        if (!(key == Key()))
+        {
+            const auto kIt = m_positions.constFind(key);
+            if (kIt != m_positions.constEnd())
+            {
+                m_queue[int(kIt.value() - m_dequeued)].message = message;
+                ++m_coalesced;
+                return;
+            }
+
+            m_positions.insert(key, m_dequeued + m_queue.size());
+        }
+
+        Queued queued;
+        queued.key = key;
+        queued.message = message;
+        m_queue.enqueue(queued);
+    }
+
+    //! Writes queued messages while the device takes them
+    void pump(QIODevice *device)
+    {
+        while (!m_queue.isEmpty() && (device->bytesToWrite() < HIGH_WATER_MARK))
+        {
+            const auto kQueued = m_queue.dequeue();
+            if (!(kQueued.key == Key()))
+                m_positions.remove(kQueued.key);
+
+            ++m_dequeued;
+            device->write(kQueued.message);
+        }
+    }
+
+    //! Messages replaced since the last call
+    int takeCoalesced()
+    {
+        const auto kCoalesced = m_coalesced;
+        m_coalesced = 0;
+        return kCoalesced;
+    }
+
+private:
+    struct Queued
+    {
+        Key key;
+        QByteArray message;
+    };
+
+    QQueue<Queued> m_queue;
+    QHash<Key, quint64> m_positions;    // key -> sequence number of its queued message
+    quint64 m_dequeued = 0;             // sequence number of the queue's head
+    int m_coalesced = 0;
+};
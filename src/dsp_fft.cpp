@@ -0,0 +1,79 @@
+#include "dsp_fft.h"
+
+#include <math.h>
+#include <utility>
+
+DspFft::DspFft(int size)
+    : m_size(size)
+{
+    Q_ASSERT((size >= 2) && ((size & (size - 1)) == 0));
+
+    auto bits = 0;
+    while ((1 << bits) < size)
+        ++bits;
+
+    m_bitReverse.resize(size);
+    for (int i = 0; i < size; ++i)
+    {
+        auto reversed = 0;
+        for (int bit = 0; bit < bits; ++bit)
+            reversed |= ((i >> bit) & 1) << (bits - 1 - bit);
+        m_bitReverse[i] = reversed;
+    }
+
+    m_cos.resize(size / 2);
+    m_sin.resize(size / 2);
+    for (int k = 0; k < size / 2; ++k)
+    {
+        const auto kAngle = 2.0 * 3.14159265358979323846 * k / size;
+        m_cos[k] = (float)cos(kAngle);
+        m_sin[k] = (float)sin(kAngle);
+    }
+}
+
+void DspFft::forward(float *re, float *im) const
+{
+    transform(re, im, -1.0f);
+}
+
+void DspFft::inverse(float *re, float *im) const
+{
+    transform(re, im, 1.0f);
+}
+
+void DspFft::transform(float *re, float *im, float direction) const
+{
+    for (int i = 0; i < m_size; ++i)
+    {
+        const auto kReversed = m_bitReverse.at(i);
+        if (kReversed > i)
+        {
+            std::swap(re[i], re[kReversed]);
+            std::swap(im[i], im[kReversed]);
+        }
+    }
+
+    // iterative Cooley-Tukey, the innermost loop runs over contiguous butterflies of a twiddle stride
+    const auto kCos = m_cos.constData();
+    const auto kSin = m_sin.constData();
+    for (int half = 1; half < m_size; half <<= 1)
+    {
+        const auto kStride = m_size / (half * 2);
+        for (int start = 0; start < m_size; start += half * 2)
+        {
+            for (int k = 0; k < half; ++k)
+            {
+                const auto kWr = kCos[k * kStride];
+                const auto kWi = direction * kSin[k * kStride];
+                const auto a = start + k;
+                const auto b = a + half;
+                const auto kTr = (re[b] * kWr) - (im[b] * kWi);
+                const auto kTi = (re[b] * kWi) + (im[b] * kWr);
+                re[b] = re[a] - kTr;
+                im[b] = im[a] - kTi;
+                re[a] += kTr;
+                im[a] += kTi;
+            }
+        }
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <QVector>
+
+//! Radix-2 complex FFT of a fixed power of two size, split real / imaginary arrays, in place
+/*!
+ * Twiddles and the bit reversal permutation are computed on construction; transforms don't allocate.
+ * The inverse is unscaled, divide by size() for the round trip.
+ */
+class DspFft
+{
+public:
+    explicit DspFft(int size);
+
+    int size() const {return m_size;}
+
+    void forward(float* re, float* im) const;
+    void inverse(float* re, float* im) const;
+
+private:
+    void transform(float* re, float* im, float direction) const;
+
+    int m_size;
+    QVector<int> m_bitReverse;
+    QVector<float> m_cos;   // cos(2 pi k / size), k < size / 2
+    QVector<float> m_sin;
+};
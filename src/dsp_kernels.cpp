@@ -0,0 +1,467 @@
+#include "dsp_kernels.h"
+
+#include <math.h>
+#include <algorithm>
+
+#include "dsp_simd.h"
+
+// round to nearest like cvtps2dq does, then clip to int16
+static inline short saturate16(float val)
+{
+    if (val >= 32767.0f)
+        return 32767;
+    if (val <= -32768.0f)
+        return -32768;
+
+    return (short)lrintf(val);
+}
+
+namespace DspKernels
+{
+
+// The vector paths scale a contiguous run of samples, where every sample of a frame has its own ramp.
+// period is the amount of samples per frame in that run (1 or 2), gainStart / gainStep hold one entry per sample of a frame.
+// The gain of the frame f is gainStart + gainStep * (f + 1). Return the amount of samples processed.
+
+#ifdef DSP_KERNELS_AVX2
+static int ScaleRunAvx2(short* samples, int sampleCount, int frameOffset, int period, const float* gainStart, const float* gainStep)
+{
+    float lanes[16];
+    float inc[8];
+    for (int i = 0; i < 16; ++i)
+        lanes[i] = gainStart[i % period] + gainStep[i % period] * (frameOffset + (i / period) + 1);
+    for (int i = 0; i < 8; ++i)
+        inc[i] = gainStep[i % period] * (16 / period);
+
+    auto gains_lo = _mm256_loadu_ps(lanes);
+    auto gains_hi = _mm256_loadu_ps(lanes + 8);
+    const auto kGainsInc = _mm256_loadu_ps(inc);
+
+    int i = 0;
+    for (; i + 16 <= sampleCount; i += 16)
+    {
+        auto p = samples + i;
+        auto in_lo = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)));
+        auto in_hi = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 8)));
+
+        auto out_lo = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(in_lo), gains_lo));
+        auto out_hi = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_cvtepi32_ps(in_hi), gains_hi));
+        // packs works per 128bit lane, restore the sample order afterwards
+        auto out = _mm256_permute4x64_epi64(_mm256_packs_epi32(out_lo, out_hi), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), out);
+
+        gains_lo = _mm256_add_ps(gains_lo, kGainsInc);
+        gains_hi = _mm256_add_ps(gains_hi, kGainsInc);
+    }
+    return i;
+}
+#endif
+
+#ifdef DSP_KERNELS_SSE2
+static int ScaleRunSse2(short* samples, int sampleCount, int frameOffset, int period, const float* gainStart, const float* gainStep)
+{
+    float lanes[8];
+    float inc[4];
+    for (int i = 0; i < 8; ++i)
+        lanes[i] = gainStart[i % period] + gainStep[i % period] * (frameOffset + (i / period) + 1);
+    for (int i = 0; i < 4; ++i)
+        inc[i] = gainStep[i % period] * (8 / period);
+
+    auto gains_lo = _mm_loadu_ps(lanes);
+    auto gains_hi = _mm_loadu_ps(lanes + 4);
+    const auto kGainsInc = _mm_loadu_ps(inc);
+
+    int i = 0;
+    for (; i + 8 <= sampleCount; i += 8)
+    {
+        auto p = reinterpret_cast<__m128i*>(samples + i);
+        auto in = _mm_loadu_si128(p);
+        auto in_lo = _mm_srai_epi32(_mm_unpacklo_epi16(in, in), 16);   // sign extend
+        auto in_hi = _mm_srai_epi32(_mm_unpackhi_epi16(in, in), 16);
+
+        auto out_lo = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(in_lo), gains_lo));
+        auto out_hi = _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(in_hi), gains_hi));
+        _mm_storeu_si128(p, _mm_packs_epi32(out_lo, out_hi));   // saturating
+
+        gains_lo = _mm_add_ps(gains_lo, kGainsInc);
+        gains_hi = _mm_add_ps(gains_hi, kGainsInc);
+    }
+    return i;
+}
+#endif
+
+// Returns the amount of frames processed
+static int ScaleRun(short* samples, int frameCount, int period, const float* gainStart, const float* gainStep)
+{
+    int done = 0;
+#ifdef DSP_KERNELS_SSE2
+    const auto kSampleCount = frameCount * period;
+# ifdef DSP_KERNELS_AVX2
+    done = ScaleRunAvx2(samples, kSampleCount, 0, period, gainStart, gainStep);
+# endif
+    done += ScaleRunSse2(samples + done, kSampleCount - done, done / period, period, gainStart, gainStep);
+#else
+    (void)samples; (void)frameCount; (void)gainStart; (void)gainStep;   // scalar build, the caller does it all
+#endif
+    return done / period;
+}
+
+void PanInterleaved(short* samples, int frameCount, int channels, int leftChannelNr, int rightChannelNr,
+                    float gainLeftStart, float gainRightStart, float gainLeftEnd, float gainRightEnd)
+{
+    if (frameCount <= 0)
+        return;
+
+    const auto kStepLeft = (gainLeftEnd - gainLeftStart) / frameCount;
+    const auto kStepRight = (gainRightEnd - gainRightStart) / frameCount;
+
+    int frame = 0;
+    if ((channels == 2) && (leftChannelNr + rightChannelNr == 1))
+    {
+        const auto kIsLeftFirst = (leftChannelNr == 0);
+        const float kGainStart[2] = { kIsLeftFirst ? gainLeftStart : gainRightStart, kIsLeftFirst ? gainRightStart : gainLeftStart };
+        const float kGainStep[2] = { kIsLeftFirst ? kStepLeft : kStepRight, kIsLeftFirst ? kStepRight : kStepLeft };
+        frame = ScaleRun(samples, frameCount, 2, kGainStart, kGainStep);
+    }
+
+    // tail / generic channel layouts
+    for (; frame < frameCount; ++frame)
+    {
+        const auto kGainLeft = gainLeftStart + kStepLeft * (frame + 1);
+        const auto kGainRight = gainRightStart + kStepRight * (frame + 1);
+        auto pLeft = samples + leftChannelNr + (frame * channels);
+        auto pRight = samples + rightChannelNr + (frame * channels);
+        *pLeft = saturate16(*pLeft * kGainLeft);
+        *pRight = saturate16(*pRight * kGainRight);
+    }
+}
+
+// Frame by frame with one gain register of up to eight channels. Every store writes eight samples; the ones past
+// the frame are overwritten by the next frame, so only the frames whose store would pass the end of the block are left
+// to the scalar loop.
+void MixMonoInterleaved(const float* mono, short* samples, int frameCount, int channels, const float* gainsStart, const float* gainsEnd)
+{
+    if ((frameCount <= 0) || (channels <= 0))
+        return;
+
+    int frame = 0;
+#ifdef DSP_KERNELS_SSE2
+    if (channels <= 8)
+    {
+        float start[8] = {};
+        float step[8] = {};
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            step[channel] = (gainsEnd[channel] - gainsStart[channel]) / frameCount;
+            start[channel] = gainsStart[channel] + step[channel];
+        }
+        const auto kVectorFrames = ((frameCount * channels) >= 8) ? (((frameCount * channels) - 8) / channels) + 1 : 0;
+# ifdef DSP_KERNELS_AVX2
+        auto gains = _mm256_loadu_ps(start);
+        const auto kStep = _mm256_loadu_ps(step);
+        for (; frame < kVectorFrames; ++frame)
+        {
+            const auto kOut = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_set1_ps(mono[frame]), gains));
+            const auto kPacked = _mm_packs_epi32(_mm256_castsi256_si128(kOut), _mm256_extracti128_si256(kOut, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + (frame * channels)), kPacked);
+            gains = _mm256_add_ps(gains, kStep);
+        }
+# else
+        auto gains_lo = _mm_loadu_ps(start);
+        auto gains_hi = _mm_loadu_ps(start + 4);
+        const auto kStepLo = _mm_loadu_ps(step);
+        const auto kStepHi = _mm_loadu_ps(step + 4);
+        for (; frame < kVectorFrames; ++frame)
+        {
+            const auto kIn = _mm_set1_ps(mono[frame]);
+            const auto kOutLo = _mm_cvtps_epi32(_mm_mul_ps(kIn, gains_lo));
+            const auto kOutHi = _mm_cvtps_epi32(_mm_mul_ps(kIn, gains_hi));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(samples + (frame * channels)), _mm_packs_epi32(kOutLo, kOutHi));
+            gains_lo = _mm_add_ps(gains_lo, kStepLo);
+            gains_hi = _mm_add_ps(gains_hi, kStepHi);
+        }
+# endif
+    }
+#endif
+
+    for (; frame < frameCount; ++frame)
+    {
+        auto p = samples + (frame * channels);
+        for (int channel = 0; channel < channels; ++channel)
+        {
+            const auto kStep = (gainsEnd[channel] - gainsStart[channel]) / frameCount;
+            p[channel] = saturate16(mono[frame] * (gainsStart[channel] + kStep * (frame + 1)));
+        }
+    }
+}
+
+// Float counterpart of the ScaleRun functions above, same lane layout
+#ifdef DSP_KERNELS_AVX2
+static int ScaleRunFloatAvx(float* samples, int sampleCount, int frameOffset, int period, const float* gainStart, const float* gainStep)
+{
+    float lanes[8];
+    float inc[8];
+    for (int i = 0; i < 8; ++i)
+    {
+        lanes[i] = gainStart[i % period] + gainStep[i % period] * (frameOffset + (i / period) + 1);
+        inc[i] = gainStep[i % period] * (8 / period);
+    }
+
+    auto gains = _mm256_loadu_ps(lanes);
+    const auto kGainsInc = _mm256_loadu_ps(inc);
+
+    int i = 0;
+    for (; i + 8 <= sampleCount; i += 8)
+    {
+        _mm256_storeu_ps(samples + i, _mm256_mul_ps(_mm256_loadu_ps(samples + i), gains));
+        gains = _mm256_add_ps(gains, kGainsInc);
+    }
+    return i;
+}
+#endif
+
+#ifdef DSP_KERNELS_SSE2
+static int ScaleRunFloatSse2(float* samples, int sampleCount, int frameOffset, int period, const float* gainStart, const float* gainStep)
+{
+    float lanes[4];
+    float inc[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        lanes[i] = gainStart[i % period] + gainStep[i % period] * (frameOffset + (i / period) + 1);
+        inc[i] = gainStep[i % period] * (4 / period);
+    }
+
+    auto gains = _mm_loadu_ps(lanes);
+    const auto kGainsInc = _mm_loadu_ps(inc);
+
+    int i = 0;
+    for (; i + 4 <= sampleCount; i += 4)
+    {
+        _mm_storeu_ps(samples + i, _mm_mul_ps(_mm_loadu_ps(samples + i), gains));
+        gains = _mm_add_ps(gains, kGainsInc);
+    }
+    return i;
+}
+#endif
+
+static int ScaleRunFloat(float* samples, int frameCount, int period, const float* gainStart, const float* gainStep)
+{
+    int done = 0;
+#ifdef DSP_KERNELS_SSE2
+    const auto kSampleCount = frameCount * period;
+# ifdef DSP_KERNELS_AVX2
+    done = ScaleRunFloatAvx(samples, kSampleCount, 0, period, gainStart, gainStep);
+# endif
+    done += ScaleRunFloatSse2(samples + done, kSampleCount - done, done / period, period, gainStart, gainStep);
+#else
+    (void)samples; (void)frameCount; (void)gainStart; (void)gainStep;   // scalar build, the caller does it all
+#endif
+    return done / period;
+}
+
+void ApplyGainRamp(float* samples, int frameCount, int channels, float gainStart, float gainEnd)
+{
+    if ((frameCount <= 0) || ((gainStart == 1.0f) && (gainEnd == 1.0f)))
+        return;
+
+    const auto kStep = (gainEnd - gainStart) / frameCount;
+
+    int frame = 0;
+    if ((channels == 1) || (channels == 2))
+    {
+        const float kGainStart[2] = { gainStart, gainStart };
+        const float kGainStep[2] = { kStep, kStep };
+        frame = ScaleRunFloat(samples, frameCount, channels, kGainStart, kGainStep);
+    }
+
+    for (; frame < frameCount; ++frame)
+    {
+        const auto kGain = gainStart + kStep * (frame + 1);
+        auto p = samples + (frame * channels);
+        for (int channel = 0; channel < channels; ++channel)
+            p[channel] *= kGain;
+    }
+}
+
+void Int16ToFloat(const short* in, float* out, int sampleCount)
+{
+    const float kScale = 1.0f / 32768.0f;
+    int i = 0;
+#ifdef DSP_KERNELS_SSE2
+    const auto kScaleV = _mm_set1_ps(kScale);
+    for (; i + 8 <= sampleCount; i += 8)
+    {
+        auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+        auto lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        auto hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), kScaleV));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), kScaleV));
+    }
+#endif
+    for (; i < sampleCount; ++i)
+        out[i] = in[i] * kScale;
+}
+
+// TPDF dither: sum of two uniform values, spans +-1 LSB.
+// Sample i of a group of four uses lane i, every group advances all lanes twice; the scalar path does the same,
+// so the output doesn't depend on the instruction set.
+static inline unsigned int xorshift32(unsigned int &x)
+{
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+void FloatToInt16(const float* in, short* out, int sampleCount, DitherState &dither)
+{
+    const float kUniformScale = 1.0f / 16777216.0f;  // 24 bit -> 0...1
+    int i = 0;
+#ifdef DSP_KERNELS_SSE2
+    auto state = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dither.lanes));
+    const auto kScaleV = _mm_set1_ps(32768.0f);
+    const auto kUniformScaleV = _mm_set1_ps(kUniformScale);
+    const auto kZero = _mm_setzero_ps();
+    auto next = [&state]()
+    {
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 13));
+        state = _mm_xor_si128(state, _mm_srli_epi32(state, 17));
+        state = _mm_xor_si128(state, _mm_slli_epi32(state, 5));
+        return _mm_cvtepi32_ps(_mm_srli_epi32(state, 8));
+    };
+    for (; i + 8 <= sampleCount; i += 8)
+    {
+        __m128i packed[2];
+        for (int half = 0; half < 2; ++half)
+        {
+            const auto kIn = _mm_loadu_ps(in + i + (half * 4));
+            const auto kA = next();
+            const auto kB = next();
+            auto noise = _mm_mul_ps(_mm_sub_ps(kA, kB), kUniformScaleV);
+            noise = _mm_and_ps(noise, _mm_cmpneq_ps(kIn, kZero));
+            packed[half] = _mm_cvtps_epi32(_mm_add_ps(_mm_mul_ps(kIn, kScaleV), noise));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(packed[0], packed[1]));   // saturating
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dither.lanes), state);
+#endif
+    for (; i < sampleCount; i += 4)
+    {
+        float noise[4];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            const auto kA = (float)(xorshift32(dither.lanes[lane]) >> 8);
+            const auto kB = (float)(xorshift32(dither.lanes[lane]) >> 8);
+            noise[lane] = (kA - kB) * kUniformScale;
+        }
+        for (int lane = 0; (lane < 4) && (i + lane < sampleCount); ++lane)
+        {
+            const auto kIn = in[i + lane];
+            out[i + lane] = saturate16((kIn * 32768.0f) + ((kIn != 0.0f) ? noise[lane] : 0.0f));
+        }
+    }
+}
+
+// Same operation order on every path, truncation in all cases, so the output doesn't depend on the instruction set.
+// The noisy signal is bounded before the int conversion to keep it defined.
+void QuantiseMix(float* samples, const float* noise, int sampleCount, float noiseGain, float levels, float wet)
+{
+    const auto kDry = 1.0f - wet;
+    const auto kLimit = 1048576.0f / levels;
+    int i = 0;
+#ifdef DSP_KERNELS_AVX2
+    {
+        const auto kNoiseGainV = _mm256_set1_ps(noiseGain);
+        const auto kLevelsV = _mm256_set1_ps(levels);
+        const auto kWetV = _mm256_set1_ps(wet);
+        const auto kDryV = _mm256_set1_ps(kDry);
+        const auto kLimitV = _mm256_set1_ps(kLimit);
+        const auto kMinusLimitV = _mm256_set1_ps(-kLimit);
+        const auto kOneV = _mm256_set1_ps(1.0f);
+        const auto kMinusOneV = _mm256_set1_ps(-1.0f);
+        for (; i + 8 <= sampleCount; i += 8)
+        {
+            const auto kIn = _mm256_loadu_ps(samples + i);
+            auto temp = _mm256_add_ps(kIn, _mm256_mul_ps(_mm256_loadu_ps(noise + i), kNoiseGainV));
+            temp = _mm256_min_ps(_mm256_max_ps(temp, kMinusLimitV), kLimitV);
+            temp = _mm256_div_ps(_mm256_cvtepi32_ps(_mm256_cvttps_epi32(_mm256_mul_ps(temp, kLevelsV))), kLevelsV);
+            temp = _mm256_add_ps(_mm256_mul_ps(temp, kWetV), _mm256_mul_ps(kIn, kDryV));
+            _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(temp, kMinusOneV), kOneV));
+        }
+    }
+#endif
+#ifdef DSP_KERNELS_SSE2
+    {
+        const auto kNoiseGainV = _mm_set1_ps(noiseGain);
+        const auto kLevelsV = _mm_set1_ps(levels);
+        const auto kWetV = _mm_set1_ps(wet);
+        const auto kDryV = _mm_set1_ps(kDry);
+        const auto kLimitV = _mm_set1_ps(kLimit);
+        const auto kMinusLimitV = _mm_set1_ps(-kLimit);
+        const auto kOneV = _mm_set1_ps(1.0f);
+        const auto kMinusOneV = _mm_set1_ps(-1.0f);
+        for (; i + 4 <= sampleCount; i += 4)
+        {
+            const auto kIn = _mm_loadu_ps(samples + i);
+            auto temp = _mm_add_ps(kIn, _mm_mul_ps(_mm_loadu_ps(noise + i), kNoiseGainV));
+            temp = _mm_min_ps(_mm_max_ps(temp, kMinusLimitV), kLimitV);
+            temp = _mm_div_ps(_mm_cvtepi32_ps(_mm_cvttps_epi32(_mm_mul_ps(temp, kLevelsV))), kLevelsV);
+            temp = _mm_add_ps(_mm_mul_ps(temp, kWetV), _mm_mul_ps(kIn, kDryV));
+            _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(temp, kMinusOneV), kOneV));
+        }
+    }
+#endif
+    for (; i < sampleCount; ++i)
+    {
+        const auto kIn = samples[i];
+        auto temp = kIn + (noise[i] * noiseGain);
+        temp = std::min(std::max(temp, -kLimit), kLimit);
+        temp = (float)(int)(temp * levels) / levels;
+        temp = (temp * wet) + (kIn * kDry);
+        samples[i] = std::min(std::max(temp, -1.0f), 1.0f);
+    }
+}
+
+void Modulate(float* samples, const float* modulator, int sampleCount, float depth)
+{
+    const auto kDry = 1.0f - depth;
+    int i = 0;
+#ifdef DSP_KERNELS_AVX2
+    {
+        const auto kDepthV = _mm256_set1_ps(depth);
+        const auto kDryV = _mm256_set1_ps(kDry);
+        const auto kOneV = _mm256_set1_ps(1.0f);
+        const auto kMinusOneV = _mm256_set1_ps(-1.0f);
+        for (; i + 8 <= sampleCount; i += 8)
+        {
+            const auto kIn = _mm256_loadu_ps(samples + i);
+            const auto kWet = _mm256_mul_ps(kDepthV, _mm256_mul_ps(kIn, _mm256_loadu_ps(modulator + i)));
+            const auto kOut = _mm256_add_ps(_mm256_mul_ps(kIn, kDryV), kWet);
+            _mm256_storeu_ps(samples + i, _mm256_min_ps(_mm256_max_ps(kOut, kMinusOneV), kOneV));
+        }
+    }
+#endif
+#ifdef DSP_KERNELS_SSE2
+    {
+        const auto kDepthV = _mm_set1_ps(depth);
+        const auto kDryV = _mm_set1_ps(kDry);
+        const auto kOneV = _mm_set1_ps(1.0f);
+        const auto kMinusOneV = _mm_set1_ps(-1.0f);
+        for (; i + 4 <= sampleCount; i += 4)
+        {
+            const auto kIn = _mm_loadu_ps(samples + i);
+            const auto kWet = _mm_mul_ps(kDepthV, _mm_mul_ps(kIn, _mm_loadu_ps(modulator + i)));
+            const auto kOut = _mm_add_ps(_mm_mul_ps(kIn, kDryV), kWet);
+            _mm_storeu_ps(samples + i, _mm_min_ps(_mm_max_ps(kOut, kMinusOneV), kOneV));
+        }
+    }
+#endif
+    for (; i < sampleCount; ++i)
+    {
+        const auto kIn = samples[i];
+        const auto kOut = (kIn * kDry) + (depth * (kIn * modulator[i]));
+        samples[i] = std::min(std::max(kOut, -1.0f), 1.0f);
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+// Vectorised inner loops shared by the dsp objects, see dsp_simd.h for the instruction sets used.
+
+namespace DspKernels
+{
+    //! Pans two channels of an interleaved int16 buffer in place, ramping the gains linearly across the block
+    /*!
+     * \brief PanInterleaved the ramp starts at the *Start gains on the first frame and reaches the *End gains after the last frame
+     * \param samples the interleaved sample array to manipulate
+     * \param frameCount amount of samples per channel
+     * \param channels amount of channels
+     * \param leftChannelNr the channel receiving the left gain
+     * \param rightChannelNr the channel receiving the right gain
+     * \param gainLeftStart linear gain of the left channel at the start of the block
+     * \param gainRightStart linear gain of the right channel at the start of the block
+     * \param gainLeftEnd linear gain of the left channel at the end of the block
+     * \param gainRightEnd linear gain of the right channel at the end of the block
+     */
+    void PanInterleaved(short* samples, int frameCount, int channels, int leftChannelNr, int rightChannelNr,
+                        float gainLeftStart, float gainRightStart, float gainLeftEnd, float gainRightEnd);
+
+    //! Writes a mono signal into every channel of an interleaved int16 buffer, each channel with its own linear gain ramp
+    /*!
+     * \brief MixMonoInterleaved one gain vector per frame, so up to eight channels are a single multiply;
+     * the ramp starts at gainsStart on the first frame and reaches gainsEnd after the last frame
+     * \param mono one sample per frame, int16 scale
+     * \param samples the interleaved sample array to overwrite
+     * \param frameCount amount of samples per channel
+     * \param channels amount of channels
+     * \param gainsStart linear gain per channel at the start of the block
+     * \param gainsEnd linear gain per channel at the end of the block
+     */
+    void MixMonoInterleaved(const float* mono, short* samples, int frameCount, int channels, const float* gainsStart, const float* gainsEnd);
+
+    //! Applies a gain to all channels of an interleaved float buffer in place, ramping it linearly across the block
+    /*!
+     * \brief ApplyGainRamp a block with unity gain at both ends is left untouched
+     * \param samples the interleaved sample array to manipulate
+     * \param frameCount amount of samples per channel
+     * \param channels amount of channels
+     * \param gainStart linear gain at the start of the block (usually the end gain of the previous block)
+     * \param gainEnd linear gain reached on the last frame
+     */
+    void ApplyGainRamp(float* samples, int frameCount, int channels, float gainStart, float gainEnd);
+
+    //! Converts int16 samples to floats in the range -1...+1
+    void Int16ToFloat(const short* in, float* out, int sampleCount);
+
+    //! State of the dither noise generator, four independent xorshift32 lanes
+    struct DitherState
+    {
+        unsigned int lanes[4] = { 0x6D2B79F5u, 0x1B873593u, 0xCC9E2D51u, 0x85EBCA6Bu };
+    };
+
+    //! Converts floats in the range -1...+1 back to int16 with TPDF dither and saturation
+    /*!
+     * \brief FloatToInt16 exact zeros stay zero, so silence is not turned into noise
+     * \param in the float samples
+     * \param out the int16 samples; may not alias in
+     * \param sampleCount amount of samples
+     * \param dither generator state, advanced by the call
+     */
+    void FloatToInt16(const float* in, short* out, int sampleCount, DitherState &dither);
+
+    //! Adds scaled noise, quantises to a few levels and mixes the result with the dry signal, in place
+    /*!
+     * \brief QuantiseMix branch-free; out = clamp(trunc((in + noise * noiseGain) * levels) / levels * wet + in * (1 - wet), -1, +1)
+     * \param samples the float samples to manipulate
+     * \param noise one noise value per sample
+     * \param sampleCount amount of samples
+     * \param noiseGain gain applied to the noise
+     * \param levels quantisation steps per 1.0f
+     * \param wet share of the quantised signal in the output
+     */
+    void QuantiseMix(float* samples, const float* noise, int sampleCount, float noiseGain, float levels, float wet);
+
+    //! Ring modulation, in place: out = clamp(in * (1 - depth) + depth * (in * modulator), -1, +1)
+    /*!
+     * \param samples the float samples to manipulate
+     * \param modulator one modulator value per sample, -1...+1
+     * \param sampleCount amount of samples
+     * \param depth 0: dry, 1: fully modulated
+     */
+    void Modulate(float* samples, const float* modulator, int sampleCount, float depth);
+}
@@ -0,0 +1,109 @@
+#include "dsp_oscillator.h"
+
+#include <cmath>
+#include <algorithm>
+
+#include "dsp_simd.h"
+
+const double TWO_PI = 6.283185307179586476925286766559;
+const int RENORMALISE_INTERVAL = 256;   // samples rendered from one anchor; ~1e-5 worst case float drift
+
+#ifdef DSP_KERNELS_AVX2
+const int LANES = 8;
+#else
+const int LANES = 4;
+#endif
+
+void DspOscillator::setFrequency(double frequency, double sampleRate)
+{
+    m_frequency = frequency;
+    m_increment = (sampleRate > 0.0) ? (TWO_PI * frequency / sampleRate) : 0.0;
+    m_rotationRe = (float)std::cos(m_increment * LANES);
+    m_rotationIm = (float)std::sin(m_increment * LANES);
+}
+
+void DspOscillator::setPhase(double phase)
+{
+    m_phase = std::fmod(phase, TWO_PI);
+    if (m_phase < 0.0)
+        m_phase += TWO_PI;
+}
+
+void DspOscillator::render(float *out, int sampleCount)
+{
+    for (int offset = 0; offset < sampleCount; offset += RENORMALISE_INTERVAL)
+    {
+        const auto kCount = std::min(RENORMALISE_INTERVAL, sampleCount - offset);
+        renderRun(out + offset, kCount);
+        setPhase(m_phase + (kCount * m_increment));
+    }
+}
+
+// Lane k starts at phase + k * increment, every step rotates all lanes by LANES * increment
+void DspOscillator::renderRun(float *out, int sampleCount)
+{
+    float re[LANES];
+    float im[LANES];
+    {
+        const auto kStepRe = std::cos(m_increment);
+        const auto kStepIm = std::sin(m_increment);
+        auto zRe = std::cos(m_phase);
+        auto zIm = std::sin(m_phase);
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            re[lane] = (float)zRe;
+            im[lane] = (float)zIm;
+            const auto kRe = (zRe * kStepRe) - (zIm * kStepIm);
+            zIm = (zRe * kStepIm) + (zIm * kStepRe);
+            zRe = kRe;
+        }
+    }
+
+    int i = 0;
+#if defined(DSP_KERNELS_AVX2)
+    {
+        auto zRe = _mm256_loadu_ps(re);
+        auto zIm = _mm256_loadu_ps(im);
+        const auto kRotRe = _mm256_set1_ps(m_rotationRe);
+        const auto kRotIm = _mm256_set1_ps(m_rotationIm);
+        for (; i + LANES <= sampleCount; i += LANES)
+        {
+            _mm256_storeu_ps(out + i, zIm);
+            const auto kRe = _mm256_sub_ps(_mm256_mul_ps(zRe, kRotRe), _mm256_mul_ps(zIm, kRotIm));
+            zIm = _mm256_add_ps(_mm256_mul_ps(zRe, kRotIm), _mm256_mul_ps(zIm, kRotRe));
+            zRe = kRe;
+        }
+        _mm256_storeu_ps(re, zRe);
+        _mm256_storeu_ps(im, zIm);
+    }
+#elif defined(DSP_KERNELS_SSE2)
+    {
+        auto zRe = _mm_loadu_ps(re);
+        auto zIm = _mm_loadu_ps(im);
+        const auto kRotRe = _mm_set1_ps(m_rotationRe);
+        const auto kRotIm = _mm_set1_ps(m_rotationIm);
+        for (; i + LANES <= sampleCount; i += LANES)
+        {
+            _mm_storeu_ps(out + i, zIm);
+            const auto kRe = _mm_sub_ps(_mm_mul_ps(zRe, kRotRe), _mm_mul_ps(zIm, kRotIm));
+            zIm = _mm_add_ps(_mm_mul_ps(zRe, kRotIm), _mm_mul_ps(zIm, kRotRe));
+            zRe = kRe;
+        }
+        _mm_storeu_ps(re, zRe);
+        _mm_storeu_ps(im, zIm);
+    }
+#else
+    for (; i + LANES <= sampleCount; i += LANES)
+    {
+        for (int lane = 0; lane < LANES; ++lane)
+        {
+            out[i + lane] = im[lane];
+            const auto kRe = (re[lane] * m_rotationRe) - (im[lane] * m_rotationIm);
+            im[lane] = (re[lane] * m_rotationIm) + (im[lane] * m_rotationRe);
+            re[lane] = kRe;
+        }
+    }
+#endif
+    for (int lane = 0; i < sampleCount; ++i, ++lane)
+        out[i] = im[lane];
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+//! Sine oscillator for modulation and LFOs, without a sin() call per sample
+/*!
+ * Samples come from complex phasors rotated by a fixed step, one phasor per SIMD lane.
+ * The phase itself is kept in double precision and wrapped to one period; the phasors are re-anchored on it
+ * every RENORMALISE_INTERVAL samples, so neither the amplitude nor the phase drift in long sessions.
+ * Not thread-safe, one instance belongs to the thread rendering it.
+ */
+class DspOscillator
+{
+public:
+    void setFrequency(double frequency, double sampleRate);
+    double getFrequency() const {return m_frequency;}
+
+    void setPhase(double phase);
+    double getPhase() const {return m_phase;}
+
+    //! Writes the next sampleCount values, -1...+1
+    void render(float* out, int sampleCount);
+
+private:
+    void renderRun(float* out, int sampleCount);
+
+    double m_frequency = 0.0;
+    double m_increment = 0.0;   // radians per sample
+    double m_phase = 0.0;       // 0...2pi
+
+    // rotation of the phasors from one lane group to the next
+    float m_rotationRe = 1.0f;
+    float m_rotationIm = 0.0f;
+};
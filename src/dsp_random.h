@@ -0,0 +1,42 @@
+#pragma once
+
+#include <QtGlobal>
+
+//! Small per instance pseudo random generator for the dsp objects (xorshift32)
+/*!
+ * Deterministic for a given seed. Unlike rand() there is no state shared between threads or talkers,
+ * so talkers neither contend on nor correlate through a global generator.
+ */
+class DspRandom
+{
+public:
+    explicit DspRandom(quint32 seed = 0)
+    {
+        setSeed(seed);
+    }
+
+    void setSeed(quint32 seed)
+    {
+        // spread neighbouring seeds (e.g. consecutive client ids) apart; xorshift must not start at 0
+        m_state = seed * 0x9E3779B9u;
+        if (m_state == 0)
+            m_state = 0x6D2B79F5u;
+    }
+
+    quint32 next()
+    {
+        m_state ^= m_state << 13;
+        m_state ^= m_state >> 17;
+        m_state ^= m_state << 5;
+        return m_state;
+    }
+
+    //! -1.0f...+1.0f
+    float nextBipolar()
+    {
+        return ((float)(next() >> 8) * (1.0f / 8388608.0f)) - 1.0f;
+    }
+
+private:
+    quint32 m_state;
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// Instruction sets used by the vectorised dsp loops.
+// SSE2 is used on any x86 target that guarantees it (all x64 builds), AVX2 only when the compiler targets it;
+// everything else falls back to the scalar loops.
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define DSP_KERNELS_AVX2
+#define DSP_KERNELS_SSE2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#include <emmintrin.h>
+#define DSP_KERNELS_SSE2
+#endif
@@ -1,6 +1,7 @@
 #include "dsp_volume.h"
 
 #include "db.h"
+#include "dsp_kernels.h"
 
 const float GAIN_FADE_RATE = (400.0f);	// Rate to fade at (dB per second)
 
@@ -18,11 +19,7 @@ DspVolume::DspVolume(QObject *parent) :
 */
 void DspVolume::setGainCurrent(float val)
 {
-    if (val != m_gainCurrent)
-    {
-        m_gainCurrent = val;
-        emit gainCurrentChanged(m_gainCurrent);
-    }
+    m_gainCurrent = val;    // called per block on the playback thread, see Telemetry for ui updates
 }
 
 //! Gets the current gain (dB) either set by user interaction or gain adjustment
@@ -87,11 +84,10 @@ bool DspVolume::isMuted() const
     return m_muted;
 }
 
-void DspVolume::process(short *samples, int sampleCount, int channels)
+void DspVolume::process(float *samples, int sampleCount, int channels)
 {
-    sampleCount = sampleCount * channels;
-    setGainCurrent(GetFadeStep(sampleCount));
-    doProcess(samples,sampleCount);
+    setGainCurrent(GetFadeStep(sampleCount * channels));
+    doProcess(samples, sampleCount, channels);
 }
 
 float DspVolume::GetFadeStep(int sampleCount)
@@ -127,13 +123,20 @@ float DspVolume::GetFadeStep(int sampleCount)
     return current_gain;
 }
 
-//! Apply volume (no need to care for channels)
-void DspVolume::doProcess(short *samples, int sampleCount)
+//! Apply volume, ramping from the gain of the previous block
+/*!
+ * \brief DspVolume::doProcess the linear gain is only recomputed when the current gain (dB) changed
+ * \param samples the interleaved float bus to manipulate
+ * \param sampleCount amount of samples per channel
+ * \param channels amount of channels
+ */
+void DspVolume::doProcess(float *samples, int sampleCount, int channels)
 {
-    float mix_gain = db2lin_alt2(m_gainCurrent);
-    for ( int i_sample=0; i_sample<sampleCount; ++i_sample )
+    if (m_gainCurrent != m_gainLinearDb)
     {
-        int temp = samples[i_sample] * mix_gain;
-        samples[i_sample] = qBound(-32768, temp, 32767);
+        m_gainLinear = db2lin_alt2(m_gainCurrent);
+        m_gainLinearDb = m_gainCurrent;
     }
+    DspKernels::ApplyGainRamp(samples, sampleCount, channels, m_gainLinearPrevious, m_gainLinear);
+    m_gainLinearPrevious = m_gainLinear;
 }
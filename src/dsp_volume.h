@@ -8,7 +8,7 @@ const float VOLUME_MUTED = (-200.0f);
 class DspVolume : public QObject
 {
     Q_OBJECT
-    Q_PROPERTY(float gainCurrent READ getGainCurrent WRITE setGainCurrent NOTIFY gainCurrentChanged)
+    Q_PROPERTY(float gainCurrent READ getGainCurrent WRITE setGainCurrent)
     Q_PROPERTY(float gainDesired READ getGainDesired WRITE setGainDesired NOTIFY gainDesiredChanged)
     Q_PROPERTY(bool processing READ isProcessing WRITE setProcessing)  // is Talking
     Q_PROPERTY(bool muted READ isMuted WRITE setMuted)
@@ -26,22 +26,26 @@ public:
     void setMuted(bool val);
     bool isMuted() const;
 
-    virtual void process(short* samples, int sampleCount, int channels);
+    virtual void process(float* samples, int sampleCount, int channels);
     virtual float GetFadeStep(int sampleCount);
 
 signals:
-    void gainCurrentChanged(float);
     void gainDesiredChanged(float);
 
 public slots:
     
 protected:
     unsigned short m_sampleRate = 48000;
-    void doProcess(short *samples, int sampleCount);
+    void doProcess(float *samples, int sampleCount, int channels);
     bool m_isProcessing = false;
 
 private:
     float m_gainCurrent = VOLUME_0DB;   // decibels
     float m_gainDesired = VOLUME_0DB;   // decibels
     bool m_muted = false;
+
+    // linear gain cache for doProcess
+    float m_gainLinearDb = VOLUME_0DB;
+    float m_gainLinear = 1.0f;
+    float m_gainLinearPrevious = 1.0f;  // applied at the end of the previous block
 };
@@ -14,10 +14,10 @@ DspVolumeAGMU::DspVolumeAGMU(QObject *parent)
 
 // Funcs
 
-void DspVolumeAGMU::process(short *samples, int sampleCount, int channels)
+void DspVolumeAGMU::process(float *samples, int sampleCount, int channels)
 {
-    sampleCount = sampleCount * channels;
-    auto peak = getPeak(samples,sampleCount);
+    // the peak is kept in int16 units, it's cached across sessions
+    auto peak = (short)qMin(getPeak(samples,sampleCount * channels) * 32768.0f, 32767.0f);
     peak = qMax(m_peak,peak);
     if (peak != m_peak)
     {
@@ -26,8 +26,8 @@ void DspVolumeAGMU::process(short *samples, int sampleCount, int channels)
         setGainDesired(computeGainDesired());
         //TSLogging::Log(QString("Peak: %1 desired Gain: %2").arg(m_peak).arg(getGainDesired()),LogLevel_DEBUG);
     }
-    setGainCurrent(GetFadeStep(sampleCount));
-    doProcess(samples, sampleCount);
+    setGainCurrent(GetFadeStep(sampleCount * channels));
+    doProcess(samples, sampleCount, channels);
 }
 
 // Compute gain change
@@ -12,7 +12,7 @@ class DspVolumeAGMU : public DspVolume
 public:
     explicit DspVolumeAGMU(QObject *parent = 0);
 
-    void process(short *samples, int sampleCount, int channels);
+    void process(float *samples, int sampleCount, int channels);
     float GetFadeStep(int sampleCount);
     short GetPeak() const;
     void setPeak(short val);    //Overwrite peak; use for reinitializations with cache values etc.
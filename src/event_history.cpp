@@ -0,0 +1,63 @@
+#include "event_history.h"
+
+#include <QDateTime>
+
+EventHistory::EventHistory()
+    : m_ring(CAPACITY)
+    , m_lastId((quint64)QDateTime::currentMSecsSinceEpoch() * 1000)
+{
+}
+
+quint64 EventHistory::append(const QByteArray &data)
+{
+    auto &event = m_ring[++m_lastId % CAPACITY];
+    event.id = m_lastId;
+    event.data = data;
+    return m_lastId;
+}
+
+bool EventHistory::since(quint64 lastId, QVector<Event> &events) const
+{
+    if (lastId > m_lastId)
+        return false;
+
+    const auto kCount = m_lastId - lastId;
+    if (kCount > (quint64)CAPACITY)
+        return false;
+
+    events.reserve(events.size() + (int)kCount);
+    for (auto id = lastId + 1; id <= m_lastId; ++id)
+    {
+        const auto &event = m_ring.at(id % CAPACITY);
+        if (event.id != id)     // not written in this run
+            return false;
+
+        events.append(event);
+    }
+    return true;
+}
+
+void EventHistory::setState(const QString &key, const QString &json)
+{
+    m_state.insert(key, json);
+}
+
+void EventHistory::removeState(const QString &key)
+{
+    m_state.remove(key);
+}
+
+void EventHistory::clearState()
+{
+    m_state.clear();
+}
+
+QVector<QByteArray> EventHistory::snapshot() const
+{
+    QVector<QByteArray> events;
+    events.reserve(m_state.size());
+    for (auto it = m_state.constBegin(); it != m_state.constEnd(); ++it)
+        events.append(it.value().toUtf8());
+
+    return events;
+}
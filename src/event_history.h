@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+//! Recent events of a stream and the state they add up to
+/*!
+ * Events are numbered; the last CAPACITY of them are kept, so a client reconnecting with the id of the last event it
+ * got (SSE's Last-Event-ID) can be sent what it missed. Ids continue across plugin restarts, an id of a former run
+ * is never mistaken for a current one.
+ * Alongside, the producer keeps the latest JSON object per key (a player, a talker); snapshot() returns them, in the
+ * format of the stream's own events, as the current state for new clients and ones that were gone for too long.
+ */
+class EventHistory
+{
+public:
+    static const int CAPACITY = 1024;   // an event per player update: seconds of a crowded map
+
+    EventHistory();
+
+    quint64 append(const QByteArray &data);     // returns the id
+    quint64 getLastId() const {return m_lastId;}
+
+    struct Event
+    {
+        quint64 id = 0;
+        QByteArray data;
+    };
+    //! The events after lastId; false if some of them aren't held anymore
+    bool since(quint64 lastId, QVector<Event> &events) const;
+
+    void setState(const QString &key, const QString &json);
+    void removeState(const QString &key);
+    void clearState();
+    QVector<QByteArray> snapshot() const;   // UTF-8, an object per key
+
+private:
+    QVector<Event> m_ring;
+    quint64 m_lastId;
+    QHash<QString, QString> m_state;
+};
@@ -0,0 +1,169 @@
+#include "http_request_parser.h"
+
+#include <string.h>
+
+namespace {
+
+bool isSpace(char c)
+{
+    return (c == ' ') || (c == '\t');
+}
+
+bool equalsNoCase(const char *a, const char *b, int length)
+{
+    for (int i = 0; i < length; ++i)
+    {
+        auto ca = a[i];
+        auto cb = b[i];
+        if ((ca >= 'A') && (ca <= 'Z'))
+            ca += 'a' - 'A';
+        if ((cb >= 'A') && (cb <= 'Z'))
+            cb += 'a' - 'A';
+        if (ca != cb)
+            return false;
+    }
+    return true;
+}
+
+}
+
+HttpRequestParser::State HttpRequestParser::parse(const QByteArray &buffer)
+{
+    m_buffer = buffer.constData();
+    const auto kSize = buffer.size();
+
+    while (m_headLength == 0)
+    {
+        const auto kLineEnd = buffer.indexOf('\n', m_pos);
+        if (kLineEnd < 0)
+            return (kSize > MAX_HEAD_SIZE) ? Error : Incomplete;
+
+        if (kLineEnd >= MAX_HEAD_SIZE)
+            return Error;
+
+        auto end = kLineEnd;
+        if ((end > m_pos) && (m_buffer[end - 1] == '\r'))
+            --end;
+
+        if (m_method.length == 0)
+        {
+            if (end == m_pos)   // tolerate empty lines ahead of the request line
+            {
+                m_pos = kLineEnd + 1;
+                continue;
+            }
+            if (!parseRequestLine(m_buffer, m_pos, end))
+                return Error;
+        }
+        else if (end == m_pos)
+        {
+            m_headLength = kLineEnd + 1;
+            const auto kContentLength = header("Content-Length");
+            if (!kContentLength.isEmpty())
+            {
+                bool ok;
+                m_bodyLength = kContentLength.toInt(&ok);
+                if (!ok || (m_bodyLength < 0) || (m_bodyLength > MAX_BODY_SIZE))
+                    return Error;
+            }
+        }
+        else if (!parseHeader(m_buffer, m_pos, end))
+            return Error;
+
+        m_pos = kLineEnd + 1;
+    }
+
+    return (kSize >= requestLength()) ? Complete : Incomplete;
+}
+
+void HttpRequestParser::reset()
+{
+    m_buffer = nullptr;
+    m_pos = 0;
+    m_headLength = 0;
+    m_bodyLength = 0;
+    m_method = Range();
+    m_target = Range();
+    m_versionMinor = 0;
+    m_headers.clear();
+}
+
+QByteArray HttpRequestParser::path() const
+{
+    auto range = m_target;
+    const auto kQuery = (const char *)memchr(m_buffer + range.begin, '?', range.length);
+    if (kQuery)
+        range.length = kQuery - (m_buffer + range.begin);
+
+    return view(range);
+}
+
+QByteArray HttpRequestParser::header(const char *name) const
+{
+    const auto kLength = (int)strlen(name);
+    for (const auto &header : m_headers)
+    {
+        if ((header.name.length == kLength) && equalsNoCase(m_buffer + header.name.begin, name, kLength))
+            return view(header.value);
+    }
+    return QByteArray();
+}
+
+bool HttpRequestParser::isKeepAlive() const
+{
+    const auto kConnection = header("Connection");
+    if (m_versionMinor >= 1)
+        return !((kConnection.size() == 5) && equalsNoCase(kConnection.constData(), "close", 5));
+
+    return (kConnection.size() == 10) && equalsNoCase(kConnection.constData(), "keep-alive", 10);
+}
+
+// METHOD SP target SP HTTP/1.x
+bool HttpRequestParser::parseRequestLine(const char *line, int begin, int end)
+{
+    auto pos = begin;
+    while ((pos < end) && (line[pos] != ' '))
+        ++pos;
+    m_method.begin = begin;
+    m_method.length = pos - begin;
+    if ((m_method.length == 0) || (pos == end))
+        return false;
+
+    m_target.begin = ++pos;
+    while ((pos < end) && (line[pos] != ' '))
+        ++pos;
+    m_target.length = pos - m_target.begin;
+    if ((m_target.length == 0) || (pos == end))
+        return false;
+
+    ++pos;
+    if (((end - pos) != 8) || (memcmp(line + pos, "HTTP/1.", 7) != 0) || (line[pos + 7] < '0') || (line[pos + 7] > '9'))
+        return false;
+
+    m_versionMinor = line[pos + 7] - '0';
+    return true;
+}
+
+// name: value
+bool HttpRequestParser::parseHeader(const char *line, int begin, int end)
+{
+    const auto kColon = (const char *)memchr(line + begin, ':', end - begin);
+    if (!kColon || (kColon == (line + begin)))
+        return false;
+
+    Header header;
+    header.name.begin = begin;
+    header.name.length = kColon - (line + begin);
+
+    auto valueBegin = header.name.begin + header.name.length + 1;
+    auto valueEnd = end;
+    while ((valueBegin < valueEnd) && isSpace(line[valueBegin]))
+        ++valueBegin;
+    while ((valueEnd > valueBegin) && isSpace(line[valueEnd - 1]))
+        --valueEnd;
+
+    header.value.begin = valueBegin;
+    header.value.length = valueEnd - valueBegin;
+    m_headers.append(header);
+    return true;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <QByteArray>
+#include <QVector>
+
+//! Incremental HTTP/1.1 request parser
+/*!
+ * Feed it the connection's receive buffer as often as data arrives; it resumes at the first line it hasn't seen yet.
+ * Nothing is copied: once Complete, the accessors return views into that buffer, valid until the caller drops
+ * requestLength() bytes from its front and reset()s the parser for the next (keep-alive / pipelined) request.
+ * Request bodies are skipped, we don't take any.
+ */
+class HttpRequestParser
+{
+public:
+    enum State
+    {
+        Incomplete = 0,
+        Complete,
+        Error
+    };
+
+    static const int MAX_HEAD_SIZE = 8192;  // request line and headers
+    static const int MAX_BODY_SIZE = 8192;
+
+    State parse(const QByteArray &buffer);
+    void reset();
+
+    QByteArray method() const {return view(m_method);}
+    QByteArray target() const {return view(m_target);}
+    QByteArray path() const;                            // target without the query
+    QByteArray header(const char *name) const;          // case insensitive, empty if missing
+    bool isKeepAlive() const;
+    int requestLength() const {return m_headLength + m_bodyLength;}
+
+private:
+    struct Range
+    {
+        int begin = 0;
+        int length = 0;
+    };
+    struct Header
+    {
+        Range name;
+        Range value;
+    };
+
+    QByteArray view(const Range &range) const {return QByteArray::fromRawData(m_buffer + range.begin, range.length);}
+    bool parseRequestLine(const char *line, int begin, int end);
+    bool parseHeader(const char *line, int begin, int end);
+
+    const char *m_buffer = nullptr;
+    int m_pos = 0;              // start of the first line not parsed yet
+    int m_headLength = 0;       // > 0 once the empty line was seen
+    int m_bodyLength = 0;
+    Range m_method;
+    Range m_target;
+    int m_versionMinor = 0;
+    QVector<Header> m_headers;
+};
@@ -3,6 +3,7 @@
 #include "ts_helpers_qt.h"
 #include "ts3_functions.h"  //currently only used in a debug output
 #include "plugin.h"  //currently only used in a debug output
+#include "voice_chain.h"
 
 Agmu::Agmu(QObject *parent)
 {
@@ -10,25 +11,17 @@ Agmu::Agmu(QObject *parent)
     this->setObjectName(QStringLiteral("Agmu"));
     m_isPrintEnabled = false;
     talkers = Talkers::instance();
-    m_TalkersDSPs = new QMap<uint64,QMap<anyID,DspVolumeAGMU*>* >;
+    vols = new Volumes(this,Volumes::Volume_Type::AGMU);
     m_PeakCache = new QHash<QString,short>;
 }
 
-bool Agmu::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+void Agmu::PopulateVoiceChain(VoiceChainBuilder &builder) const
 {
-//    if (!(isForceProcessing || isRunning()))
-//        return false;
-
-    if (!(m_TalkersDSPs->contains(serverConnectionHandlerID)))
-        return false;
-
-    auto sDspVolumeAGMUs = m_TalkersDSPs->value(serverConnectionHandlerID);
-    if (!(sDspVolumeAGMUs->contains(clientID)))
-        return false;
-
-    auto dspObj = sDspVolumeAGMUs->value(clientID);
-    dspObj->process(samples,sampleCount,channels);
-    return true;
+    // dsp objects only exist while running or force processing, no running check here
+    vols->GetVolumes().forEach([&builder](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspVolume*> &vol)
+    {
+        builder.node(serverConnectionHandlerID,clientID).agmu = vol.staticCast<DspVolumeAGMU*>();
+    });
 }
 
 bool Agmu::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe)
@@ -42,28 +35,13 @@ bool Agmu::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, boo
 
     if (status == STATUS_TALKING)
     {   // Robust against multiple STATUS_TALKING in a row to be able to use it when the user changes settings
-        DspVolumeAGMU* dspObj;
-        auto isNewDspObj = true;
-        if (!(m_TalkersDSPs->contains(serverConnectionHandlerID)))
-        {
-            dspObj = new DspVolumeAGMU(this);
-            auto sDspVolumeAGMUs = new QMap<anyID,DspVolumeAGMU*>;
-            sDspVolumeAGMUs->insert(clientID,dspObj);
-            m_TalkersDSPs->insert(serverConnectionHandlerID,sDspVolumeAGMUs);
-        }
-        else
+        auto dspObj = qobject_cast<DspVolumeAGMU*>(vols->GetVolume(serverConnectionHandlerID,clientID));
+        auto isNewDspObj = (dspObj == nullptr);
+        if (isNewDspObj)
         {
-            auto sDspVolumeAGMUs = m_TalkersDSPs->value(serverConnectionHandlerID);
-            if (sDspVolumeAGMUs->contains(clientID))
-            {
-                dspObj = sDspVolumeAGMUs->value(clientID);
-                isNewDspObj = false;
-            }
-            else
-            {
-                dspObj = new DspVolumeAGMU(this);
-                sDspVolumeAGMUs->insert(clientID,dspObj);
-            }
+            dspObj = qobject_cast<DspVolumeAGMU*>(vols->AddVolume(serverConnectionHandlerID,clientID));
+            if (!dspObj)
+                return false;
         }
 
         if (!isNewDspObj)
@@ -98,14 +76,10 @@ bool Agmu::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, boo
     else if (status == STATUS_NOT_TALKING)
     {
         // Removing does not need to be robust against multiple STATUS_NOT_TALKING in a row, since that doesn't happen on user setting change
-        if (!m_TalkersDSPs->contains(serverConnectionHandlerID))
+        auto dspObj = qobject_cast<DspVolumeAGMU*>(vols->GetVolume(serverConnectionHandlerID,clientID));
+        if (!dspObj)
             return false;   // return silent bec. of ChannelMuter implementation
 
-        auto sDspVolumeAGMUs = m_TalkersDSPs->value(serverConnectionHandlerID);
-        if (!(sDspVolumeAGMUs->contains(clientID)))
-            return false;
-
-        auto dspObj = sDspVolumeAGMUs->value(clientID);
         QString clientUID;
         unsigned int error;
         if ((error = TSHelpers::GetClientUID(serverConnectionHandlerID,clientID, clientUID)) != ERROR_ok)
@@ -114,9 +88,7 @@ bool Agmu::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, boo
             return false;
         }
         m_PeakCache->insert(clientUID,dspObj->GetPeak());
-        dspObj->blockSignals(true);
-        dspObj->deleteLater();
-        sDspVolumeAGMUs->remove(clientID);
+        vols->RemoveVolume(serverConnectionHandlerID,clientID);
     }
     return false;
 }
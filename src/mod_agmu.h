@@ -1,6 +1,8 @@
 #pragma once
 
 #include "module.h"
+#include "voice_chain.h"
+#include "volumes.h"
 #include "dsp_volume_agmu.h"
 #include "talkers.h"
 
@@ -12,7 +14,7 @@ public:
     explicit Agmu(QObject *parent = 0);
     
     // events forwarded from plugin.cpp
-    bool onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels);
+    void PopulateVoiceChain(VoiceChainBuilder &builder) const;
     bool onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe);
     void setNextTalkStatusChangeForceProcessing(bool val);  // well, yeah...don't wanna change the interface right now
 
@@ -25,7 +27,7 @@ private:
 
     Talkers* talkers;
 
-    QMap<uint64,QMap<anyID,DspVolumeAGMU*>* >* m_TalkersDSPs;   //QMap is reportedly faster on small (<10)
+    Volumes* vols;
     QHash<QString,short>* m_PeakCache;
     bool m_isForceProcessing = false;
 };
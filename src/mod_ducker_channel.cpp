@@ -107,6 +107,7 @@ void Ducker_Channel::setDuckingReverse(bool val)
         return;
 
     m_isTargetOtherTabs = val;
+    VoiceChain::instance()->Invalidate();
     if (isRunning())  //since everything needs to be re-evaluated might as well toggle off/on
     {
         onRunningStateChanged(false); //setEnabled would trigger signal
@@ -143,6 +144,7 @@ void Ducker_Channel::setHomeId(uint64 serverConnectionHandlerID)
 
     uint64 oldHomeId = m_homeId;
     m_homeId = serverConnectionHandlerID;
+    VoiceChain::instance()->Invalidate();
     if (m_homeId == 0)
         return;
 
@@ -281,29 +283,24 @@ bool Ducker_Channel::onTalkStatusChanged(uint64 serverConnectionHandlerID, int s
     return false;
 }
 
-//! Routes the arguments of the event to the corresponding volume object
+//! Hands the volumes of the targeted tabs to the voice chain
 /*!
- * \brief Ducker_Channel::onEditPlaybackVoiceDataEvent pre-processing voice event
- * \param serverConnectionHandlerID the connection id of the server
- * \param clientID the client-side runtime-id of the sender
- * \param samples the sample array to manipulate
- * \param sampleCount amount of samples in the array
- * \param channels amount of channels
+ * \brief Ducker_Channel::PopulateVoiceChain gui thread; the home tab selection is resolved here instead of per audio block
+ * \param builder the chain under construction
  */
-void Ducker_Channel::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+void Ducker_Channel::PopulateVoiceChain(VoiceChainBuilder &builder) const
 {
     if (!(isRunning()))
         return;
 
-    if (((!m_isTargetOtherTabs) && (serverConnectionHandlerID != m_homeId)) || ((m_isTargetOtherTabs) && (serverConnectionHandlerID == m_homeId)))
-        return;
-
-    auto vol = qobject_cast<DspVolumeDucker*>(vols->GetVolume(serverConnectionHandlerID,clientID));
-    if (vol == 0)
-        return;
+    vols->GetVolumes().forEach([this, &builder](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspVolume*> &vol)
+    {
+        if (((!m_isTargetOtherTabs) && (serverConnectionHandlerID != m_homeId)) || ((m_isTargetOtherTabs) && (serverConnectionHandlerID == m_homeId)))
+            return;
 
-    //sampleCount = sampleCount * channels;
-    vol->process(samples,sampleCount,channels);
+        if (qobject_cast<DspVolumeDucker*>(vol.value))
+            builder.node(serverConnectionHandlerID,clientID).duckerChannel = vol.staticCast<DspVolumeDucker*>();
+    });
 }
 
 //! Create and add a Volume object to the ServerChannelVolumes map
@@ -3,6 +3,7 @@
 #include <QObject>
 #include "teamspeak/public_definitions.h"
 #include "module.h"
+#include "voice_chain.h"
 #include "volumes.h"
 #include "dsp_volume_ducker.h"
 #include "talkers.h"
@@ -36,7 +37,7 @@ public:
 
     // events forwarded from plugin.cpp
     void onClientMoveEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID myID);
-    void onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels);
+    void PopulateVoiceChain(VoiceChainBuilder &builder) const;
 
     void setHomeId(uint64 serverConnectionHandlerID);
     uint64 homeId() {return m_homeId;}
@@ -209,27 +209,21 @@ void Ducker_Global::onClientMoveEvent(uint64 serverConnectionHandlerID, anyID cl
     }
 }
 
-//! Routes the arguments of the event to the corresponding volume object
+//! Hands the music bot volumes to the voice chain
 /*!
- * \brief Ducker_Global::onEditPlaybackVoiceDataEvent pre-processing voice event
- * \param serverConnectionHandlerID the connection id of the server
- * \param clientID the client-side runtime-id of the sender
- * \param samples the sample array to manipulate
- * \param sampleCount amount of samples in the array
- * \param channels currently always 1 on TS3; unused
- * \return true, if the ducker has processed / the client is a music bot
+ * \brief Ducker_Global::PopulateVoiceChain gui thread; called on every rebuild of the chain
+ * \param builder the chain under construction
  */
-bool Ducker_Global::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+void Ducker_Global::PopulateVoiceChain(VoiceChainBuilder &builder) const
 {
     if (!(isRunning()))
-        return false;
-
-    auto vol = qobject_cast<DspVolumeDucker*>(vols->GetVolume(serverConnectionHandlerID,clientID));
-    if (vol == 0)
-        return false;
+        return;
 
-    vol->process(samples,sampleCount,channels);
-    return (vol->isProcessing() && vol->getGainAdjustment());
+    vols->GetVolumes().forEach([&builder](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspVolume*> &vol)
+    {
+        if (qobject_cast<DspVolumeDucker*>(vol.value))
+            builder.node(serverConnectionHandlerID,clientID).duckerGlobal = vol.staticCast<DspVolumeDucker*>();
+    });
 }
 
 void Ducker_Global::onRunningStateChanged(bool value)
@@ -301,27 +301,20 @@ void ChannelMuter::onContextMenuEvent(uint64 serverConnectionHandlerID, PluginMe
         toggleClientWhitelisted(serverConnectionHandlerID,(anyID)selectedItemID);
 }
 
-//! Routes the arguments of the event to the corresponding volume object
+//! Hands the volumes of the muter to the voice chain
 /*!
- * \brief ChannelMuter::onEditPlaybackVoiceDataEvent pre-processing voice event
- * \param serverConnectionHandlerID the connection id of the server
- * \param clientID the client-side runtime-id of the sender
- * \param samples the sample array to manipulate
- * \param sampleCount amount of samples in the array
- * \param channels amount of channels
- * \return true if the stream is muted, so succeeding modules need not bother
+ * \brief ChannelMuter::PopulateVoiceChain gui thread; called on every rebuild of the chain
+ * \param builder the chain under construction
  */
-bool ChannelMuter::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+void ChannelMuter::PopulateVoiceChain(VoiceChainBuilder &builder) const
 {
     if (!(isRunning()))
-        return false;
-
-    auto vol = vols->GetVolume(serverConnectionHandlerID,clientID);
-    if (!vol)
-        return false;
+        return;
 
-    vol->process(samples, sampleCount, channels);
-    return vol->isMuted();
+    vols->GetVolumes().forEach([&builder](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspVolume*> &vol)
+    {
+        builder.node(serverConnectionHandlerID,clientID).muter = vol;
+    });
 }
 
 int ChannelMuter::ParseCommand(uint64 serverConnectionHandlerID, QString cmd, QStringList args)
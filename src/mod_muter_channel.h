@@ -3,6 +3,7 @@
 #include <QObject>
 #include "teamspeak/public_definitions.h"
 #include "module.h"
+#include "voice_chain.h"
 #include "volumes.h"
 //#include "simple_volume.h"
 #include "ts_infodata_qt.h"
@@ -25,7 +26,7 @@ public:
 
     // events forwarded from plugin.cpp
     void onClientMoveEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID myID);
-    bool onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels);
+    void PopulateVoiceChain(VoiceChainBuilder &builder) const;
 
     bool onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe);
 
@@ -2,6 +2,7 @@
 
 #include "ts3_functions.h"
 #include "plugin.h"
+#include "telemetry.h"
 
 const QList<float> SPREAD = QList<float>() << 0 << -0.5f << 0.5f << -1.0f << 1.0f; //<< -0.25f << 0.25f << -0.75f << 0.75f;
 
@@ -38,6 +39,11 @@ bool PositionSpread::isExpertModeEnabled() const
     return m_ExpertModeEnabled;
 }
 
+bool PositionSpread::isSurroundEnabled() const
+{
+    return m_isSurroundEnabled;
+}
+
 TALKERS_REGION PositionSpread::getRegionHomeTab() const
 {
     return m_RegionHomeTab;
@@ -99,6 +105,17 @@ void PositionSpread::setExpertModeEnabled(bool value)
     emit expertModeEnabledSet(value);
 }
 
+//! Spread across all speakers of a surround layout instead of the front pair
+void PositionSpread::setSurroundEnabled(bool value)
+{
+    if (m_isSurroundEnabled == value)
+        return;
+    m_isSurroundEnabled = value;
+
+    Log(QString("setSurroundEnabled: %1").arg((m_isSurroundEnabled)?"true":"false"));
+    emit surroundEnabledSet(value);
+}
+
 void PositionSpread::setRegionHomeTab(int talkersRegion)
 {
     if (m_RegionHomeTab == (TALKERS_REGION)talkersRegion)
@@ -156,62 +173,33 @@ void PositionSpread::onEditPostProcessVoiceDataEvent(uint64 serverConnectionHand
         return;
 
     auto panner = sPanners->value(clientID);
+    const auto kPanBefore = panner->getPanCurrent();
 
-    QMap<unsigned int,int> speaker2Channel;
-    for(int i=0; i < channels; ++i)
-    {
-        if (*channelFillMask & (1 << i))
-            speaker2Channel.insert(channelSpeakerArray[i],i);
-    }
+    if (m_speakerRouting.update(channels, channelSpeakerArray, *channelFillMask) && (m_speakerRouting.route().mode == SpeakerRoute::NoFront) && !m_speakerRouting.route().isSurround)
+        Log("Could not find Front Speakers.",serverConnectionHandlerID, LogLevel_ERROR);
 
-    /*if (speaker2Channel.size() > 2)
-    {   // Todo: For now.
-        //Log("speaker2Channel.size() > 2: return");
-        //return;
-    }*/
-
-    if (speaker2Channel.contains(SPEAKER_HEADPHONES_LEFT) && speaker2Channel.contains(SPEAKER_HEADPHONES_RIGHT))
-        panner->process(samples,sampleCount,channels,speaker2Channel.value(SPEAKER_HEADPHONES_LEFT),speaker2Channel.value(SPEAKER_HEADPHONES_RIGHT));
-    else if (speaker2Channel.contains(SPEAKER_FRONT_LEFT))
-        panner->process(samples,sampleCount,channels,speaker2Channel.value(SPEAKER_FRONT_LEFT),speaker2Channel.value(SPEAKER_FRONT_RIGHT));
-    else if (speaker2Channel.contains(SPEAKER_FRONT_CENTER))    // TODO: This is effectively never called in practice
+    const auto& route = m_speakerRouting.route();
+    if (route.isSurround && m_isSurroundEnabled)
+        panner->processSurround(samples,sampleCount,channels,m_speakerRouting.vbap(),channelFillMask);
+    else if (route.mode == SpeakerRoute::Stereo)
+        panner->process(samples,sampleCount,channels,route.left,route.right);
+    else if (route.mode == SpeakerRoute::CenterToFront)    // TODO: This is effectively never called in practice
     {
         if (!((panner->getPanDesired() == panner->getPanCurrent()) && (panner->getPanDesired() == 0.0f))) // if middle is where it is and is to be, leave it at center, otherwise...
         {
-            // Search for the non-used front left & right
             // Populate Front Left and Right & Fill Center with 0s
-            int leftChannelNr = -1;
-            int rightChannelNr = -1;
-            for(int i=0; i<channels; ++i)
-            {
-                if (channelSpeakerArray[i] == SPEAKER_FRONT_LEFT)
-                {
-                    leftChannelNr = i;
-                    if (rightChannelNr != -1)
-                        break;
-                }
-                else if (channelSpeakerArray[i] == SPEAKER_FRONT_RIGHT)
-                {
-                    rightChannelNr = i;
-                    if (leftChannelNr != -1)
-                        break;
-                }
-            }
-            if ((leftChannelNr == -1) || (rightChannelNr == -1))
-            {
-                Log("Could not find Front Speakers.",serverConnectionHandlerID, LogLevel_ERROR);
-                return;
-            }
-
             for(int i=0; i<sampleCount; ++i){
-                short monosample = samples[speaker2Channel.value(SPEAKER_FRONT_CENTER) +(i*channels)];
-                samples[leftChannelNr + (i*channels)] = monosample; // ToDo: + or - 3dB would be appropriate?
-                samples[rightChannelNr + (i*channels)] = monosample;
-                samples[speaker2Channel.value(SPEAKER_FRONT_CENTER) +(i*channels)] = 0.0f;
+                short monosample = samples[route.center +(i*channels)];
+                samples[route.left + (i*channels)] = monosample; // ToDo: + or - 3dB would be appropriate?
+                samples[route.right + (i*channels)] = monosample;
+                samples[route.center +(i*channels)] = 0;
             }
-            panner->process(samples,sampleCount,channels,leftChannelNr, rightChannelNr);
+            panner->process(samples,sampleCount,channels,route.left,route.right);
         }
     }
+
+    if (panner->getPanCurrent() != kPanBefore)
+        Telemetry::instance()->Push(Telemetry::PostProcessProducer, TelemetryType::Pan, serverConnectionHandlerID, clientID, panner->getPanCurrent());
 }
 
 bool PositionSpread::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe)
@@ -424,5 +412,10 @@ int PositionSpread::ParseCommand(uint64 serverConnectionHandlerID, QString cmd,
         setBlocked((args.at(1).compare(QLatin1String("true"),Qt::CaseInsensitive) == 0));
         return 0;
     }
+    else if (cmd.compare(QLatin1String("SET_SURROUND"),Qt::CaseInsensitive) == 0)
+    {
+        setSurroundEnabled((args.at(1).compare(QLatin1String("true"),Qt::CaseInsensitive) == 0));
+        return 0;
+    }
     return 1;
 }
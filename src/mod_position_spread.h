@@ -6,6 +6,7 @@
 #include "module.h"
 #include "talkers.h"
 #include "simplepanner.h"
+#include "speaker_routing.h"
 
 enum TALKERS_REGION
 {
@@ -28,6 +29,10 @@ class PositionSpread : public Module, public TalkInterface
                READ isExpertModeEnabled
                WRITE setExpertModeEnabled
                NOTIFY expertModeEnabledSet)
+    Q_PROPERTY(bool surroundEnabled
+               READ isSurroundEnabled
+               WRITE setSurroundEnabled
+               NOTIFY surroundEnabledSet)
     Q_PROPERTY(TALKERS_REGION regionHomeTab
                READ getRegionHomeTab
                WRITE setRegionHomeTab
@@ -48,6 +53,7 @@ public:
     //property getters
     float getSpreadWidth() const;
     bool isExpertModeEnabled() const;
+    bool isSurroundEnabled() const;
     TALKERS_REGION getRegionHomeTab() const;
     TALKERS_REGION getRegionWhisper() const;
     TALKERS_REGION getRegionOther() const;
@@ -62,6 +68,7 @@ public:
 signals:
     void spreadWidthSet(float);
     void expertModeEnabledSet(bool);
+    void surroundEnabledSet(bool);
     void regionHomeTabSet(TALKERS_REGION);
     void regionWhisperSet(TALKERS_REGION);
     void regionOtherSet(TALKERS_REGION);
@@ -69,6 +76,7 @@ signals:
 public slots:
     void setSpreadWidth(float value);
     void setExpertModeEnabled(bool value);
+    void setSurroundEnabled(bool value);
     void setRegionHomeTab(int talkersRegion);
     void setRegionWhisper(int talkersRegion);
     void setRegionOther(int talkersRegion);
@@ -81,7 +89,10 @@ private:
     QMap<TALKERS_REGION,QList< QPair<uint64,anyID> >* >* TalkerSequences;
     QMap<uint64,QMap<anyID,SimplePanner*>* >* TalkersPanners;
 
+    SpeakerRouting m_speakerRouting;   // post process callback only
+
     bool m_ExpertModeEnabled = false;
+    bool m_isSurroundEnabled = false;  // opt-in (config key only), there is no settings control yet
     uint64 m_homeId = 0;
     TALKERS_REGION m_RegionHomeTab = TALKERS_REGION_CENTER;
     TALKERS_REGION m_RegionWhisper = TALKERS_REGION_CENTER;
@@ -6,6 +6,7 @@
 #include <QTextStream>
 
 #include "ts_logging_qt.h"
+#include "voice_chain.h"
 
 //Module::Module(QObject *parent) :
 //    QObject(parent)
@@ -36,7 +37,10 @@ void Module::setEnabled(bool value)
         m_enabled = value;
         onEnabledStateChanged(value);
         if (kRunningOld != isRunning())
+        {
             onRunningStateChanged(isRunning());
+            VoiceChain::instance()->Invalidate();
+        }
 
         emit enabledSet(m_enabled);
     }
@@ -50,7 +54,10 @@ void Module::setBlocked(bool value)
         m_blocked = value;
         onBlockedStateChanged(value);
         if (kRunningOld != isRunning())
+        {
             onRunningStateChanged(isRunning());
+            VoiceChain::instance()->Invalidate();
+        }
 
         emit blockedSet(value);
     }
@@ -1,44 +1,136 @@
 #include "pipeserver.h"
 
 #include <QtNetwork>
-#include <QSignalMapper>
+#include <QtEndian>
 #include "ts_logging_qt.h"
 
 PipeServer::PipeServer(QObject *parent, QString name) :
     QObject(parent)
 {
-    m_SignalMapper = new QSignalMapper(this);
-
     m_PipeServer = new QLocalServer(this);
     if (!m_PipeServer->listen(name)) {   //QString(ts3plugin_author()) + QString(ts3plugin_name()))
         TSLogging::Error(QString("Unable to start the server: %1.").arg(m_PipeServer->errorString()));
         return;
     }
     connect(m_PipeServer, &QLocalServer::newConnection, this, &PipeServer::onNewConnection);
-    connect(m_SignalMapper, SIGNAL(mapped(QString)), this, SLOT(onClientDisconnected(QString)));
 }
 
-void PipeServer::Send(QString message)
+void PipeServer::Send(const QByteArray &message, const QString &key)
+{
+    Send(PositionalAudio, message, key);
+}
+
+//! Frames the message once, all subscribed clients share the bytes
+void PipeServer::Send(int topic, const QByteArray &message, const QString &key)
 {
-    if (m_Clients.isEmpty())
+    if (m_subscriberCounts[topic] == 0)
         return;
 
-    foreach (QLocalSocket* clientConnection, m_Clients)
-        clientConnection->write(message.toLocal8Bit().constData());
+    QByteArray frame;
+    frame.resize(5 + message.size());
+    qToLittleEndian<quint32>(1 + message.size(), (uchar*)frame.data());
+    frame[4] = (char)topic;
+    memcpy(frame.data() + 5, message.constData(), message.size());
+
+    const FrameKey kKey(topic, key);
+    const quint32 kMask = 1 << topic;
+    QList<QLocalSocket*> overflowed;
+    for (auto it = m_Clients.begin(); it != m_Clients.end(); ++it)
+    {
+        if (!(it.value().topics & kMask))
+            continue;
+
+        auto &queue = it.value().queue;
+        queue.send(it.key(), kKey, frame);
+        if (queue.size() > MAX_QUEUED_FRAMES)
+            overflowed.append(it.key());
+    }
+
+    for (auto socket : overflowed)
+    {
+        TSLogging::Log(QString("PipeServer: More than %1 frames queued, disconnecting client.").arg(MAX_QUEUED_FRAMES), LogLevel_WARNING);
+        socket->abort();
+    }
+}
+
+void PipeServer::Pump(QLocalSocket *socket, Client &client)
+{
+    client.queue.pump(socket);
+    if (client.queue.isEmpty())
+    {
+        const auto kCoalesced = client.queue.takeCoalesced();
+        if (kCoalesced > 0)
+            TSLogging::Log(QString("PipeServer: Client caught up, coalesced %1 messages.").arg(kCoalesced), LogLevel_INFO);
+    }
+}
+
+void PipeServer::setTopics(Client &client, quint32 topics)
+{
+    for (int topic = 0; topic < TOPIC_COUNT; ++topic)
+    {
+        const quint32 kMask = 1 << topic;
+        if ((client.topics & kMask) != (topics & kMask))
+            m_subscriberCounts[topic] += (topics & kMask) ? 1 : -1;
+    }
+    client.topics = topics;
 }
 
 void PipeServer::onNewConnection()
 {
     auto clientConnection = m_PipeServer->nextPendingConnection();
-    auto desc = clientConnection->socketDescriptor();
-    auto descStr = QString("%1").arg(desc);
-    m_Clients.insert(descStr, clientConnection);
-    connect(clientConnection, SIGNAL(disconnected()), m_SignalMapper, SLOT(map()));
-    m_SignalMapper->setMapping(clientConnection, descStr);
+    auto &client = m_Clients[clientConnection];
+    client.topics = 0;
+    setTopics(client, 1 << PositionalAudio);
+    connect(clientConnection, &QLocalSocket::disconnected, this, &PipeServer::onClientDisconnected);
+    connect(clientConnection, &QLocalSocket::readyRead, this, &PipeServer::onReadyRead);
+    connect(clientConnection, &QLocalSocket::bytesWritten, this, &PipeServer::onBytesWritten);
 }
 
-void PipeServer::onClientDisconnected(QString descStr)
+void PipeServer::onClientDisconnected()
 {
-    auto clientConnection = m_Clients.take(descStr);
+    auto clientConnection = qobject_cast<QLocalSocket*>(sender());
+    auto it = m_Clients.find(clientConnection);
+    if (it == m_Clients.end())
+        return;
+
+    setTopics(it.value(), 0);
+    m_Clients.erase(it);
     clientConnection->deleteLater();
 }
+
+void PipeServer::onReadyRead()
+{
+    auto clientConnection = qobject_cast<QLocalSocket*>(sender());
+    auto it = m_Clients.find(clientConnection);
+    if (it == m_Clients.end())
+        return;
+
+    auto &client = it.value();
+    client.in += clientConnection->readAll();
+    while (client.in.size() >= 5)
+    {
+        const auto kLength = qFromLittleEndian<quint32>((const uchar*)client.in.constData());
+        if ((kLength == 0) || (kLength > MAX_FRAME_SIZE))
+        {
+            TSLogging::Log("PipeServer: Bad frame, disconnecting client.", LogLevel_INFO);
+            clientConnection->abort();
+            return;
+        }
+        if ((quint32)client.in.size() < 4 + kLength)
+            return;
+
+        const auto kType = (quint8)client.in.at(4);
+        if ((kType == SUBSCRIBE) && (kLength == 5))
+            setTopics(client, qFromLittleEndian<quint32>((const uchar*)client.in.constData() + 5) & ((1 << TOPIC_COUNT) - 1));
+
+        client.in.remove(0, 4 + kLength);
+    }
+}
+
+void PipeServer::onBytesWritten()
+{
+    auto clientConnection = qobject_cast<QLocalSocket*>(sender());
+    auto it = m_Clients.find(clientConnection);
+    if (it != m_Clients.end())
+        Pump(clientConnection, it.value());
+}
@@ -2,28 +2,67 @@
 
 #include <QObject>
 #include <QLocalSocket>
+#include <QHash>
+#include <QPair>
+#include "coalescing_queue.h"
 
 class QLocalServer;
-class QSignalMapper;
 
+//! Local socket server for tools
+/*!
+ * Messages in both directions are framed: a little endian quint32 length of what follows, a type byte, the payload.
+ * Server to client, the type is the topic and the payload UTF-8 JSON, the same as the SSE streams carry.
+ * Client to server, SUBSCRIBE with a little endian quint32 bitmask of (1 << topic) selects the topics it gets;
+ * until it sends one, a client gets PositionalAudio only.
+ * A client reading slowly may skip intermediate messages, never the latest one per player, talker or meter.
+ */
 class PipeServer : public QObject
 {
     Q_OBJECT
 
 public:
+    enum Topic
+    {
+        PositionalAudio = 0,
+        TalkStatus,
+        Meters,
+        TOPIC_COUNT
+    };
+    static const quint8 SUBSCRIBE = 0x80;
+
     explicit PipeServer(QObject *parent = 0, QString name = "ThorweCtPipeServer");
 
+    bool hasSubscribers(int topic) const {return m_subscriberCounts[topic] > 0;}
+
 signals:
 
 public slots:
-    void Send(QString message);
+    void Send(const QByteArray &message, const QString &key);   // positional audio
+    void Send(int topic, const QByteArray &message, const QString &key);
 
 private slots:
     void onNewConnection();
-    void onClientDisconnected(QString descStr);
+    void onClientDisconnected();
+    void onReadyRead();
+    void onBytesWritten();
 
 private:
+    typedef QPair<int, QString> FrameKey;   // topic, what the message is about (a player, a talker, a meter)
+
+    struct Client
+    {
+        quint32 topics = 1 << PositionalAudio;
+        QByteArray in;
+        CoalescingQueue<FrameKey> queue;
+    };
+
+    static const int MAX_QUEUED_FRAMES = 1024;          // per client, beyond it's disconnected
+    static const int MAX_FRAME_SIZE = 1024;             // client to server
+
+    void Pump(QLocalSocket* socket, Client &client);
+    void setTopics(Client &client, quint32 topics);
+
     QLocalServer *m_PipeServer;
-    QMap<QString, QLocalSocket*> m_Clients;
-    QSignalMapper *m_SignalMapper;
+    QHash<QLocalSocket*, Client> m_Clients;
+    int m_subscriberCounts[TOPIC_COUNT] = {};
 };
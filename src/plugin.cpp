@@ -41,6 +41,8 @@
 #include "mod_muter_channel.h"
 #include "mod_position_spread.h"
 #include "mod_agmu.h"
+#include "voice_chain.h"
+#include "telemetry.h"
 
 #include "settings_duck.h"
 #include "settings_position_spread.h"
@@ -68,6 +70,7 @@ struct TS3Functions ts3Functions;
 Translator* loca = Translator::instance();
 PluginQt* pluginQt = PluginQt::instance();
 Talkers* talkers = Talkers::instance();
+VoiceChain* voiceChain = VoiceChain::instance();
 TSContextMenu* contextMenu = TSContextMenu::instance();
 TSInfoData* infoData = TSInfoData::instance();
 
@@ -210,6 +213,14 @@ int ts3plugin_init() {
 
     channel_Muter.setEnabled(true);
 
+    Telemetry::instance()->Start();
+
+#ifdef USE_RADIO
+    voiceChain->Init(&channel_Muter, &radio, &agmu, &ducker_G, &ducker_C);
+#else
+    voiceChain->Init(&channel_Muter, nullptr, &agmu, &ducker_G, &ducker_C);
+#endif
+
     // Support enabling the plugin while already connected
     uint64* servers;
     if(ts3Functions.getServerConnectionHandlerList(&servers) == ERROR_ok)
@@ -298,6 +309,9 @@ void ts3plugin_shutdown() {
 //        positionalAudio.setBlocked(true);
 //    #endif
 
+    Telemetry::instance()->Stop();
+    pluginQt->m_StateLink->close();     // overlays see empty tables
+
 	/* Free pluginID if we registered it */
 	if(pluginID) {
 		free(pluginID);
@@ -911,7 +925,10 @@ void ts3plugin_onTalkStatusChangeEvent(uint64 serverConnectionHandlerID, int sta
     bool isMe = talkers->onTalkStatusChangeEvent(serverConnectionHandlerID,status,isReceivedWhisper,clientID);
 
     if (channel_Muter.onTalkStatusChanged(serverConnectionHandlerID,status,isReceivedWhisper,clientID,isMe))
+    {
+        voiceChain->RebuildIfDirty();
         return; //Client is muted;
+    }
 
 #ifdef USE_RADIO
     const auto isRadioProcessing = radio.onTalkStatusChanged(serverConnectionHandlerID,status,isReceivedWhisper,clientID,isMe);
@@ -925,6 +942,8 @@ void ts3plugin_onTalkStatusChangeEvent(uint64 serverConnectionHandlerID, int sta
         ducker_C.onTalkStatusChanged(serverConnectionHandlerID,status,isReceivedWhisper,clientID,isMe);
         positionSpread.onTalkStatusChanged(serverConnectionHandlerID,status,isReceivedWhisper,clientID,isMe);
     }
+    // voice data usually follows right away, don't wait for the queued rebuild
+    voiceChain->RebuildIfDirty();
 }
 
 void ts3plugin_onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels)
@@ -932,17 +951,7 @@ void ts3plugin_onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, an
     if (clientID > 32767)
         clientID = 65535 - clientID + 1;
 
-    if (channel_Muter.onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels))
-        return; //Client is muted;
-
-#ifdef USE_RADIO
-    radio.onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels);
-#endif
-
-    agmu.onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels);
-
-    if (!ducker_G.onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels))
-        ducker_C.onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels);
+    voiceChain->onEditPlaybackVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels);
 }
 
 void ts3plugin_onEditPostProcessVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask)
@@ -951,7 +960,10 @@ void ts3plugin_onEditPostProcessVoiceDataEvent(uint64 serverConnectionHandlerID,
         clientID = 65535 - clientID + 1;
 
 #ifdef USE_POSITIONAL_AUDIO
-    if (positionalAudio.isPositioned(clientID))
+    if (positionalAudio.onEditPostProcessVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels,channelSpeakerArray,channelFillMask))
+        return;
+
+    if (positionalAudio.isPositioned(serverConnectionHandlerID,clientID))
         return;
 #endif
     positionSpread.onEditPostProcessVoiceDataEvent(serverConnectionHandlerID,clientID,samples,sampleCount,channels,channelSpeakerArray,channelFillMask);
@@ -1073,6 +1085,18 @@ void ts3plugin_onHotkeyEvent(const char* keyword) {
     ts3plugin_processCommand((uint64)NULL,keyword);
 }
 
+void ts3plugin_onClientDisplayNameChanged(uint64 serverConnectionHandlerID, anyID clientID, const char* displayName, const char* uniqueClientIdentifier)
+{
+    Q_UNUSED(uniqueClientIdentifier);
+#ifdef USE_POSITIONAL_AUDIO
+    positionalAudio.onClientDisplayNameChanged(serverConnectionHandlerID, clientID, displayName);
+#else
+    Q_UNUSED(serverConnectionHandlerID);
+    Q_UNUSED(clientID);
+    Q_UNUSED(displayName);
+#endif
+}
+
 void ts3plugin_onServerGroupListEvent(uint64 serverConnectionHandlerID, uint64 serverGroupID, const char* name, int type, int iconID, int saveDB)
 {
     centralStation->onServerGroupListEvent(serverConnectionHandlerID,serverGroupID,name,type,iconID,saveDB);
@@ -3,9 +3,13 @@
 #include "ts_logging_qt.h"
 #include "ts_helpers_qt.h"
 #include "pipeserver.h"
+#include "talkers.h"
+#include "telemetry.h"
 
 PluginQt* PluginQt::m_Instance = 0;
 
+static_assert((int)TelemetryType::Pan + 1 == STATE_LINK_METER_COUNT, "a meter per TelemetryType");
+
 PluginQt::PluginQt(){}
 
 void PluginQt::Init()
@@ -31,6 +35,7 @@ void PluginQt::Init()
 
 #ifdef USE_WEBSOCKET
     m_WebSocketServer = new ServerThreaded();
+    connect(m_WebSocketServer, &ServerThreaded::clientConnected, this, &PluginQt::onWebSocketClientConnected);
     port = cfg.value("server_port",64734).toUInt(&ok);
     if (!ok)
         TSLogging::Error("Could not read websocket server port from settings");
@@ -43,6 +48,13 @@ void PluginQt::Init()
 
     m_PipeServer = new PipeServer(this, (QString(ts3plugin_author()).simplified().replace(" ","") + QString(ts3plugin_name())));
 
+    m_StateLink = new StateLink(this);
+    if (!m_StateLink->open())
+        TSLogging::Error(m_StateLink->errorString());
+
+    connect(Talkers::instance(), &Talkers::TalkStatusChanged, this, &PluginQt::onTalkStatusChanged, Qt::UniqueConnection);
+    connect(Telemetry::instance(), &Telemetry::Updated, this, &PluginQt::onTelemetryUpdated, Qt::UniqueConnection);
+
     m_isInit = true;
 }
 
@@ -56,14 +68,70 @@ quint16 PluginQt::getSseServerPort() const
     return m_serverPort;
 }
 
-void PluginQt::LocalServerSend(QString val)
+void PluginQt::LocalServerSend(const QByteArray &val, const QString &key)
 {
+    const auto kId = m_PositionalHistory.append(val);
     if (m_isServerEnabled && m_serverPort > 0)
     {
-        m_SseServer->Send(val);
+        m_SseServer->Send(SseServer::PositionalAudio, kId, key, val);
     }
 }
 
+void PluginQt::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe)
+{
+    QByteArray json;
+    json.append("{\"sc\":").append(QByteArray::number(serverConnectionHandlerID))
+        .append(",\"clid\":").append(QByteArray::number(clientID))
+        .append(",\"talking\":").append((status == STATUS_TALKING) ? "true" : "false")
+        .append(",\"whisper\":").append(isReceivedWhisper ? "true" : "false")
+        .append(",\"me\":").append(isMe ? "true" : "false").append("}");
+
+    // the snapshot lists who's talking right now
+    const auto kKey = QString("%1:%2").arg(serverConnectionHandlerID).arg(clientID);
+    if (status == STATUS_TALKING)
+        m_TalkStatusHistory.setState(kKey, QString::fromLatin1(json));
+    else
+        m_TalkStatusHistory.removeState(kKey);
+
+    m_StateLink->setTalkStatus(serverConnectionHandlerID, clientID, (status == STATUS_TALKING), isReceivedWhisper, isMe);
+
+    const auto kId = m_TalkStatusHistory.append(json);
+    if (m_SseServer)
+        m_SseServer->Send(SseServer::TalkStatus, kId, kKey, json);
+
+    m_PipeServer->Send(PipeServer::TalkStatus, json, kKey);
+}
+
+#ifdef USE_WEBSOCKET
+//! New websocket clients get the positional snapshot right away
+void PluginQt::onWebSocketClientConnected(QObject *thread)
+{
+    const auto kSnapshot = m_PositionalHistory.snapshot();
+    for (const auto &event : kSnapshot)
+        QMetaObject::invokeMethod(thread, "sendMessage", Qt::QueuedConnection, Q_ARG(QString, QString::fromUtf8(event)));
+}
+#endif
+
+void PluginQt::onTelemetryUpdated(int type, uint64 serverConnectionHandlerID, anyID clientID, float value)
+{
+    m_StateLink->setMeter(serverConnectionHandlerID, clientID, type, value);
+
+    const auto kIsSse = m_SseServer && m_SseServer->hasSubscribers(SseServer::Meters);
+    if (!kIsSse && !m_PipeServer->hasSubscribers(PipeServer::Meters))
+        return;
+
+    QByteArray json;
+    json.append("{\"sc\":").append(QByteArray::number(serverConnectionHandlerID))
+        .append(",\"clid\":").append(QByteArray::number(clientID))
+        .append(",\"type\":").append(QByteArray::number(type))
+        .append(",\"value\":").append(QByteArray::number(value, 'g', 4)).append("}");
+    const auto kKey = QString("%1:%2:%3").arg(serverConnectionHandlerID).arg(clientID).arg(type);
+    if (kIsSse)
+        m_SseServer->Send(SseServer::Meters, kKey, json);
+
+    m_PipeServer->Send(PipeServer::Meters, json, kKey);
+}
+
 void PluginQt::setSseServerEnabled(bool val)
 {
     if (val == m_isServerEnabled)
@@ -96,6 +164,8 @@ void PluginQt::setSseServerPort(quint16 val)
 void PluginQt::serverStart()
 {
     m_SseServer = new SseServer(this,m_serverPort);
+    m_SseServer->setHistory(SseServer::PositionalAudio, &m_PositionalHistory);
+    m_SseServer->setHistory(SseServer::TalkStatus, &m_TalkStatusHistory);
     TSLogging::Log(QString("SseServer started on %1").arg(m_serverPort));
 }
 
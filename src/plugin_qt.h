@@ -9,6 +9,9 @@
 #endif
 
 #include "pipeserver.h"
+#include "event_history.h"
+#include "state_link.h"
+#include "teamspeak/public_definitions.h"
 
 class PluginQt : public QObject
 {
@@ -63,6 +66,12 @@ public:
 
     PipeServer* m_PipeServer;
 
+    // fed by the producers, replayed by the servers to (re)connecting clients
+    EventHistory m_PositionalHistory;
+    EventHistory m_TalkStatusHistory;
+
+    StateLink* m_StateLink;
+
 signals:
     // Sse-Server
     void sseServerEnabledToggled(bool);
@@ -72,7 +81,14 @@ public slots:
     // Sse-Server
     void setSseServerEnabled(bool val);
     void setSseServerPort(quint16 val);
-    void LocalServerSend(QString val);
+    void LocalServerSend(const QByteArray &val, const QString &key);
+
+private slots:
+    void onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe);
+    void onTelemetryUpdated(int type, uint64 serverConnectionHandlerID, anyID clientID, float value);
+#ifdef USE_WEBSOCKET
+    void onWebSocketClientConnected(QObject *thread);
+#endif
 
 private:
     //singleton
@@ -14,7 +14,13 @@ HEADERS += \
     $$PWD/guildwarstwo.h \
     $$PWD/tsvr_definitions.h \
     $$PWD/tsvr_obj_self.h \
-    $$PWD/tsvr_obj_other.h ##\
+    $$PWD/binaural_renderer.h \
+    $$PWD/mumble_link.h \
+    $$PWD/positional_wire.h \
+    $$PWD/avatar_motion.h \
+    $$PWD/spatial_grid.h \
+    $$PWD/rolloff_curve.h \
+    $$PWD/json_batch.h ##\
     ##$$PWD/minecraft.h
 
 SOURCES += \
@@ -28,7 +34,13 @@ SOURCES += \
     $$PWD/groupbox_positionalaudio_status.cpp \
     $$PWD/guildwarstwo.cpp \
     $$PWD/tsvr_obj_self.cpp \
-    $$PWD/tsvr_obj_other.cpp ##\
+    $$PWD/binaural_renderer.cpp \
+    $$PWD/mumble_link.cpp \
+    $$PWD/positional_wire.cpp \
+    $$PWD/avatar_motion.cpp \
+    $$PWD/spatial_grid.cpp \
+    $$PWD/rolloff_curve.cpp \
+    $$PWD/json_batch.cpp ##\
     ##$$PWD/minecraft.cpp
 
 FORMS += \
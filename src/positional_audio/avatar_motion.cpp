@@ -0,0 +1,100 @@
+#include "avatar_motion.h"
+
+#include <math.h>
+
+const float VELOCITY_SMOOTHING = 0.5f;
+const float INTERVAL_SMOOTHING = 0.25f;
+const float HORIZON_INTERVALS = 1.5f;     // extrapolate this many update intervals, then return to the last position
+
+static TS3_VECTOR add(const TS3_VECTOR &a, const TS3_VECTOR &b, float scale)
+{
+    TS3_VECTOR out;
+    out.x = a.x + (b.x * scale);
+    out.y = a.y + (b.y * scale);
+    out.z = a.z + (b.z * scale);
+    return out;
+}
+
+static TS3_VECTOR lerp(const TS3_VECTOR &a, const TS3_VECTOR &b, float t)
+{
+    TS3_VECTOR out;
+    out.x = a.x + ((b.x - a.x) * t);
+    out.y = a.y + ((b.y - a.y) * t);
+    out.z = a.z + ((b.z - a.z) * t);
+    return out;
+}
+
+void AvatarMotion::update(const TS3_VECTOR &position, qint64 now)
+{
+    const auto kElapsed = now - m_time;
+    const auto kDx = position.x - m_position.x;
+    const auto kDy = position.y - m_position.y;
+    const auto kDz = position.z - m_position.z;
+    const auto kIsTeleport = ((kDx * kDx) + (kDy * kDy) + (kDz * kDz) > (float)(TELEPORT_DISTANCE * TELEPORT_DISTANCE));
+
+    if (!m_isValid || kIsTeleport || (kElapsed > MAX_UPDATE_GAP))
+    {
+        m_isValid = true;
+        m_position = m_blendPosition = position;
+        m_velocity.x = m_velocity.y = m_velocity.z = 0.0f;
+        m_blendVelocity = m_velocity;
+        m_time = now;
+        m_interval = 0.0f;
+        return;
+    }
+
+    if (kElapsed <= 0)  // same tick
+    {
+        m_position = position;
+        return;
+    }
+
+    // continue from where we were heading
+    m_blendPosition = predict(now);
+    m_blendVelocity = lerp(m_blendVelocity, m_velocity, qMin((float)kElapsed / BLEND, 1.0f));
+
+    m_velocity.x += ((kDx / kElapsed) - m_velocity.x) * VELOCITY_SMOOTHING;
+    m_velocity.y += ((kDy / kElapsed) - m_velocity.y) * VELOCITY_SMOOTHING;
+    m_velocity.z += ((kDz / kElapsed) - m_velocity.z) * VELOCITY_SMOOTHING;
+
+    m_interval = (m_interval > 0.0f) ? (m_interval + ((kElapsed - m_interval) * INTERVAL_SMOOTHING)) : (float)kElapsed;
+    m_position = position;
+    m_time = now;
+}
+
+TS3_VECTOR AvatarMotion::predict(qint64 now) const
+{
+    const auto kElapsed = (float)qMax((qint64)0, now - m_time);
+    const auto kHorizon = horizon();
+    if (kElapsed <= kHorizon)
+        return extrapolate(kElapsed);
+
+    if (kElapsed >= kHorizon + BLEND)
+        return m_position;
+
+    // the update is overdue, they stopped: head back to where they were last seen
+    return lerp(extrapolate(kHorizon), m_position, (kElapsed - kHorizon) / BLEND);
+}
+
+bool AvatarMotion::isSettled(qint64 now) const
+{
+    return ((float)(now - m_time) >= horizon() + BLEND);
+}
+
+float AvatarMotion::horizon() const
+{
+    return (m_interval > 0.0f) ? qMin(m_interval * HORIZON_INTERVALS, (float)MAX_EXTRAPOLATION) : 0.0f;
+}
+
+TS3_VECTOR AvatarMotion::extrapolate(float elapsed) const
+{
+    const auto kTarget = add(m_position, m_velocity, elapsed);
+    if (elapsed >= BLEND)
+        return kTarget;
+
+    // projective velocity blending
+    const auto kBlend = elapsed / BLEND;
+    const auto kVelocity = lerp(m_blendVelocity, m_velocity, kBlend);
+    const auto kProjected = add(m_blendPosition, kVelocity, elapsed);
+    return lerp(kProjected, kTarget, kBlend);
+}
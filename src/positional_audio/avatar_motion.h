@@ -0,0 +1,49 @@
+#pragma once
+
+#include <QtGlobal>
+#include "teamspeak/public_definitions.h"
+
+//! Dead reckoning of a remote avatar between updates
+/*!
+ * Velocity is estimated from consecutive updates. Between updates the position is extrapolated, for at most
+ * 1.5 times the measured update interval (and never beyond MAX_EXTRAPOLATION); on an update the path blends from
+ * where it was heading to the new one within BLEND (projective velocity blending), so corrections don't jump.
+ * Senders only send while their avatar moves, an overdue update means it stopped: past the horizon the position
+ * returns to the last received one within BLEND. Teleports snap.
+ * Times are msec of a monotonic clock.
+ */
+class AvatarMotion
+{
+public:
+    static const int BLEND = 150;
+    static const int MAX_EXTRAPOLATION = 1000;
+    static const int MAX_UPDATE_GAP = 2000;     // longer pauses restart the estimate
+    static const int TELEPORT_DISTANCE = 50;    // units
+
+    bool isValid() const {return m_isValid;}
+    void reset() {m_isValid = false;}
+
+    //! An update arrived
+    void update(const TS3_VECTOR &position, qint64 now);
+
+    //! Position at now
+    TS3_VECTOR predict(qint64 now) const;
+
+    //! Returned to the last received position; predict() won't change until the next update
+    bool isSettled(qint64 now) const;
+
+private:
+    float horizon() const;
+    TS3_VECTOR extrapolate(float elapsed) const;
+
+    bool m_isValid = false;
+
+    TS3_VECTOR m_position = {0.0f, 0.0f, 0.0f};    // last update
+    TS3_VECTOR m_velocity = {0.0f, 0.0f, 0.0f};    // units per msec
+    qint64 m_time = 0;
+    float m_interval = 0.0f;                        // smoothed msec between updates, 0 until measured
+
+    // path before the last update, blended out
+    TS3_VECTOR m_blendPosition = {0.0f, 0.0f, 0.0f};
+    TS3_VECTOR m_blendVelocity = {0.0f, 0.0f, 0.0f};
+};
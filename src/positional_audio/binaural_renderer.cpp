@@ -0,0 +1,363 @@
+#include "binaural_renderer.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+const float SAMPLE_RATE = 48000.0f;
+const float PI = 3.14159265358979323846f;
+
+// spherical head model
+const float HEAD_RADIUS = 0.0875f;          // m
+const float SPEED_OF_SOUND = 343.0f;        // m/s
+const float SHADOW_ALPHA_MIN = 0.1f;
+const float SHADOW_THETA_MIN = 150.0f;      // degrees, deepest shadow
+const int DELAY_BASE = 8;                   // samples ahead of the earliest arrival, room for the interpolator
+const int INTERPOLATOR_HALF_WIDTH = 8;
+const int FADE_OUT_TAPS = 16;
+
+// pinna echoes of the model: reflection coefficient, delay = A * cos(azimuth / 2) + B (samples at 44.1kHz)
+const int PINNA_ECHOES = 5;
+const float PINNA_RHO[PINNA_ECHOES] = { 0.5f, -1.0f, 0.5f, -0.25f, 0.25f };
+const float PINNA_A[PINNA_ECHOES] = { 1.0f, 5.0f, 5.0f, 5.0f, 5.0f };
+const float PINNA_B[PINNA_ECHOES] = { 2.0f, 4.0f, 7.0f, 11.0f, 13.0f };
+const float PINNA_GAIN = 0.15f;
+
+static float wrapDegrees(float degrees)
+{
+    degrees = fmodf(degrees + 180.0f, 360.0f);
+    if (degrees < 0.0f)
+        degrees += 360.0f;
+    return degrees - 180.0f;
+}
+
+// Hann windowed sinc, adds an impulse of gain at a fractional position
+static void addImpulse(float* taps, float position, float gain)
+{
+    const auto kCenter = (int)floorf(position);
+    for (int i = kCenter - INTERPOLATOR_HALF_WIDTH + 1; i <= kCenter + INTERPOLATOR_HALF_WIDTH; ++i)
+    {
+        if ((i < 0) || (i >= BinauralHrirSet::LENGTH))
+            continue;
+
+        const auto x = i - position;
+        const auto kSinc = (fabsf(x) < 1e-6f) ? 1.0f : sinf(PI * x) / (PI * x);
+        const auto kWindow = 0.5f + 0.5f * cosf(PI * x / INTERPOLATOR_HALF_WIDTH);
+        taps[i] += gain * kSinc * kWindow;
+    }
+}
+
+//! Response of one ear, ear 0 is left
+void BinauralHrirSet::design(float azimuth, int ear, float *taps)
+{
+    const auto kEarAzimuth = (ear == 0) ? -90.0f : 90.0f;
+    const auto kTheta = fabsf(wrapDegrees(azimuth - kEarAzimuth));   // 0: facing the ear, 180: opposite side
+    const auto kThetaRad = kTheta * PI / 180.0f;
+
+    // Woodworth, relative to the head center, shifted to be causal
+    const auto kRadiusTime = HEAD_RADIUS / SPEED_OF_SOUND;
+    const auto kDelay = (kTheta < 90.0f) ? (-kRadiusTime * cosf(kThetaRad)) : (kRadiusTime * (kThetaRad - (PI / 2.0f)));
+    const auto kArrival = DELAY_BASE + ((kDelay + kRadiusTime) * SAMPLE_RATE);
+
+    float impulse[LENGTH] = {};
+    addImpulse(impulse, kArrival, 1.0f);
+
+    // pinna echoes; cos(azimuth / 2) tells front from back
+    const auto kFrontBack = cosf(wrapDegrees(azimuth) * PI / 360.0f);
+    for (int echo = 0; echo < PINNA_ECHOES; ++echo)
+    {
+        const auto kEchoDelay = ((PINNA_A[echo] * kFrontBack) + PINNA_B[echo]) * (SAMPLE_RATE / 44100.0f);
+        addImpulse(impulse, kArrival + kEchoDelay, PINNA_GAIN * PINNA_RHO[echo]);
+    }
+
+    // head shadow (1 + alpha * s / 2w0) / (1 + s / 2w0), bilinear transformed
+    const auto kAlpha = (1.0f + SHADOW_ALPHA_MIN / 2.0f) + (1.0f - SHADOW_ALPHA_MIN / 2.0f) * cosf((kTheta / SHADOW_THETA_MIN) * PI);
+    const auto k = SAMPLE_RATE * HEAD_RADIUS / SPEED_OF_SOUND;
+    const auto kB0 = (1.0f + kAlpha * k) / (1.0f + k);
+    const auto kB1 = (1.0f - kAlpha * k) / (1.0f + k);
+    const auto kA1 = (1.0f - k) / (1.0f + k);
+    auto x1 = 0.0f;
+    auto y1 = 0.0f;
+    for (int i = 0; i < LENGTH; ++i)
+    {
+        const auto y = (kB0 * impulse[i]) + (kB1 * x1) - (kA1 * y1);
+        x1 = impulse[i];
+        y1 = y;
+        taps[i] = y;
+    }
+
+    for (int i = 0; i < FADE_OUT_TAPS; ++i)
+        taps[LENGTH - 1 - i] *= 0.5f - 0.5f * cosf(PI * i / FADE_OUT_TAPS);
+}
+
+BinauralHrirSet::BinauralHrirSet(const DspFft &fft, int partitionSize)
+    : m_fftSize(fft.size())
+    , m_partitions((LENGTH + partitionSize - 1) / partitionSize)
+{
+    m_re.resize(AZIMUTHS * EARS * m_partitions * m_fftSize);
+    m_im.resize(m_re.size());
+
+    // unit energy per direction, summed over the ears: the model's head shadow boosts the near ear by more than it
+    // cuts the far one, unnormalised a talker at the side would be louder than straight ahead
+    float taps[EARS][LENGTH];
+    for (int azimuthNr = 0; azimuthNr < AZIMUTHS; ++azimuthNr)
+    {
+        auto energy = 0.0f;
+        for (int ear = 0; ear < EARS; ++ear)
+        {
+            design(azimuthNr * (360.0f / AZIMUTHS), ear, taps[ear]);
+            for (int i = 0; i < LENGTH; ++i)
+                energy += taps[ear][i] * taps[ear][i];
+        }
+        const auto kScale = 1.0f / (sqrtf(energy / EARS) * m_fftSize);  // includes the 1/N of the inverse transform
+
+        for (int ear = 0; ear < EARS; ++ear)
+        {
+            for (int partition = 0; partition < m_partitions; ++partition)
+            {
+                auto re = m_re.data() + offset(azimuthNr, ear, partition);
+                auto im = m_im.data() + offset(azimuthNr, ear, partition);
+                for (int i = 0; i < m_fftSize; ++i)
+                {
+                    const auto kTap = (partition * partitionSize) + i;
+                    re[i] = ((i < partitionSize) && (kTap < LENGTH)) ? taps[ear][kTap] * kScale : 0.0f;
+                    im[i] = 0.0f;
+                }
+                fft.forward(re, im);
+            }
+        }
+    }
+}
+
+int BinauralHrirSet::azimuthIndex(float azimuth)
+{
+    auto degrees = fmodf(azimuth, 360.0f);
+    if (degrees < 0.0f)
+        degrees += 360.0f;
+    return (int)lrintf(degrees * (AZIMUTHS / 360.0f)) % AZIMUTHS;
+}
+
+// Voice
+
+void BinauralVoice::reset(int azimuthIndex, float gain)
+{
+    memset(m_in, 0, sizeof(m_in));
+    memset(m_history, 0, sizeof(m_history));
+    memset(m_outLeft, 0, sizeof(m_outLeft));
+    memset(m_outRight, 0, sizeof(m_outRight));
+    memset(m_fdlRe, 0, sizeof(m_fdlRe));
+    memset(m_fdlIm, 0, sizeof(m_fdlIm));
+    m_pos = 0;
+    m_head = 0;
+    m_azimuth = m_azimuthTarget = azimuthIndex;
+    m_gain = m_gainTarget = gain;
+}
+
+// Both ears in one inverse transform: their outputs are real, so left + j * right is transformed
+// and comes back as real / imaginary part.
+void BinauralVoice::render(int azimuthIndex, const BinauralHrirSet &hrirs, const DspFft &fft, float *left, float *right)
+{
+    float re[FFT_SIZE] = {};
+    float im[FFT_SIZE] = {};
+    const auto kPartitions = hrirs.getPartitions();
+    for (int partition = 0; partition < kPartitions; ++partition)
+    {
+        const auto kSlot = (m_head - partition + MAX_PARTITIONS) % MAX_PARTITIONS;
+        const auto kXre = m_fdlRe[kSlot];
+        const auto kXim = m_fdlIm[kSlot];
+        const auto kLre = hrirs.re(azimuthIndex, 0, partition);
+        const auto kLim = hrirs.im(azimuthIndex, 0, partition);
+        const auto kRre = hrirs.re(azimuthIndex, 1, partition);
+        const auto kRim = hrirs.im(azimuthIndex, 1, partition);
+        for (int i = 0; i < FFT_SIZE; ++i)
+        {
+            const auto kYLre = (kXre[i] * kLre[i]) - (kXim[i] * kLim[i]);
+            const auto kYLim = (kXre[i] * kLim[i]) + (kXim[i] * kLre[i]);
+            const auto kYRre = (kXre[i] * kRre[i]) - (kXim[i] * kRim[i]);
+            const auto kYRim = (kXre[i] * kRim[i]) + (kXim[i] * kRre[i]);
+            re[i] += kYLre - kYRim;
+            im[i] += kYLim + kYRre;
+        }
+    }
+    fft.inverse(re, im);
+
+    // overlap-save: the first half wraps around
+    memcpy(left, re + PARTITION, PARTITION * sizeof(float));
+    memcpy(right, im + PARTITION, PARTITION * sizeof(float));
+}
+
+void BinauralVoice::processPartition(const BinauralHrirSet &hrirs, const DspFft &fft)
+{
+    m_head = (m_head + 1) % MAX_PARTITIONS;
+    auto re = m_fdlRe[m_head];
+    auto im = m_fdlIm[m_head];
+    memcpy(re, m_history, PARTITION * sizeof(float));
+    memcpy(re + PARTITION, m_in, PARTITION * sizeof(float));
+    memset(im, 0, FFT_SIZE * sizeof(float));
+    fft.forward(re, im);
+    memcpy(m_history, m_in, sizeof(m_history));
+
+    render(m_azimuth, hrirs, fft, m_outLeft, m_outRight);
+
+    if (m_azimuthTarget != m_azimuth)
+    {
+        float left[PARTITION];
+        float right[PARTITION];
+        render(m_azimuthTarget, hrirs, fft, left, right);
+        for (int i = 0; i < PARTITION; ++i)
+        {
+            const auto kFade = (i + 1) * (1.0f / PARTITION);
+            m_outLeft[i] += (left[i] - m_outLeft[i]) * kFade;
+            m_outRight[i] += (right[i] - m_outRight[i]) * kFade;
+        }
+        m_azimuth = m_azimuthTarget;
+    }
+
+    const auto kGainStep = (m_gainTarget - m_gain) * (1.0f / PARTITION);
+    for (int i = 0; i < PARTITION; ++i)
+    {
+        const auto kGain = m_gain + kGainStep * (i + 1);
+        m_outLeft[i] *= kGain;
+        m_outRight[i] *= kGain;
+    }
+    m_gain = m_gainTarget;
+}
+
+// Renderer
+
+BinauralRenderer::BinauralRenderer()
+    : m_fft(BinauralVoice::FFT_SIZE)
+    , m_hrirs(m_fft, BinauralVoice::PARTITION)
+    , m_pool(MAX_VOICES)
+{
+}
+
+// playback thread
+void BinauralRenderer::applyTargets()
+{
+    ++m_targetGeneration;
+    const auto& targets = m_targets.front();
+    for (int i = 0; i < targets.count; ++i)
+    {
+        const auto& target = targets.targets[i];
+        auto voice = m_voices.value(target.serverConnectionHandlerID, target.clientID);
+        if (voice)
+        {
+            const auto kAzimuthIndex = BinauralHrirSet::azimuthIndex(target.azimuth);
+            if (voice->talkBurst != target.talkBurst)
+            {
+                // a burst ended since: drop the tail still in the delay line and the overlap
+                voice->reset(kAzimuthIndex, target.gain);
+                voice->talkBurst = target.talkBurst;
+            }
+            else
+                voice->setTarget(kAzimuthIndex, target.gain);
+
+            voice->targetGeneration = m_targetGeneration;
+        }
+    }
+}
+
+BinauralVoice* BinauralRenderer::acquireVoice(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    // only talkers the gui thread knows a direction for
+    const BinauralTarget* target = nullptr;
+    const auto& targets = m_targets.front();
+    for (int i = 0; i < targets.count; ++i)
+    {
+        if ((targets.targets[i].serverConnectionHandlerID == serverConnectionHandlerID) && (targets.targets[i].clientID == clientID))
+        {
+            target = &targets.targets[i];
+            break;
+        }
+    }
+    if (!target)
+        return nullptr;
+
+    BinauralVoice* voice = nullptr;
+    if (!m_voices.isFull())
+    {
+        for (auto& candidate : m_pool)
+        {
+            if (!candidate.isActive)
+            {
+                voice = &candidate;
+                break;
+            }
+        }
+    }
+    else
+    {
+        // recycle the least recently used voice if its talker has been quiet for a while
+        uint64 lruServerConnectionHandlerID = 0;
+        anyID lruClientID = 0;
+        auto lruAge = STALE_TICKS;
+        m_voices.forEach([&](uint64 sc, anyID client, const SlotRef<BinauralVoice*>& ref)
+        {
+            const auto kAge = m_tick - ref.value->lastUsed;
+            if (kAge > lruAge)
+            {
+                lruAge = kAge;
+                lruServerConnectionHandlerID = sc;
+                lruClientID = client;
+            }
+        });
+        if (lruServerConnectionHandlerID != 0)
+            m_voices.take(lruServerConnectionHandlerID, lruClientID, voice);
+    }
+
+    if (!voice)
+        return nullptr;
+
+    voice->reset(BinauralHrirSet::azimuthIndex(target->azimuth), target->gain);
+    voice->talkBurst = target->talkBurst;
+    voice->targetGeneration = m_targetGeneration;
+    voice->isActive = true;
+    m_voices.insert(serverConnectionHandlerID, clientID, voice);
+    return voice;
+}
+
+bool BinauralRenderer::process(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels,
+                               int leftChannelNr, int rightChannelNr, unsigned int *channelFillMask)
+{
+    if (m_targets.update())
+        applyTargets();
+
+    ++m_tick;
+    auto voice = m_voices.value(serverConnectionHandlerID, clientID);
+    if (!voice)
+        voice = acquireVoice(serverConnectionHandlerID, clientID);
+    if (!voice || (voice->targetGeneration != m_targetGeneration))
+        return false;
+
+    voice->lastUsed = m_tick;
+
+    int filled[32];
+    int filledCount = 0;
+    for (int channel = 0; (channel < channels) && (channel < 32); ++channel)
+    {
+        if (*channelFillMask & (1u << channel))
+            filled[filledCount++] = channel;
+    }
+    if (filledCount == 0)
+        return true;
+
+    const auto kScale = 1.0f / (filledCount * 32768.0f);
+    for (int i = 0; i < sampleCount; ++i)
+    {
+        auto frame = samples + (i * channels);
+        auto mono = 0.0f;
+        for (int j = 0; j < filledCount; ++j)
+        {
+            mono += frame[filled[j]];
+            frame[filled[j]] = 0;
+        }
+
+        float left, right;
+        voice->tick(mono * kScale, left, right, m_hrirs, m_fft);
+        frame[leftChannelNr] = (short)std::min(std::max(lrintf(left * 32768.0f), -32768L), 32767L);
+        frame[rightChannelNr] = (short)std::min(std::max(lrintf(right * 32768.0f), -32768L), 32767L);
+    }
+    *channelFillMask |= (1u << leftChannelNr) | (1u << rightChannelNr);
+    return true;
+}
@@ -0,0 +1,157 @@
+#pragma once
+
+#include <QVector>
+#include "teamspeak/public_definitions.h"
+#include "../dsp_fft.h"
+#include "../slot_table.h"
+#include "../triple_buffer.h"
+
+//! Direction and distance gain of a positioned talker, relative to the listener
+struct BinauralTarget
+{
+    uint64 serverConnectionHandlerID = 0;
+    anyID clientID = 0;
+    float azimuth = 0.0f;   // degrees, 0 is front, positive is right
+    float gain = 1.0f;      // linear distance attenuation
+    quint32 talkBurst = 0;  // talk bursts ended so far; a change resets the voice
+};
+
+//! All positioned talkers, published by the gui thread as a whole
+struct BinauralTargets
+{
+    static const int CAPACITY = 256;
+
+    int count = 0;
+    BinauralTarget targets[CAPACITY];
+};
+
+//! Head related impulse responses on the horizontal plane, as uniformly partitioned spectra
+/*!
+ * Generated from a spherical head model (Brown & Duda): Woodworth interaural time difference, a one pole / one zero
+ * head shadow per ear and the pinna echoes of the model, whose delays differ between front and back.
+ * Every response is split into partitions of partitionSize taps, each zero padded to the fft size and transformed.
+ */
+class BinauralHrirSet
+{
+public:
+    static const int AZIMUTHS = 72;         // 5 degree steps
+    static const int LENGTH = 128;          // taps
+    static const int EARS = 2;
+
+    BinauralHrirSet(const DspFft &fft, int partitionSize);
+
+    int getPartitions() const {return m_partitions;}
+
+    //! Nearest response for an azimuth in degrees
+    static int azimuthIndex(float azimuth);
+
+    const float* re(int azimuthIndex, int ear, int partition) const {return m_re.constData() + offset(azimuthIndex, ear, partition);}
+    const float* im(int azimuthIndex, int ear, int partition) const {return m_im.constData() + offset(azimuthIndex, ear, partition);}
+
+    //! Time domain response, for tests and display
+    static void design(float azimuth, int ear, float* taps);
+
+private:
+    int offset(int azimuthIndex, int ear, int partition) const
+    {
+        return (((azimuthIndex * EARS) + ear) * m_partitions + partition) * m_fftSize;
+    }
+
+    int m_fftSize;
+    int m_partitions;
+    QVector<float> m_re;
+    QVector<float> m_im;
+};
+
+//! Convolution state of one talker: overlap-save over a frequency domain delay line
+/*!
+ * Latency is one partition. A new azimuth is applied at the next partition boundary, that partition is rendered
+ * with the old and the new response and crossfaded; the distance gain ramps across the partition.
+ * The state is reset between talk bursts, the next one doesn't start with the tail of the last.
+ */
+class BinauralVoice
+{
+public:
+    static const int PARTITION = 64;
+    static const int FFT_SIZE = PARTITION * 2;
+    static const int MAX_PARTITIONS = (BinauralHrirSet::LENGTH + PARTITION - 1) / PARTITION;
+
+    void reset(int azimuthIndex, float gain);
+    void setTarget(int azimuthIndex, float gain) {m_azimuthTarget = azimuthIndex; m_gainTarget = gain;}
+
+    //! One sample in, one sample per ear out, delayed by PARTITION samples
+    inline void tick(float in, float &left, float &right, const BinauralHrirSet &hrirs, const DspFft &fft)
+    {
+        left = m_outLeft[m_pos];
+        right = m_outRight[m_pos];
+        m_in[m_pos] = in;
+        if (++m_pos == PARTITION)
+        {
+            processPartition(hrirs, fft);
+            m_pos = 0;
+        }
+    }
+
+    quint32 lastUsed = 0;
+    quint32 targetGeneration = 0;   // voices of talkers missing from the latest targets stay silent
+    quint32 talkBurst = 0;          // BinauralTarget::talkBurst the state belongs to
+    bool isActive = false;
+
+private:
+    void processPartition(const BinauralHrirSet &hrirs, const DspFft &fft);
+    void render(int azimuthIndex, const BinauralHrirSet &hrirs, const DspFft &fft, float* left, float* right);
+
+    float m_in[PARTITION];
+    float m_history[PARTITION];
+    float m_outLeft[PARTITION];
+    float m_outRight[PARTITION];
+    int m_pos = 0;
+
+    // input spectra, newest at m_head
+    float m_fdlRe[MAX_PARTITIONS][FFT_SIZE];
+    float m_fdlIm[MAX_PARTITIONS][FFT_SIZE];
+    int m_head = 0;
+
+    int m_azimuth = 0;
+    int m_azimuthTarget = 0;
+    float m_gain = 1.0f;
+    float m_gainTarget = 1.0f;
+};
+
+//! Renders positioned talkers binaurally in the post process stage
+/*!
+ * The gui thread publishes the talker directions through targets() / publishTargets();
+ * everything else belongs to the playback thread, including the voice table. Voices come from a pool allocated on
+ * construction, the least recently used one is recycled when a new talker starts; nothing allocates per block.
+ */
+class BinauralRenderer
+{
+public:
+    static const int MAX_VOICES = 64;
+    static const quint32 STALE_TICKS = MAX_VOICES * 4;  // blocks of any talker since a voice was last used
+
+    BinauralRenderer();
+
+    // gui thread
+    BinauralTargets& targets() {return m_targets.back();}
+    void publishTargets() {m_targets.publish();}
+
+    // playback thread
+    //! Downmixes the filled channels of a block and renders it to the left / right channel;
+    //! false if the talker has no published target or no voice is available
+    bool process(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels,
+                 int leftChannelNr, int rightChannelNr, unsigned int* channelFillMask);
+
+private:
+    BinauralVoice* acquireVoice(uint64 serverConnectionHandlerID, anyID clientID);
+    void applyTargets();
+
+    DspFft m_fft;
+    BinauralHrirSet m_hrirs;
+    TripleBuffer<BinauralTargets> m_targets;
+
+    QVector<BinauralVoice> m_pool;
+    SlotTable<BinauralVoice*, MAX_VOICES> m_voices;
+    quint32 m_tick = 0;
+    quint32 m_targetGeneration = 0;
+};
@@ -0,0 +1,28 @@
+#include "json_batch.h"
+
+void JsonBatch::post(const QString &key, const QString &json, bool isRemoval)
+{
+    Entry entry;
+    entry.key = key;
+    entry.json = json;
+    entry.isRemoval = isRemoval;
+
+    const auto kIt = m_index.constFind(key);
+    if (kIt != m_index.constEnd())
+    {
+        m_pending[*kIt] = entry;
+        return;
+    }
+
+    m_index.insert(key, m_pending.size());
+    m_pending.append(entry);
+}
+
+//! The pending entries, empties the batch
+QVector<JsonBatch::Entry> JsonBatch::take()
+{
+    QVector<Entry> entries;
+    entries.swap(m_pending);
+    m_index.clear();
+    return entries;
+}
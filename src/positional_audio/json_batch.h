@@ -0,0 +1,29 @@
+#pragma once
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+//! Pending JSON broadcasts, one per key
+/*!
+ * Objects posted between two flushes are coalesced: a newer object replaces the pending one of the same key
+ * (a player's uid, "me" for myself), keeping its place. take() hands them over in posting order.
+ */
+class JsonBatch
+{
+public:
+    struct Entry
+    {
+        QString key;
+        QString json;
+        bool isRemoval = false;     // the key is gone, json announces it
+    };
+
+    void post(const QString &key, const QString &json, bool isRemoval = false);
+    bool isEmpty() const {return m_pending.isEmpty();}
+    QVector<Entry> take();
+
+private:
+    QHash<QString, int> m_index;
+    QVector<Entry> m_pending;
+};
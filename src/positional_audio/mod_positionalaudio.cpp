@@ -33,29 +33,32 @@
 #define INCHTOM(b) (b*39.3701)
 #endif
 
+// cuts at a character boundary, always terminates
+static void copyUtf8(char *dest, int size, const QString &val)
+{
+    const auto kUtf8 = val.toUtf8();
+    auto length = qMin(kUtf8.size(), size - 1);
+    if (length < kUtf8.size())
+    {
+        while ((length > 0) && ((kUtf8.at(length) & 0xC0) == 0x80))
+            --length;
+    }
+    memcpy(dest, kUtf8.constData(), length);
+    dest[length] = 0;
+}
+
+static void copyVector(float *dest, const TS3_VECTOR &val)
+{
+    dest[0] = val.x;
+    dest[1] = val.y;
+    dest[2] = val.z;
+}
+
 //bool operator==(const TS3_VECTOR &vec, const float *arr)
 //{
 //    return ((vec.x == arr[0]) && (vec.y == arr[1]) && (vec.z == arr[2]));
 //}
 
-struct LinkedMem {
-    quint32 uiVersion;              //win:UINT32;posix:uint32_t
-    ulong   dwcount;                //win:DWORD;posix:uint32_t  - ToDo: this is rather irritating, isn't it?
-    float	fAvatarPosition[3];
-    float	fAvatarFront[3];
-    float	fAvatarTop[3];
-    wchar_t	name[256];
-    float	fCameraPosition[3];
-    float	fCameraFront[3];
-    float	fCameraTop[3];
-    wchar_t	identity[256];
-    quint32 context_len;            //win:UINT32;posix:uint32_t
-    unsigned char context[256];
-    wchar_t description[2048];
-};
-
-static LinkedMem *lm = NULL;
-
 PositionalAudio::PositionalAudio(QObject *parent)
 {
     this->setParent(parent);
@@ -63,9 +66,21 @@ PositionalAudio::PositionalAudio(QObject *parent)
     m_isPrintEnabled = false;
     universe = new TsVrUniverse(this);
     meObj = new TsVrObjSelf(this);
+    m_mumbleLink = new MumbleLink(this);
+    connect(m_mumbleLink, &MumbleLink::linked, this, &PositionalAudio::onMumbleLinkLinked);
+    connect(m_mumbleLink, &MumbleLink::changed, this, &PositionalAudio::onMumbleLinkChanged);
+    connect(m_mumbleLink, &MumbleLink::unlinked, this, &PositionalAudio::unlock);
     NULL_VECTOR.x = 0.0f;
     NULL_VECTOR.y = 0.0f;
     NULL_VECTOR.z = 0.0f;
+    CULLED_VECTOR.x = 1.0e7f;
+    CULLED_VECTOR.y = 1.0e7f;
+    CULLED_VECTOR.z = 1.0e7f;
+}
+
+PositionalAudio::~PositionalAudio()
+{
+    delete m_binauralRenderer.load();
 }
 
 // Properties
@@ -84,6 +99,11 @@ bool PositionalAudio::isUseCamera() const
     return m_isUseCamera;
 }
 
+bool PositionalAudio::isBinauralEnabled() const
+{
+    return m_isBinauralEnabled.load();
+}
+
 bool PositionalAudio::isUseAttenuation() const
 {
     return m_isUseAttenuation;
@@ -109,9 +129,20 @@ float PositionalAudio::getRollOffMax() const
     return m_rollOffMax;
 }
 
-bool PositionalAudio::isPositioned(anyID clientID) const
+int PositionalAudio::getRollOffModel() const
+{
+    return m_rollOffModel;
+}
+
+QString PositionalAudio::getRollOffSpline() const
 {
-    return m_PlayersInMyContext.contains(clientID);
+    return RolloffCurve::toString(m_rollOffSpline);
+}
+
+// playback thread
+bool PositionalAudio::isPositioned(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    return universe->isPositioned(TsVrUniverse::PostProcessReader, serverConnectionHandlerID, clientID);
 }
 
 void PositionalAudio::setUseCamera(bool val)
@@ -122,6 +153,38 @@ void PositionalAudio::setUseCamera(bool val)
     emit useCameraChanged(m_isUseCamera);
 }
 
+void PositionalAudio::setBinauralEnabled(bool val)
+{
+    if (isBinauralEnabled() == val)
+        return;
+
+    if (val && !m_binauralRenderer.load())
+        m_binauralRenderer.storeRelease(new BinauralRenderer());
+
+    m_isBinauralEnabled.store(val);
+    if (isRunning())
+    {
+        if (val)
+            PublishBinauralTargets();
+        else
+        {
+            // hand the players back to TeamSpeak's 3D
+            for (TsVrUniverse::Handle handle = 0; handle < universe->capacity(); ++handle)
+            {
+                const auto kServerConnectionHandlerID = universe->getServerConnectionHandlerID(handle);
+                const auto kClientID = universe->getClientID(handle);
+                if (!universe->isInContext(handle) || isCulled(kServerConnectionHandlerID, kClientID))
+                    continue;
+
+                auto vector = universe->getAvatarPosition(handle);
+                ts3Functions.channelset3DAttributes(kServerConnectionHandlerID, kClientID, &vector);
+            }
+        }
+        Update3DListenerAttributes();
+    }
+    emit binauralEnabledChanged(val);
+}
+
 void PositionalAudio::setUseAttenuation(bool val)
 {
     if (m_isUseAttenuation == val)
@@ -135,6 +198,7 @@ void PositionalAudio::setDistanceMin(int val)
     if (m_distanceMin == val)
         return;
     m_distanceMin = val;
+    UpdateRolloffCurve();
     emit distanceMinChanged(m_distanceMin);
 }
 
@@ -143,6 +207,9 @@ void PositionalAudio::setDistanceMax(int val)
     if (m_distanceMax == val)
         return;
     m_distanceMax = val;
+    if (m_distanceMax > 0)
+        m_spatialGrid.setCellSize((float)(m_distanceMax + CULL_MARGIN));   // queries span 3x3x3 cells
+    UpdateRolloffCurve();
     emit distanceMaxChanged(m_distanceMax);
 }
 
@@ -151,7 +218,7 @@ void PositionalAudio::setRollOff(float val)
     if (m_rollOff == val)
         return;
     m_rollOff = val;
-    //m_rollOff_Lin = db2lin_alt2(m_rollOff);
+    UpdateRolloffCurve();
     emit rollOffChanged(m_rollOff);
 }
 
@@ -160,10 +227,45 @@ void PositionalAudio::setRollOffMax(float val)
     if (m_rollOffMax == val)
         return;
     m_rollOffMax = val;
-    m_rollOffMax_Lin = db2lin_alt2(m_rollOffMax);
+    UpdateRolloffCurve();
     emit rollOffMaxChanged(m_rollOffMax);
 }
 
+void PositionalAudio::setRollOffModel(int val)
+{
+    if (m_rollOffModel == val)
+        return;
+    m_rollOffModel = val;
+    UpdateRolloffCurve();
+    emit rollOffModelChanged(m_rollOffModel);
+}
+
+//! "fraction:dB,..." with the fraction of the curve's range, see RolloffCurve
+void PositionalAudio::setRollOffSpline(QString val)
+{
+    const auto kSpline = RolloffCurve::parseSpline(val);
+    if (kSpline.isEmpty() && !val.trimmed().isEmpty())
+        Error(QString("Invalid rolloff spline: %1").arg(val));
+
+    if (kSpline == m_rollOffSpline)
+        return;
+    m_rollOffSpline = kSpline;
+    UpdateRolloffCurve();
+    emit rollOffSplineChanged(getRollOffSpline());
+}
+
+//! Rebuilds the curve, hands a copy over to the rolloff callback
+/*!
+ * The callback runs on an audio thread, it must never see a curve half rebuilt. The copy shares the spline points
+ * (implicitly shared, read only on that side), the next rebuild detaches from them.
+ */
+void PositionalAudio::UpdateRolloffCurve()
+{
+    m_rolloffCurve.build(m_rollOffModel, m_distanceMin, m_distanceMax, m_rollOff, m_rollOffMax, m_rollOffSpline);
+    m_publishedRolloffCurve.back() = m_rolloffCurve;
+    m_publishedRolloffCurve.publish();
+}
+
 void PositionalAudio::AddServerSetting(QString serverUniqueId, QString serverName)
 {
     if (m_ServerSettings.contains(serverUniqueId))
@@ -265,7 +367,7 @@ void PositionalAudio::onMyVrChanged(TsVrObj *obj, QString val)
 {
     Q_UNUSED(obj);
     if (val.isEmpty())
-        emit BroadcastJSON(QStringLiteral("{\"me\":true}"));
+        m_broadcastBatch.post(QStringLiteral("me"), QStringLiteral("{\"me\":true}"), true);
 
     emit myVrChanged(val);
 }
@@ -283,7 +385,85 @@ void PositionalAudio::onUniverseRemoved(QString clientUID)
     out << "{";
     out << "\"uid\":\"" << clientUID << "\",";
     out << "\"me\":false}";
-    emit BroadcastJSON(out_stri);
+    m_broadcastBatch.post(clientUID, out_stri, true);
+}
+
+void PositionalAudio::onClientDisplayNameChanged(uint64 serverConnectionHandlerID, anyID clientID, const char *displayName)
+{
+    Q_UNUSED(displayName);
+    universe->onClientDisplayNameChanged(serverConnectionHandlerID, clientID);
+}
+
+//! Counts the ended talk bursts of the players, the binaural renderer starts each burst on a clean voice
+void PositionalAudio::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe)
+{
+    Q_UNUSED(isReceivedWhisper);
+    if (isMe || (status != STATUS_NOT_TALKING))
+        return;
+
+    ++m_talkBursts[qMakePair(serverConnectionHandlerID, clientID)];
+    PublishBinauralTargets();
+}
+
+//! Sends the updates coalesced since the last motion tick
+/*!
+ * While many players move, every "3D" command would otherwise be a message to each transport.
+ * Only the latest update per player is kept; each is still its own JSON object message, the format clients
+ * (like the gw2 map page) parse. It is encoded to UTF-8 once, the transports share the bytes.
+ * The updates also go into the history's state, the snapshot new clients start from.
+ */
+void PositionalAudio::FlushBroadcast()
+{
+    if (m_broadcastBatch.isEmpty())
+        return;
+
+    auto &history = PluginQt::instance()->m_PositionalHistory;
+    const auto kEntries = m_broadcastBatch.take();
+    for (const auto &entry : kEntries)
+    {
+        if (entry.isRemoval)
+            history.removeState(entry.key);
+        else
+            history.setState(entry.key, entry.json);
+
+        emit BroadcastJSONText(entry.json);
+        emit BroadcastJSON(entry.json.toUtf8(), entry.key);
+    }
+
+    PublishPlayers();
+}
+
+//! Rebuilds the player table of the shared memory overlays read
+void PositionalAudio::PublishPlayers()
+{
+    auto stateLink = PluginQt::instance()->m_StateLink;
+    stateLink->clearPlayers();
+
+    if (!meObj->getVr().isEmpty())
+    {
+        auto player = stateLink->addPlayer();
+        player->flags = StateLinkPlayer::Me;
+        copyVector(player->position, meObj->getAvatarPosition());
+        copyVector(player->front, meObj->getAvatarFront());
+    }
+
+    for (TsVrUniverse::Handle handle = 0; handle < universe->capacity(); ++handle)
+    {
+        if (!universe->isValid(handle) || (universe->getVrId(handle) == 0))
+            continue;
+
+        auto player = stateLink->addPlayer();
+        if (!player)
+            break;
+
+        player->serverConnectionHandlerID = universe->getServerConnectionHandlerID(handle);
+        player->clientID = universe->getClientID(handle);
+        player->flags = universe->isInContext(handle) ? StateLinkPlayer::InContext : 0;
+        copyVector(player->position, universe->getAvatarPosition(handle));
+        copyVector(player->front, universe->getAvatarFront(handle));
+        copyUtf8(player->uid, sizeof(player->uid), universe->getClientUID(handle));
+        copyUtf8(player->name, sizeof(player->name), universe->getDisplayName(handle));
+    }
 }
 
 QMap<QString, PositionalAudio_ServerSettings> PositionalAudio::getServerSettings() const
@@ -326,12 +506,12 @@ void PositionalAudio::onClientMoveEvent(uint64 serverConnectionHandlerID, anyID
         }
         if (isRemove)
         {
+            const auto kIsInContext = universe->isInContext(serverConnectionHandlerID,clientID);
             universe->Remove(serverConnectionHandlerID,clientID);
-            if (m_PlayersInMyContext.contains(serverConnectionHandlerID,clientID))
-            {
-                m_PlayersInMyContext.remove(serverConnectionHandlerID,clientID);
+            m_spatialGrid.remove(serverConnectionHandlerID,clientID);
+            m_culledPlayers.remove(qMakePair(serverConnectionHandlerID,clientID));
+            if (kIsInContext)
                 ts3Functions.channelset3DAttributes(serverConnectionHandlerID, clientID, &NULL_VECTOR);
-            }
         }
     }
 }
@@ -345,29 +525,35 @@ void PositionalAudio::onCustom3dRolloffCalculationClientEvent(uint64 serverConne
         *volume = 1.0f;
     else
     {
-        if (!m_PlayersInMyContext.contains(serverConnectionHandlerID,clientID))
+        if (!universe->isPositioned(TsVrUniverse::RolloffReader, serverConnectionHandlerID, clientID))
             *volume = 1.0f;
         else
         {
-            if ((m_distanceMax > 0) && (distance >= m_distanceMax))
-                *volume = 0.0f;
-            else if (distance <= m_distanceMin)
-                *volume = 1.0f;
-            else
-            {
-                distance = distance - m_distanceMin;
-                if(distance <= 1)
-                    *volume = 1.0f;
-                else
-                    *volume = db2lin_alt2(log2(distance) * m_rollOff);
-
-                if (*volume < m_rollOffMax_Lin)
-                    *volume = m_rollOffMax_Lin;
-            }
+            m_publishedRolloffCurve.update();
+            *volume = m_publishedRolloffCurve.front().volume(distance);
         }
     }
 }
 
+// playback thread; returns true if the block has been rendered binaurally
+bool PositionalAudio::onEditPostProcessVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels, const unsigned int *channelSpeakerArray, unsigned int *channelFillMask)
+{
+    if (!m_isBinauralEnabled.load() || (*channelFillMask == 0) || (channels == 1))
+        return false;
+
+    auto renderer = m_binauralRenderer.loadAcquire();
+    if (!renderer)
+        return false;
+
+    // headphones or stereo speakers only, surround layouts have TeamSpeak's own 3D
+    m_speakerRouting.update(channels, channelSpeakerArray, *channelFillMask);
+    const auto& route = m_speakerRouting.route();
+    if ((route.mode != SpeakerRoute::Stereo) || route.isSurround)
+        return false;
+
+    return renderer->process(serverConnectionHandlerID, clientID, samples, sampleCount, channels, route.left, route.right, channelFillMask);
+}
+
 bool PositionalAudio::onInfoDataChanged(uint64 serverConnectionHandlerID, uint64 id, PluginItemType type, uint64 mine, QTextStream &data)
 {
     if (!isRunning())
@@ -376,16 +562,17 @@ bool PositionalAudio::onInfoDataChanged(uint64 serverConnectionHandlerID, uint64
     bool isDirty = false;
     if (type == PLUGIN_CLIENT)
     {
+        auto handle = TsVrUniverse::INVALID_HANDLE;
         if (id == mine)
             isDirty |= meObj->onInfoDataChanged(data);
-        else if (universe->Contains(serverConnectionHandlerID,(anyID)id))
-            isDirty |= universe->Get(serverConnectionHandlerID,(anyID)id)->onInfoDataChanged(data);
+        else if ((handle = universe->Find(serverConnectionHandlerID,(anyID)id)) != TsVrUniverse::INVALID_HANDLE)
+            isDirty |= universe->onInfoDataChanged(handle,data);
         else
             return isDirty;
 
         if (isDirty && (id != mine))
         {
-            if (m_PlayersInMyContext.contains(serverConnectionHandlerID,(anyID)id))
+            if (universe->isInContext(handle))
             {
                 data << "\ncontext: match";
             }
@@ -432,237 +619,218 @@ void PositionalAudio::onRunningStateChanged(bool value)
 //        }
         connect(Talkers::instance(),SIGNAL(ConnectStatusChanged(uint64,int,uint)),this,SLOT(onConnectStatusChanged(uint64,int,uint)),Qt::UniqueConnection);
         connect(universe,SIGNAL(removed(QString)),this,SLOT(onUniverseRemoved(QString)),Qt::UniqueConnection);
+        connect(Talkers::instance(), &Talkers::TalkStatusChanged, this, &PositionalAudio::onTalkStatusChanged, Qt::UniqueConnection);
         connect(meObj,SIGNAL(vrChanged(TsVrObj*,QString)),this,SLOT(onMyVrChanged(TsVrObj*,QString)),Qt::UniqueConnection);
         connect(meObj,SIGNAL(identityChanged(TsVrObj*,QString)),this,SLOT(onMyIdentityChanged(TsVrObj*,QString)),Qt::UniqueConnection);
-        connect(this,&PositionalAudio::BroadcastJSON, (PluginQt::instance()->m_PipeServer), &PipeServer::Send, Qt::UniqueConnection);
+        connect(this,&PositionalAudio::BroadcastJSON, (PluginQt::instance()->m_PipeServer), static_cast<void (PipeServer::*)(const QByteArray &, const QString &)>(&PipeServer::Send), Qt::UniqueConnection);
 #ifdef USE_WEBSOCKET
-        connect(this, SIGNAL(BroadcastJSON(QString)),PluginQt::instance()->m_WebSocketServer,SIGNAL(broadcastMessage(QString)), Qt::UniqueConnection);
+        connect(this, SIGNAL(BroadcastJSONText(QString)),PluginQt::instance()->m_WebSocketServer,SIGNAL(broadcastMessage(QString)), Qt::UniqueConnection);
 #endif
-        connect(this,SIGNAL(BroadcastJSON(QString)),PluginQt::instance(),SLOT(LocalServerSend(QString)),Qt::UniqueConnection);
-        m_sharedMemory = new QSharedMemory(this);
-        m_sharedMemory->setNativeKey("MumbleLink");
-        if (!m_sharedMemory->create(sizeof(LinkedMem),QSharedMemory::ReadWrite))
+        connect(this,SIGNAL(BroadcastJSON(QByteArray,QString)),PluginQt::instance(),SLOT(LocalServerSend(QByteArray,QString)),Qt::UniqueConnection);
+        if (!m_mumbleLink->open())
         {
-            if (m_sharedMemory->error() == QSharedMemory::AlreadyExists)
-            {
-                if(!m_sharedMemory->attach(QSharedMemory::ReadWrite))
-                {
-                    Error(QString("Could not attach to shared memory: %1").arg(m_sharedMemory->errorString()));
-                    return;
-                }
-            }
-            else
-            {
-                Error(QString("Could not create shared memory: %1").arg(m_sharedMemory->errorString()));
-                return;
-            }
-        }
-        else
-            memset(m_sharedMemory->data(), 0, m_sharedMemory->size());
-
-        lm = static_cast<LinkedMem *>(m_sharedMemory->data());
-        if (lm == NULL)
-        {
-            m_sharedMemory->detach();
-            Error("Could not cast shared memory to struct.");
+            Error(m_mumbleLink->errorString());
             return;
         }
-        m_tryTimerId = this->startTimer(1000);
+        m_motionClock.start();
+        m_motionTimerId = this->startTimer(MOTION_TIMER_INTERVAL, Qt::PreciseTimer);
     }
     else
     {
         disconnect(Talkers::instance(),SIGNAL(ConnectStatusChanged(uint64,int,uint)),this,SLOT(onConnectStatusChanged(uint64,int,uint)));
         disconnect(universe,SIGNAL(removed(QString)),this,SLOT(onUniverseRemoved(QString)));
+        disconnect(Talkers::instance(), &Talkers::TalkStatusChanged, this, &PositionalAudio::onTalkStatusChanged);
+        m_talkBursts.clear();
         disconnect(meObj,SIGNAL(vrChanged(TsVrObj*,QString)),this,SLOT(onMyVrChanged(TsVrObj*,QString)));
         disconnect(meObj,SIGNAL(identityChanged(TsVrObj*,QString)),this,SLOT(onMyIdentityChanged(TsVrObj*,QString)));
         unlock();
-        this->killTimer(m_tryTimerId);
-        lm = NULL;
-        m_sharedMemory->detach();
+        FlushBroadcast();
+        PluginQt::instance()->m_PositionalHistory.clearState();
+        PluginQt::instance()->m_StateLink->clearPlayers();
+        m_mumbleLink->close();
+        if (m_motionTimerId != 0)
+        {
+            this->killTimer(m_motionTimerId);
+            m_motionTimerId = 0;
+        }
     }
     Log(QString("enabled: %1").arg((value)?"true":"false"));
 }
 
+//! Moves the players in my context along their dead reckoned paths
 void PositionalAudio::timerEvent(QTimerEvent *event)
 {
-    if (event->timerId() == m_fetchTimerId)
-    {
-        if (fetch())
-        {
-            if (m_fetchTimerElapsed != 0) // bool isFetchDirt =
-                return;
+    if (event->timerId() != m_motionTimerId)
+        return;
 
-            Update3DListenerAttributes();
+    FlushBroadcast();
 
-            // send the data
-            m_sendCounter++;
-            Send();
-            if (m_isDirty_IdentityUncleaned)
-                TSInfoData::instance()->RequestSelfUpdate();
-        }
-        else
-            unlock();
-    }
-    else if (event->timerId() == m_tryTimerId) // "trylock" in Mumble plugin API style
+    if (universe->getContextCount() == 0)
     {
-        m_sharedMemory->lock();
-        if ((lm->uiVersion == 1) || (lm->uiVersion == 2))
-        {
-            if (lm->dwcount != m_lastCount)
-            {
-                if (lm->description[0])
-                {
-                    QString vr_desc = QString::fromWCharArray(lm->description,2048);
-                    int nullPos = vr_desc.indexOf(QChar::Null,0);
-                    if (nullPos == -1)
-                        Error("(UpdateMyGame) game description Null Terminator not found.");
-                    else if (nullPos != 256)
-                        vr_desc.truncate(nullPos);
-
-                    meObj->setVrDescription(vr_desc);
-                }
-                else
-                    meObj->setVrDescription(QString::null);
+        m_audiblePlayers.clear();
+        m_culledPlayers.clear();
+        m_settledPlayers.clear();
+        return;
+    }
 
-                if (lm->name[0])
-                {
-                    QString myVr = QString::fromWCharArray(lm->name,256);
-                    int nullPos = myVr.indexOf(QChar::Null,0);
-                    if (nullPos == -1)
-                        Error("(UpdateMyGame) game Null Terminator not found.");
-                    else if (nullPos != 256)
-                        myVr.truncate(nullPos);
+    UpdateCulling();
 
-                    meObj->setVr(myVr);
+    if (isBinauralEnabled())    // rendered by us, keep TeamSpeak's 3D at the listener
+    {
+        m_settledPlayers.clear();
+        PublishBinauralTargets();
+        return;
+    }
 
-                    if (!myVr.isEmpty())
-                    {
-                        // Log("Found " + meObj->getVr());
-                        if (m_tryTimerId != 0)
-                        {
-                            this->killTimer(m_tryTimerId);
-                            m_tryTimerId = 0;
-                        }
-                        m_lastCount = lm->dwcount;
-                        m_fetchTimerElapsed = 0;
-                        m_fetchTimerId = this->startTimer(FETCH_TIMER_INTERVAL);
-                    }
-                }
-                else
-                    meObj->setVr(QString::null);
-            }
-        }
-        m_sharedMemory->unlock();
+    // players that stood still are set once; the ones that left the audible set were parked elsewhere
+    m_settledPlayers.intersect(m_audiblePlayers);
+    const auto kNow = m_motionClock.elapsed();
+    for (const auto &player : m_audiblePlayers)
+    {
+        const auto kHandle = universe->Find(player.first, player.second);
+        if ((kHandle == TsVrUniverse::INVALID_HANDLE) || !universe->motion(kHandle).isValid())
+            continue;
+
+        const auto &motion = universe->motion(kHandle);
+        if (!motion.isSettled(kNow))
+            m_settledPlayers.remove(player);
+        else if (m_settledPlayers.contains(player))
+            continue;
+        else
+            m_settledPlayers.insert(player);
+
+        auto position = motion.predict(kNow);
+        ts3Functions.channelset3DAttributes(player.first, player.second, &position);
     }
 }
 
-void PositionalAudio::unlock()
+//! Splits the players in my context into audible and culled ones
+/*!
+ * With attenuation and a distanceMax, players beyond it are silent anyway: the spatial grid finds the ones around the
+ * listener, only those are moved and rendered. The others are parked at CULLED_VECTOR once, where the rolloff mutes
+ * them, instead of being updated every tick. In a 100+ player channel most of the map drops out of the per tick work.
+ */
+void PositionalAudio::UpdateCulling()
 {
-    m_Context.clear();
-    m_IdentityUncleaned.clear();
-
-    if (lm)
+    m_audiblePlayers.clear();
+    const auto kPos = m_isUseCamera ? meObj->getCameraPosition() : meObj->getAvatarPosition();
+    if (!m_isUseAttenuation || (m_distanceMax <= 0))
+    {
+        for (TsVrUniverse::Handle handle = 0; handle < universe->capacity(); ++handle)
+        {
+            if (universe->isInContext(handle))
+                m_audiblePlayers.insert(qMakePair(universe->getServerConnectionHandlerID(handle), universe->getClientID(handle)));
+        }
+    }
+    else
     {
-        m_sharedMemory->lock();
-        lm->dwcount = m_lastCount = 0;
-        lm->uiVersion = 0;
-        lm->name[0] = 0;
-        lm->identity[0] = 0;
-        lm->description[0] = 0;
-        m_sharedMemory->unlock();
+        m_spatialGrid.query(kPos, (float)(m_distanceMax + CULL_MARGIN), [this](uint64 serverConnectionHandlerID, anyID clientID, const TS3_VECTOR &)
+        {
+            if (universe->isInContext(serverConnectionHandlerID, clientID))
+                m_audiblePlayers.insert(qMakePair(serverConnectionHandlerID, clientID));
+        });
     }
-    if (m_fetchTimerId != 0)
+
+    // back in range; binaural keeps TeamSpeak's 3D at the listener, otherwise the caller positions them
+    const auto isBinaural = isBinauralEnabled();
+    for (auto it = m_culledPlayers.begin(); it != m_culledPlayers.end();)
     {
-        killTimer(m_fetchTimerId);
-        m_fetchTimerId = 0;
+        if (m_audiblePlayers.contains(*it))
+        {
+            if (isBinaural)
+                ts3Functions.channelset3DAttributes(it->first, it->second, &kPos);
+            it = m_culledPlayers.erase(it);
+        }
+        else if (!universe->isInContext(it->first, it->second))
+            it = m_culledPlayers.erase(it);
+        else
+            ++it;
     }
-    if (isRunning() && m_tryTimerId == 0)
-        m_tryTimerId = this->startTimer(1000);
 
-    meObj->resetAvatar();
-    meObj->resetCamera();
+    // out of range
+    if (m_audiblePlayers.size() + m_culledPlayers.size() == universe->getContextCount())
+        return;
 
-    m_PlayersInMyContext.clear();
-    Update3DListenerAttributes();
+    for (TsVrUniverse::Handle handle = 0; handle < universe->capacity(); ++handle)
+    {
+        if (!universe->isInContext(handle))
+            continue;
 
-    meObj->setIdentityRaw(QString::null);
-    meObj->setContext(QString::null);
-    meObj->setVr(QString::null);
-    meObj->setVrDescription(QString::null);
+        const auto kPlayer = qMakePair(universe->getServerConnectionHandlerID(handle), universe->getClientID(handle));
+        if (m_audiblePlayers.contains(kPlayer) || m_culledPlayers.contains(kPlayer))
+            continue;
 
-    Send(QString::null,PluginCommandTarget_CURRENT_CHANNEL);
-    Log("Unlocked.");
+        ts3Functions.channelset3DAttributes(kPlayer.first, kPlayer.second, &CULLED_VECTOR);
+        m_culledPlayers.insert(kPlayer);
+    }
 }
 
-bool PositionalAudio::fetch()
+bool PositionalAudio::isCulled(uint64 serverConnectionHandlerID, anyID clientID) const
 {
-    m_sharedMemory->lock();
-    if ((lm->uiVersion != 1) && (lm->uiVersion != 2))
-        return false;   // -> unlock
+    return m_culledPlayers.contains(qMakePair(serverConnectionHandlerID, clientID));
+}
 
-    if (lm->dwcount == m_lastCount)
-    {
-        m_fetchTimerElapsed = m_fetchTimerElapsed + FETCH_TIMER_INTERVAL;
-//        Log(QString("fetch: elapsed: %1 timeout at: %2").arg(m_fetchTimerElapsed).arg(m_fetchTimerTimeoutMsec));
-        m_sharedMemory->unlock();
-        return !(m_fetchTimerElapsed > m_fetchTimerTimeoutMsec);    // -> unlock on false
-    }
-    m_fetchTimerElapsed = 0;
-    m_lastCount = lm->dwcount;
+void PositionalAudio::onMumbleLinkLinked(QString name, QString description)
+{
+    meObj->setVrDescription(description);
+    meObj->setVr(name);
+}
 
-//    m_Avatar_Dirty = (m_Avatar_Dirty || !((meObj->getAvatarPosition() == lm->fAvatarPosition) && (meObj->getAvatarFront() == lm->fAvatarFront) && (meObj->getAvatarTop() == lm->fAvatarTop)));
+void PositionalAudio::onMumbleLinkChanged(int fields)
+{
+    if (fields & MumbleLink::Avatar)
+        m_Avatar_Dirty = (meObj->setAvatar(m_mumbleLink->getAvatarPosition(),m_mumbleLink->getAvatarFront(),m_mumbleLink->getAvatarTop()) || m_Avatar_Dirty);
 
-    m_Avatar_Dirty = (meObj->setAvatar(lm->fAvatarPosition,lm->fAvatarFront,lm->fAvatarTop) || m_Avatar_Dirty);
+    if (fields & MumbleLink::Camera)    // legacy: mirrors the avatar
+        meObj->setCamera(m_mumbleLink->getCameraPosition(),m_mumbleLink->getCameraFront(),m_mumbleLink->getCameraTop());
 
-    if (lm->uiVersion == 2)
-    {
-        //*** Camera
-        meObj->setCamera(lm->fCameraPosition,lm->fCameraFront,lm->fCameraTop);
+    m_Context_Dirty = (fields & MumbleLink::Context);
+    if (m_Context_Dirty)
+        meObj->setContext(m_mumbleLink->getContext().toHex().data());
 
-        if (lm->context_len > 255)
-            lm->context_len = 255;
+    m_isDirty_IdentityUncleaned = (fields & MumbleLink::Identity);
+    if (m_isDirty_IdentityUncleaned)
+        meObj->setIdentityRaw(m_mumbleLink->getIdentity());
 
-        //*** Context
-        QByteArray newContext = QByteArray(reinterpret_cast<const char *>(lm->context),lm->context_len);
-        m_Context_Dirty = (m_Context != newContext);
-        m_Context = newContext;
-        if (m_Context_Dirty)
-            meObj->setContext(m_Context.toHex().data());    //m_ContextHex = m_Context.toHex().data();
+    if (fields & (MumbleLink::Avatar | MumbleLink::Camera | MumbleLink::Context))
+        Update3DListenerAttributes();
 
-        //*** Identity
-        QString newIdentity = QString::fromWCharArray(lm->identity,256);
-        m_isDirty_IdentityUncleaned = (m_IdentityUncleaned != newIdentity);
-        if (m_isDirty_IdentityUncleaned)
-        {
-            m_IdentityUncleaned = newIdentity;
-            int nullPos = newIdentity.indexOf(QChar::Null,0);
-            if (nullPos == -1)
-                Error("identity Null Terminator not found.");
-            else if (nullPos != 256)
-                newIdentity.truncate(nullPos);
-
-            meObj->setIdentityRaw(newIdentity);
-        }
-    }
-    else if (lm->uiVersion == 1)    //legacy
-    {
-        meObj->setCamera(lm->fAvatarPosition,lm->fAvatarFront,lm->fAvatarTop);
-
-        m_Context.clear();
-        //m_ContextHex.clear();
-        m_Context_Dirty = false;
-        meObj->setContext(QString::null);
-        m_IdentityUncleaned.clear();
-        m_isDirty_IdentityUncleaned = false;
-        meObj->setIdentityRaw(QString::null);
-    }
+    // send the data
+    Send();
+    if (m_isDirty_IdentityUncleaned)
+        TSInfoData::instance()->RequestSelfUpdate();
+}
 
-    m_sharedMemory->unlock();
-    return true;
+void PositionalAudio::unlock()
+{
+    m_mumbleLink->reset();
+
+    meObj->resetAvatar();
+    meObj->resetCamera();
+
+    universe->clearContext();
+    m_audiblePlayers.clear();
+    m_culledPlayers.clear();
+    m_settledPlayers.clear();
+    Update3DListenerAttributes();
+
+    meObj->setIdentityRaw(QString::null);
+    meObj->setContext(QString::null);
+    meObj->setVr(QString::null);
+    meObj->setVrDescription(QString::null);
+
+    Send(QString::null,PluginCommandTarget_CURRENT_CHANNEL);
+    Log("Unlocked.");
 }
 
 bool PositionalAudio::onPluginCommand(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QString cmd, QTextStream &args)
 {
+    if (cmd == "3DB")
+        return onPluginCommandWire(serverConnectionHandlerID, clientID, isMe, args);
+
+    if (cmd == "3DV")
+        return onPluginCommandWireVersion(serverConnectionHandlerID, clientID, isMe, args);
+
     if (cmd != "3D")
         return false;
 
@@ -710,27 +878,26 @@ bool PositionalAudio::onPluginCommand(uint64 serverConnectionHandlerID, anyID cl
         return true;
     }
 
-    auto obj = universe->Get(serverConnectionHandlerID,clientID);
-    if (!obj)
+    auto handle = universe->Find(serverConnectionHandlerID,clientID);
+    if (handle == TsVrUniverse::INVALID_HANDLE)
     {
-        obj = universe->Add(serverConnectionHandlerID,clientID);
+        handle = universe->Add(serverConnectionHandlerID,clientID);
         m_IsSendAllOverride = true;
     }
 
     if (args.atEnd())   // Player left vr (unlocked)
     {
-        Log(QString("%1 left %2 VR.").arg(obj->getIdentity()).arg(obj->getVr()));
+        Log(QString("%1 left %2 VR.").arg(universe->getIdentity(handle)).arg(universe->getVr(handle)));
         universe->Remove(serverConnectionHandlerID,clientID);
-        m_PlayersInMyContext.remove(serverConnectionHandlerID,clientID);
+        m_spatialGrid.remove(serverConnectionHandlerID,clientID);
         return true;
     }
 
-    //args >> obj->avatarPosition >> obj->avatarFront >> obj->avatarTop;
     TS3_VECTOR avatarPosition;
     TS3_VECTOR avatarFront;
     TS3_VECTOR avatarTop;
     args >> avatarPosition >> avatarFront >> avatarTop;
-    obj->setAvatar(avatarPosition, avatarFront, avatarTop);
+    universe->setAvatar(handle, avatarPosition, avatarFront, avatarTop);
 
     if (!args.atEnd())
     {
@@ -741,8 +908,7 @@ bool PositionalAudio::onPluginCommand(uint64 serverConnectionHandlerID, anyID cl
         auto list = args_stri.split("[Ct_Delimiter]",QString::KeepEmptyParts,Qt::CaseSensitive);    // keep empty parts?
         auto name = list.at(0);
 
-        auto isDirtyName = (name != obj->getVr());
-        obj->setVr(name);
+        auto isDirtyName = universe->setVr(handle, name);
         auto isDirtyContext = false;
         auto isDirtyId = false;
 
@@ -753,30 +919,15 @@ bool PositionalAudio::onPluginCommand(uint64 serverConnectionHandlerID, anyID cl
 
             QString context;
             in >> context;
-            isDirtyContext = (context != obj->getContext());
-            obj->setContext(context);
+            isDirtyContext = universe->setContext(handle, context);
 
             auto identity = in.readAll().trimmed();
-            isDirtyId = (identity != obj->getIdentityRaw());
-            obj->setIdentityRaw(identity);
+            isDirtyId = universe->setIdentityRaw(handle, identity);
 
             Log(QString("Received: VR: %2 CO: %3 ID: %4").arg(name).arg((context == meObj->getContext())?"match":"no match").arg(identity), serverConnectionHandlerID, LogLevel_DEBUG);
 
             if (isDirtyName || isDirtyContext)
-            {
-                if (meObj->getVr() == obj->getVr())
-                {
-                    if (obj->getContext() == meObj->getContext())
-                    {
-                        if (!m_PlayersInMyContext.contains(serverConnectionHandlerID,clientID))
-                            m_PlayersInMyContext.insert(serverConnectionHandlerID,clientID);
-                    }
-                    else if (m_PlayersInMyContext.contains(serverConnectionHandlerID,clientID))
-                        m_PlayersInMyContext.remove(serverConnectionHandlerID,clientID);
-                }
-                else
-                    m_PlayersInMyContext.remove(serverConnectionHandlerID,clientID);
-            }
+                universe->setInContext(handle, (universe->getVrId(handle) == universe->intern(meObj->getVr())) && (universe->getContextId(handle) == universe->intern(meObj->getContext())));
         }
         else    //version 1
         {
@@ -785,19 +936,129 @@ bool PositionalAudio::onPluginCommand(uint64 serverConnectionHandlerID, anyID cl
 
         if (isDirtyName || isDirtyContext || isDirtyId)
             TSInfoData::instance()->RequestUpdate(serverConnectionHandlerID,clientID);
+
+        if ((universe->getWireVersion(handle) == 0) && !universe->isWireVersionSent(handle))
+            SendWireVersion(handle);
     }
 
-    if (m_PlayersInMyContext.contains(serverConnectionHandlerID,clientID))
+    onAvatarReceived(handle);
+    return true;
+}
+
+//! Avatar update in the compact encoding, see PositionalWire
+bool PositionalAudio::onPluginCommandWire(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QTextStream &args)
+{
+    if (isMe)
+        return true;
+
+    const auto kHandle = universe->Find(serverConnectionHandlerID,clientID);
+    if (kHandle == TsVrUniverse::INVALID_HANDLE)
+        return true;    // their next full text update introduces them
+
+    QString payload;
+    args >> payload;
+    if (!PositionalWire::Decode(payload.toLatin1(), universe->wireFrame(kHandle)))
+        return true;    // missed a frame, waiting for the next key frame
+
+    TS3_VECTOR avatarPosition;
+    TS3_VECTOR avatarFront;
+    TS3_VECTOR avatarTop;
+    PositionalWire::Dequantise(universe->wireFrame(kHandle), avatarPosition, avatarFront, avatarTop);
+    universe->setAvatar(kHandle, avatarPosition, avatarFront, avatarTop);
+
+    onAvatarReceived(kHandle);
+    return true;
+}
+
+//! Negotiation: "3DV <version>" is exchanged once per pair of clients; old ones reject the unknown command
+bool PositionalAudio::onPluginCommandWireVersion(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QTextStream &args)
+{
+    if (isMe)
+        return true;
+
+    auto handle = universe->Find(serverConnectionHandlerID,clientID);
+    if (handle == TsVrUniverse::INVALID_HANDLE)
     {
-        auto vector = obj->getAvatarPosition();
-        ts3Functions.channelset3DAttributes(serverConnectionHandlerID,clientID,&vector);
+        handle = universe->Add(serverConnectionHandlerID,clientID);
+        m_IsSendAllOverride = true;
     }
 
-    auto sendString = GetSendStringJson(true,false,obj);
-    emit BroadcastJSON(sendString);
+    int version = 0;
+    args >> version;
+    universe->setWireVersion(handle, qMin(version, PositionalWire::VERSION));
+    if (!universe->isWireVersionSent(handle))
+        SendWireVersion(handle);
+
+    return true;
+}
+
+void PositionalAudio::SendWireVersion(TsVrUniverse::Handle handle)
+{
+    const anyID targetIDs[2] = {universe->getClientID(handle), 0};
+    SendCommand(universe->getServerConnectionHandlerID(handle), "3DV", QString::number(PositionalWire::VERSION), PluginCommandTarget_CLIENT, targetIDs, NULL);
+    universe->setWireVersionSent(handle, true);
+}
+
+//! Splits the members of my channel by the avatar encoding they get
+/*!
+ * Text is the default: "3DB" only goes to those who advertised our wire version through "3DV". Everybody else
+ * in the channel, old plugin versions and clients not running the plugin alike, keeps getting "3D".
+ * \brief PositionalAudio::GetAvatarTargets Helper function
+ * \param serverConnectionHandlerID the connection id of the server
+ * \param wireTargets receives the clients agreed on the wire version
+ * \param textTargets receives the other clients of my channel
+ * \return false if the channel members couldn't be listed; send text to the channel then
+ */
+bool PositionalAudio::GetAvatarTargets(uint64 serverConnectionHandlerID, QVector<anyID> &wireTargets, QVector<anyID> &textTargets)
+{
+    unsigned int error;
+    anyID myID;
+    if ((error = ts3Functions.getClientID(serverConnectionHandlerID, &myID)) != ERROR_ok)
+    {
+        Error("(GetAvatarTargets)", serverConnectionHandlerID, error);
+        return false;
+    }
+
+    uint64 channelID;
+    if ((error = ts3Functions.getChannelOfClient(serverConnectionHandlerID, myID, &channelID)) != ERROR_ok)
+    {
+        Error("(GetAvatarTargets)", serverConnectionHandlerID, error);
+        return false;
+    }
+
+    anyID* clients;
+    if ((error = ts3Functions.getChannelClientList(serverConnectionHandlerID, channelID, &clients)) != ERROR_ok)
+    {
+        Error("(GetAvatarTargets)", serverConnectionHandlerID, error);
+        return false;
+    }
+
+    for (auto client = clients; *client != (anyID)NULL; ++client)
+    {
+        if (*client == myID)
+            continue;
+
+        const auto kHandle = universe->Find(serverConnectionHandlerID, *client);
+        if ((kHandle != TsVrUniverse::INVALID_HANDLE) && (universe->getWireVersion(kHandle) == PositionalWire::VERSION))
+            wireTargets.append(*client);
+        else
+            textTargets.append(*client);
+    }
+    ts3Functions.freeMemory(clients);
     return true;
 }
 
+//! Positions in 3D are set at the motion timer's rate, see timerEvent
+void PositionalAudio::onAvatarReceived(TsVrUniverse::Handle handle)
+{
+    universe->motion(handle).update(universe->getAvatarPosition(handle), m_motionClock.elapsed());
+    m_spatialGrid.update(universe->getServerConnectionHandlerID(handle), universe->getClientID(handle), universe->getAvatarPosition(handle));
+
+    auto sendString = GetSendStringJson(true,false,handle);
+    if (!sendString.isEmpty())
+        m_broadcastBatch.post(universe->getClientUID(handle), sendString);
+}
+
 QString PositionalAudio::GetSendString(bool isAll)
 {
     // Bulk version
@@ -812,7 +1073,7 @@ QString PositionalAudio::GetSendString(bool isAll)
 //        out << " " << m_GameName;
         out << " " << meObj->getVr();
 
-        if (lm->uiVersion == 2)
+        if (m_mumbleLink->getVersion() == 2)
         {
 //            out << "[Ct_Delimiter]" << (m_ContextHex.isEmpty()?"[Ct_None]":m_ContextHex);
             auto myContext = meObj->getContext();
@@ -825,18 +1086,15 @@ QString PositionalAudio::GetSendString(bool isAll)
     return out_stri;
 }
 
-QString PositionalAudio::GetSendStringJson(bool isAll, bool isMe, TsVrObj* obj)
+QString PositionalAudio::GetSendStringJson(bool isAll, bool isMe, TsVrUniverse::Handle handle)
 {
-    if (isMe)
-        obj = meObj;
-
     QString out_stri;
     QTextStream out(&out_stri);
     out << "{";
-    auto vec = obj->getAvatarPosition();
+    auto vec = isMe ? meObj->getAvatarPosition() : universe->getAvatarPosition(handle);
     out << "\"px\":" << INCHTOM(vec.x) << "," << "\"pz\":" << INCHTOM(vec.z) << ",";// << "\"ap_z\":" << vec.z << ",";
 
-    vec = obj->getAvatarFront();
+    vec = isMe ? meObj->getAvatarFront() : universe->getAvatarFront(handle);
 
     int front = atan2(vec.z, vec.x)*180/M_PI;
     if (front <0)
@@ -848,7 +1106,7 @@ QString PositionalAudio::GetSendStringJson(bool isAll, bool isMe, TsVrObj* obj)
 
     if (isAll)
     {
-        auto ident = obj->getIdentityRaw();
+        auto ident = isMe ? meObj->getIdentityRaw() : universe->getIdentityRaw(handle);
         if (ident.isEmpty())
         {
             Log("ident is empty!",LogLevel_INFO);   //fixed with >1.5.0
@@ -861,20 +1119,11 @@ QString PositionalAudio::GetSendStringJson(bool isAll, bool isMe, TsVrObj* obj)
 
         if (!isMe)
         {
-            auto iObj = qobject_cast<TsVrObjOther *>(obj);
-            if (iObj)
-            {
-                unsigned int error;
-                char name[512];
-                auto serverConnectionHandlerID = iObj->getServerConnectionHandlerID();
-                auto clientID = iObj->getClientID();
-                if((error = ts3Functions.getClientDisplayName(serverConnectionHandlerID, clientID, name, 512)) != ERROR_ok)
-                    Error("(GetSendStringJson)",serverConnectionHandlerID,error);
-                else
-                    out << "\"vcname\":\"" << name << "\",";
+            auto name = universe->getDisplayNameJson(handle);
+            if (!name.isEmpty())
+                out << "\"vcname\":\"" << name << "\",";
 
-                out << "\"uid\":\"" << iObj->getClientUID() << "\",";
-            }
+            out << "\"uid\":\"" << universe->getClientUID(handle) << "\",";
         }
     }
     else
@@ -886,6 +1135,11 @@ QString PositionalAudio::GetSendStringJson(bool isAll, bool isMe, TsVrObj* obj)
 
 //! Non-throttled DoSend
 void PositionalAudio::Send(uint64 serverConnectionHandlerID, QString args, int targetMode, const anyID *targetIDs, const char *returnCode)
+{
+    SendCommand(serverConnectionHandlerID, "3D", args, targetMode, targetIDs, returnCode);
+}
+
+void PositionalAudio::SendCommand(uint64 serverConnectionHandlerID, QString command, QString args, int targetMode, const anyID *targetIDs, const char *returnCode)
 {
     unsigned int error;
 
@@ -909,9 +1163,9 @@ void PositionalAudio::Send(uint64 serverConnectionHandlerID, QString args, int t
     QString cmd;
     QTextStream str(&cmd);
     if (args.isEmpty())
-        str << myID << " 3D";   // left game (unlocked)
+        str << myID << " " << command;   // 3D: left game (unlocked)
     else
-        str << myID << " 3D " << args;
+        str << myID << " " << command << " " << args;
 
 //    Log(QString("Sending: %1").arg(cmd),serverConnectionHandlerID,LogLevel_DEBUG);
 //    returnCode = m_SendReturnCodeC;
@@ -986,14 +1240,31 @@ void PositionalAudio::Send(QString args, int targetMode)
                     vec.append((anyID)0);
                     Send(*server, args, targetMode, vec.constData(), NULL);
                 }*/
-                Send(*server, args, PluginCommandTarget_CURRENT_CHANNEL, NULL, NULL);
+                QVector<anyID> wireTargets;
+                QVector<anyID> textTargets;
+                if (!GetAvatarTargets(*server, wireTargets, textTargets))
+                    Send(*server, args, PluginCommandTarget_CURRENT_CHANNEL, NULL, NULL);
+                else
+                {
+                    if (!textTargets.isEmpty())
+                    {
+                        textTargets.append(0);
+                        Send(*server, args, PluginCommandTarget_CLIENT, textTargets.constData(), NULL);
+                    }
+                    if (!wireTargets.isEmpty())
+                    {
+                        wireTargets.append(0);
+                        auto frame = PositionalWire::Quantise(meObj->getAvatarPosition(), meObj->getAvatarFront(), meObj->getAvatarTop());
+                        SendCommand(*server, "3DB", PositionalWire::Encode(frame, m_SentWireFrames[*server]), PluginCommandTarget_CLIENT, wireTargets.constData(), NULL);
+                    }
+                }
             }
             else
                 Send(*server, args, targetMode, NULL, NULL);
         }
         ts3Functions.freeMemory(servers);
     }
-    m_sendCounter = 0;
+    m_sendThrottle.start();
 }
 
 void PositionalAudio::Send()
@@ -1014,15 +1285,16 @@ void PositionalAudio::Send()
             m_Context_Dirty = false;
             m_isDirty_IdentityUncleaned = false;
             Send(args,PluginCommandTarget_CURRENT_CHANNEL);
+            m_SentWireFrames.clear();   // newcomers need a key frame
 
-            args = GetSendStringJson(true,true,NULL);
+            args = GetSendStringJson(true,true,TsVrUniverse::INVALID_HANDLE);
             if (!args.isEmpty())
-                emit BroadcastJSON(args);
+                m_broadcastBatch.post(QStringLiteral("me"), args);
         }
 
 
     }
-    else if (m_sendCounter > SEND_THROTTLE_GLOBAL)    //was: 50
+    else if (!m_sendThrottle.isValid() || m_sendThrottle.hasExpired(SEND_THROTTLE_MSEC))
     {
         m_silentSendCounter++;
         if (m_Avatar_Dirty)
@@ -1032,9 +1304,9 @@ void PositionalAudio::Send()
             {
                 m_Avatar_Dirty = false;
                 Send(args,PluginCommandTarget_CLIENT);
-                args = GetSendStringJson(true,true,NULL);
+                args = GetSendStringJson(true,true,TsVrUniverse::INVALID_HANDLE);
                 if (!args.isEmpty())
-                    emit BroadcastJSON(args);
+                    m_broadcastBatch.post(QStringLiteral("me"), args);
             }
         }
     }
@@ -1045,8 +1317,11 @@ void PositionalAudio::Update3DListenerAttributes()
     uint64* servers;
     if(ts3Functions.getServerConnectionHandlerList(&servers) == ERROR_ok)
     {
-        auto myVr = meObj->getVr();
-        auto myContext = meObj->getContext();
+        const auto kMyVrId = universe->intern(meObj->getVr());
+        const auto kMyContextId = universe->intern(meObj->getContext());
+        const auto isBinaural = isBinauralEnabled();
+        if (m_Context_Dirty)
+            universe->clearContext();
         for(auto server = servers; *server != (uint64)NULL; ++server)
         {
             int status;
@@ -1082,22 +1357,14 @@ void PositionalAudio::Update3DListenerAttributes()
                         Error("(Update3DListenerAttributes)", *server, error);
                     else
                     {
-                        if (m_Context_Dirty)
-                            m_PlayersInMyContext.clear();
-
                         for(int i=0; clients[i]; i++)
                         {
-                            if (m_Context_Dirty)    // Refill m_PlayersInMyContext
-                            {
-                                if (universe->Contains(*server,clients[i]))
-                                {
-                                    TsVrObj* obj = universe->Get(*server,clients[i]);
-                                    if ((myVr == obj->getVr()) && (myContext == obj->getContext()))
-                                        m_PlayersInMyContext.insert(*server,clients[i]);
-                                }
-                            }
-
-                            if (!m_PlayersInMyContext.contains(*server,clients[i]))
+                            const auto kHandle = universe->Find(*server,clients[i]);
+                            if (m_Context_Dirty && (kHandle != TsVrUniverse::INVALID_HANDLE))    // Refill my context
+                                universe->setInContext(kHandle, (universe->getVrId(kHandle) == kMyVrId) && (universe->getContextId(kHandle) == kMyContextId));
+
+                            const auto kIsInContext = (kHandle != TsVrUniverse::INVALID_HANDLE) && universe->isInContext(kHandle);
+                            if (!kIsInContext || (isBinaural && !isCulled(*server,clients[i])))
                                 ts3Functions.channelset3DAttributes(*server,clients[i],&pos);
                         }
                     }
@@ -1106,6 +1373,48 @@ void PositionalAudio::Update3DListenerAttributes()
         }
         ts3Functions.freeMemory(servers);
     }
+    PublishBinauralTargets();
+}
+
+void PositionalAudio::PublishBinauralTargets()
+{
+    auto renderer = m_binauralRenderer.load();
+    if (!renderer || !isBinauralEnabled())
+        return;
+
+    const auto kPos   = m_isUseCamera ? meObj->getCameraPosition() : meObj->getAvatarPosition();
+    const auto kFront = m_isUseCamera ? meObj->getCameraFront() : meObj->getAvatarFront();
+    const auto kTop   = m_isUseCamera ? meObj->getCameraTop() : meObj->getAvatarTop();
+
+    // MumbleLink is left handed: right = top x front
+    TS3_VECTOR right;
+    right.x = (kTop.y * kFront.z) - (kTop.z * kFront.y);
+    right.y = (kTop.z * kFront.x) - (kTop.x * kFront.z);
+    right.z = (kTop.x * kFront.y) - (kTop.y * kFront.x);
+
+    const auto kNow = m_motionClock.elapsed();
+    auto& targets = renderer->targets();
+    targets.count = 0;
+    for (auto it = m_audiblePlayers.constBegin(); (it != m_audiblePlayers.constEnd()) && (targets.count < BinauralTargets::CAPACITY); ++it)
+    {
+        const auto kHandle = universe->Find(it->first, it->second);
+        if ((kHandle == TsVrUniverse::INVALID_HANDLE) || !universe->isInContext(kHandle))
+            continue;
+
+        const auto& motion = universe->motion(kHandle);
+        const auto kPosition = motion.isValid() ? motion.predict(kNow) : universe->getAvatarPosition(kHandle);
+        const auto kX = kPosition.x - kPos.x;
+        const auto kY = kPosition.y - kPos.y;
+        const auto kZ = kPosition.z - kPos.z;
+
+        auto& target = targets.targets[targets.count++];
+        target.serverConnectionHandlerID = it->first;
+        target.clientID = it->second;
+        target.azimuth = atan2f((kX * right.x) + (kY * right.y) + (kZ * right.z), (kX * kFront.x) + (kY * kFront.y) + (kZ * kFront.z)) * (180.0f / M_PI);
+        target.gain = m_isUseAttenuation ? m_rolloffCurve.volume(sqrtf((kX * kX) + (kY * kY) + (kZ * kZ))) : 1.0f;
+        target.talkBurst = m_talkBursts.value(*it);
+    }
+    renderer->publishTargets();
 }
 
 void PositionalAudio::onConnectStatusChanged(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber)
@@ -1125,8 +1434,16 @@ void PositionalAudio::onConnectStatusChanged(uint64 serverConnectionHandlerID, i
     else if (newStatus == STATUS_DISCONNECTED)
     {
         universe->Remove(serverConnectionHandlerID);
-        m_PlayersInMyContext.remove(serverConnectionHandlerID);
+        m_spatialGrid.remove(serverConnectionHandlerID);
         m_SendCounters.remove(serverConnectionHandlerID);
+        m_SentWireFrames.remove(serverConnectionHandlerID);
+        for (auto it = m_talkBursts.begin(); it != m_talkBursts.end();)
+        {
+            if (it.key().first == serverConnectionHandlerID)
+                it = m_talkBursts.erase(it);
+            else
+                ++it;
+        }
     }
 }
 
@@ -8,6 +8,13 @@
 #include "../ts_infodata_qt.h"
 //#include "../ts_context_menu_qt.h"
 #include "definitions_positionalaudio.h"
+#include "binaural_renderer.h"
+#include "../speaker_routing.h"
+#include "mumble_link.h"
+#include "spatial_grid.h"
+#include "rolloff_curve.h"
+#include "../triple_buffer.h"
+#include "json_batch.h"
 
 #ifndef RETURNCODE_BUFSIZE
 #define RETURNCODE_BUFSIZE 128
@@ -27,19 +34,24 @@ class PositionalAudio : public Module, public InfoDataInterface//, public Contex
                READ isUseCamera
                WRITE setUseCamera
                NOTIFY useCameraChanged)
+    Q_PROPERTY(bool binauralEnabled READ isBinauralEnabled WRITE setBinauralEnabled NOTIFY binauralEnabledChanged)
     Q_PROPERTY(bool useAttenuation READ isUseAttenuation WRITE setUseAttenuation NOTIFY useAttenuationChanged)
     Q_PROPERTY(int distanceMin READ getDistanceMin WRITE setDistanceMin NOTIFY distanceMinChanged)
     Q_PROPERTY(int distanceMax READ getDistanceMax WRITE setDistanceMax NOTIFY distanceMaxChanged)
     Q_PROPERTY(float rollOff READ getRollOff WRITE setRollOff NOTIFY rollOffChanged)
     Q_PROPERTY(float rollOffMax READ getRollOffMax WRITE setRollOffMax NOTIFY rollOffMaxChanged)
+    Q_PROPERTY(int rollOffModel READ getRollOffModel WRITE setRollOffModel NOTIFY rollOffModelChanged)
+    Q_PROPERTY(QString rollOffSpline READ getRollOffSpline WRITE setRollOffSpline NOTIFY rollOffSplineChanged)
 
 public:
     explicit PositionalAudio(QObject *parent = 0);
+    ~PositionalAudio();
 
     // events forwarded from plugin.cpp
     bool onPluginCommand(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QString cmd, QTextStream &args);
     void onClientMoveEvent(uint64 serverConnectionHandlerID, anyID clientID, uint64 oldChannelID, uint64 newChannelID, int visibility, anyID myID);
     void onCustom3dRolloffCalculationClientEvent(uint64 serverConnectionHandlerID, anyID clientID, float distance, float* volume);
+    bool onEditPostProcessVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels, const unsigned int* channelSpeakerArray, unsigned int* channelFillMask);
 
     //Properties
     QString getMyVr() const;
@@ -50,13 +62,16 @@ public:
 //    int onServerErrorEvent(uint64 serverConnectionHandlerID, const char* errorMessage, unsigned int error, const char* returnCode, const char* extraMessage);
 
     bool isUseCamera() const;
+    bool isBinauralEnabled() const;
     bool isUseAttenuation() const;
     int getDistanceMin() const;
     int getDistanceMax() const;
     float getRollOff() const;
     float getRollOffMax() const;
+    int getRollOffModel() const;
+    QString getRollOffSpline() const;
 
-    bool isPositioned(anyID clientID) const;
+    bool isPositioned(uint64 serverConnectionHandlerID, anyID clientID);   // playback thread
 
     QMap<QString,PositionalAudio_ServerSettings> getServerSettings() const;
 
@@ -67,23 +82,30 @@ signals:
     void myVrChanged(QString);
     void myIdentityChanged(QString);
     void useCameraChanged(bool);
+    void binauralEnabledChanged(bool);
     void useAttenuationChanged(bool);
     void distanceMinChanged(int);
     void distanceMaxChanged(int);
     void rollOffChanged(float);
     void rollOffMaxChanged(float);
+    void rollOffModelChanged(int);
+    void rollOffSplineChanged(QString);
     void serverBlock(QString);
 
-    void BroadcastJSON(QString);
+    void BroadcastJSON(QByteArray, QString);    // UTF-8 JSON object and its player's key, at most one per player and motion tick
+    void BroadcastJSONText(QString);    // the same, for transports that take text
 
 public slots:
     void onConnectStatusChanged(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber);
     void setUseCamera(bool val);
+    void setBinauralEnabled(bool val);
     void setUseAttenuation(bool val);
     void setDistanceMin(int val);
     void setDistanceMax(int val);
     void setRollOff(float val);
     void setRollOffMax(float val);
+    void setRollOffModel(int val);
+    void setRollOffSpline(QString val);
 
     void AddServerSetting(QString serverUniqueId, QString serverName);
     void RemoveServerSetting(QString serverUniqueId, QString serverName);
@@ -96,67 +118,90 @@ public slots:
     void onMyIdentityChanged(TsVrObj* obj, QString val);
 
     void onUniverseRemoved(QString clientUID);
+    void onClientDisplayNameChanged(uint64 serverConnectionHandlerID, anyID clientID, const char *displayName);
+    void onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe);
 
 protected:
     void onRunningStateChanged(bool value);
     void timerEvent(QTimerEvent *event);
 
-private:
+private slots:
+    void onMumbleLinkLinked(QString name, QString description);
+    void onMumbleLinkChanged(int fields);
     void unlock();
-    bool trylock();
-    bool fetch();
 
-    int m_tryTimerId = 0;
+private:
+    MumbleLink* m_mumbleLink;
+
+    QElapsedTimer m_motionClock;
+    int m_motionTimerId = 0;
+    static const int MOTION_TIMER_INTERVAL = 25;    // remote avatars move at 40Hz locally, whatever their send rate
+    static const int CULL_MARGIN = 10;              // units beyond distanceMax; covers extrapolation past the last received position
 
-    int m_fetchTimerId = 0;
-    static const int FETCH_TIMER_INTERVAL = 20; //Mumble fetches these values 50 times a second aka 20msec
-    static const int SEND_THROTTLE_GLOBAL = 5;  // Send(): 50times/sec; count to 5 -> 10times/sec; save some computation
-    static const int SEND_INTERVAL_MODIFIER = 50 / SEND_THROTTLE_GLOBAL;    // I...think.
-    int m_fetchTimerElapsed = 0;
-    int m_fetchTimerTimeoutMsec = 5000;
+    static const int SEND_THROTTLE_MSEC = 100;  // Send(): on every game tick; avatar updates at most 10times/sec; save some computation
+    static const int SEND_INTERVAL_MODIFIER = 1000 / SEND_THROTTLE_MSEC;    // I...think.
 
     // myself
     //QString m_Identity;
-    QString m_IdentityUncleaned;
     bool m_isDirty_IdentityUncleaned = false;
-    QByteArray m_Context;
     //QString m_ContextHex;
     bool m_Context_Dirty = false;
     bool m_Avatar_Dirty = false;
 
-    ulong m_lastCount = 0;
-
-    QMultiMap<uint64,anyID> m_PlayersInMyContext;
+    SpatialGrid m_spatialGrid;                          // all remote avatars, by last received position
+    QSet<QPair<uint64,anyID> > m_audiblePlayers;        // in my context and in range, refreshed by UpdateCulling
+    QSet<QPair<uint64,anyID> > m_culledPlayers;         // in my context, parked at CULLED_VECTOR
+    QSet<QPair<uint64,anyID> > m_settledPlayers;        // audible, set to their settled position already
+    QHash<QPair<uint64,anyID>,quint32> m_talkBursts;    // ended talk bursts per player, see BinauralTarget::talkBurst
 
     TsVrUniverse* universe;
 
     void Update3DListenerAttributes();
+    void PublishBinauralTargets();
+    void UpdateCulling();
+    bool isCulled(uint64 serverConnectionHandlerID, anyID clientID) const;
+    void UpdateRolloffCurve();
+    void FlushBroadcast();
+    void PublishPlayers();
 
     bool m_isUseCamera = true;
+    QAtomicInt m_isBinauralEnabled;                         // read by the playback thread
+    QAtomicPointer<BinauralRenderer> m_binauralRenderer;    // created on first enable, lives until destruction
+    SpeakerRouting m_speakerRouting;                        // post process callback only
     bool m_isUseAttenuation = false;
     int m_distanceMin = 0;
     int m_distanceMax = 0;
     float m_rollOff = 0.0f;
     float m_rollOffMax = 0.0f;
-    //float m_rollOff_Lin;
-    float m_rollOffMax_Lin = 1.0f;
+    int m_rollOffModel = RolloffCurve::Logarithmic;
+    QVector<QPointF> m_rollOffSpline;
+    RolloffCurve m_rolloffCurve;    // gui thread; rebuilt by UpdateRolloffCurve when any of the above changes
+    TripleBuffer<RolloffCurve> m_publishedRolloffCurve;    // copies of it, for the rolloff callback
 
     QString GetSendString(bool isAll);
-    QString GetSendStringJson(bool isAll, bool isMe, TsVrObj *obj);
+    QString GetSendStringJson(bool isAll, bool isMe, TsVrUniverse::Handle handle);
     void Send(uint64 serverConnectionHandlerID, QString args, int targetMode, const anyID *targetIDs, const char *returnCode);
+    void SendCommand(uint64 serverConnectionHandlerID, QString command, QString args, int targetMode, const anyID *targetIDs, const char *returnCode);
+    void SendWireVersion(TsVrUniverse::Handle handle);
+    bool GetAvatarTargets(uint64 serverConnectionHandlerID, QVector<anyID> &wireTargets, QVector<anyID> &textTargets);
     void Send();
     void Send(QString args, int targetMode);
 
     bool m_IsSendAllOverride = true;
-    int m_sendCounter = 0;
+    QElapsedTimer m_sendThrottle;
     int m_silentSendCounter = 2;
 
     TS3_VECTOR NULL_VECTOR;
-
-    QSharedMemory* m_sharedMemory = nullptr;
+    TS3_VECTOR CULLED_VECTOR;   // out of any distanceMax
 
     QMap<QString,PositionalAudio_ServerSettings> m_ServerSettings;
     QHash<uint64,int> m_SendCounters;
+    QHash<uint64,PositionalWire::Frame> m_SentWireFrames;   // last "3DB" frame per server tab
+    JsonBatch m_broadcastBatch;                             // flushed by the motion timer
+
+    bool onPluginCommandWire(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QTextStream &args);
+    bool onPluginCommandWireVersion(uint64 serverConnectionHandlerID, anyID clientID, bool isMe, QTextStream &args);
+    void onAvatarReceived(TsVrUniverse::Handle handle);
 };
 QTextStream &operator<<(QTextStream &out, const TS3_VECTOR &ts3Vector);
 QTextStream &operator>>(QTextStream &in, TS3_VECTOR &ts3Vector);
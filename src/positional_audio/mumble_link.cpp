@@ -0,0 +1,294 @@
+#include "mumble_link.h"
+
+#include <QTimerEvent>
+#include <atomic>
+#include <string.h>
+
+struct LinkedMem {
+    quint32 uiVersion;              //win:UINT32;posix:uint32_t
+    ulong   dwcount;                //win:DWORD;posix:uint32_t  - uiTick in Mumble's terms
+    float	fAvatarPosition[3];
+    float	fAvatarFront[3];
+    float	fAvatarTop[3];
+    wchar_t	name[256];
+    float	fCameraPosition[3];
+    float	fCameraFront[3];
+    float	fCameraTop[3];
+    wchar_t	identity[256];
+    quint32 context_len;            //win:UINT32;posix:uint32_t
+    unsigned char context[256];
+    wchar_t description[2048];
+};
+
+const int READ_RETRIES = 3;
+const quint32 CONTEXT_LENGTH_MAX = 255;
+const float PERIOD_SMOOTHING = 0.2f;
+
+// the game writes these concurrently
+static quint32 loadCount(const LinkedMem* lm)
+{
+    return *static_cast<const volatile ulong*>(&lm->dwcount);
+}
+
+static quint32 loadVersion(const LinkedMem* lm)
+{
+    return *static_cast<const volatile quint32*>(&lm->uiVersion);
+}
+
+static QString fromWChars(const wchar_t* chars, int size)
+{
+    auto length = 0;
+    while ((length < size) && chars[length])
+        ++length;
+    return QString::fromWCharArray(chars, length);
+}
+
+MumbleLink::MumbleLink(QObject *parent)
+    : QObject(parent)
+{
+    memset(&m_state, 0, sizeof(m_state));
+    memset(&m_read, 0, sizeof(m_read));
+}
+
+bool MumbleLink::open()
+{
+    if (m_lm)
+        return true;
+
+    if (!m_sharedMemory)
+    {
+        m_sharedMemory = new QSharedMemory(this);
+        m_sharedMemory->setNativeKey("MumbleLink");
+    }
+
+    if (!m_sharedMemory->create(sizeof(LinkedMem),QSharedMemory::ReadWrite))
+    {
+        if (m_sharedMemory->error() != QSharedMemory::AlreadyExists)
+        {
+            m_errorString = QString("Could not create shared memory: %1").arg(m_sharedMemory->errorString());
+            return false;
+        }
+        if (!m_sharedMemory->attach(QSharedMemory::ReadWrite))
+        {
+            m_errorString = QString("Could not attach to shared memory: %1").arg(m_sharedMemory->errorString());
+            return false;
+        }
+    }
+    else
+        memset(m_sharedMemory->data(), 0, m_sharedMemory->size());
+
+    m_lm = static_cast<LinkedMem *>(m_sharedMemory->data());
+    if (!m_lm)
+    {
+        m_sharedMemory->detach();
+        m_errorString = "Could not cast shared memory to struct.";
+        return false;
+    }
+
+    m_lastCount = 0;
+    setLinked(false);
+    return true;
+}
+
+void MumbleLink::close()
+{
+    if (m_timerId != 0)
+    {
+        killTimer(m_timerId);
+        m_timerId = 0;
+        m_interval = 0;
+    }
+    m_isLinked = false;
+
+    if (!m_lm)
+        return;
+
+    m_lm = nullptr;
+    m_sharedMemory->detach();
+}
+
+void MumbleLink::reset()
+{
+    if (!m_lm)
+        return;
+
+    m_lm->dwcount = m_lastCount = 0;
+    m_lm->uiVersion = 0;
+    m_lm->name[0] = 0;
+    m_lm->identity[0] = 0;
+    m_lm->description[0] = 0;
+
+    m_version = 0;
+    memset(&m_state, 0, sizeof(m_state));
+    setLinked(false);
+}
+
+QByteArray MumbleLink::getContext() const
+{
+    return QByteArray(reinterpret_cast<const char *>(m_state.context), m_state.contextLength);
+}
+
+QString MumbleLink::getIdentity() const
+{
+    return QString::fromWCharArray(m_state.identity, m_state.identityLength);
+}
+
+void MumbleLink::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_timerId)
+        return;
+
+    if (m_isLinked)
+        poll();
+    else
+        search();
+}
+
+// "trylock" in Mumble plugin API style
+void MumbleLink::search()
+{
+    const auto kVersion = loadVersion(m_lm);
+    if ((kVersion != 1) && (kVersion != 2))
+        return;
+
+    const auto kCount = loadCount(m_lm);
+    if (kCount == m_lastCount)
+        return;
+
+    const auto kName = fromWChars(m_lm->name, 256);
+    if (kName.isEmpty())
+        return;
+
+    m_version = kVersion;
+    m_lastCount = kCount;
+    m_period = POLL_INTERVAL_MAX;
+    m_lastChange.start();
+    setLinked(true);
+    emit linked(kName, fromWChars(m_lm->description, 2048));
+}
+
+void MumbleLink::poll()
+{
+    const auto kVersion = loadVersion(m_lm);
+    if ((kVersion != 1) && (kVersion != 2))
+    {
+        setLinked(false);
+        emit unlinked();
+        return;
+    }
+
+    const auto kCount = loadCount(m_lm);
+    if (kCount == m_lastCount)
+    {
+        if (m_lastChange.hasExpired(TIMEOUT))
+        {
+            setLinked(false);
+            emit unlinked();
+        }
+        return;
+    }
+
+    quint32 count;
+    if (!read(count))
+        return;     // torn every time, next poll
+
+    // follow the game's update rate, ticks we missed included
+    const auto kTicks = qMax(count - m_lastCount, 1u);
+    const auto kPeriod = qMin((float)m_lastChange.restart() / kTicks, (float)TIMEOUT);
+    m_period += (kPeriod - m_period) * PERIOD_SMOOTHING;
+    const auto kInterval = qBound(POLL_INTERVAL_MIN, (int)(m_period / 2.0f), POLL_INTERVAL_MAX);
+    if (qAbs(kInterval - m_interval) > 1)
+        setInterval(kInterval);
+
+    m_version = kVersion;
+    m_lastCount = count;
+
+    auto fields = 0;
+    if (memcmp(m_read.avatar, m_state.avatar, sizeof(m_state.avatar)))
+    {
+        memcpy(m_state.avatar, m_read.avatar, sizeof(m_state.avatar));
+        fields |= Avatar;
+    }
+    if (memcmp(m_read.camera, m_state.camera, sizeof(m_state.camera)))
+    {
+        memcpy(m_state.camera, m_read.camera, sizeof(m_state.camera));
+        fields |= Camera;
+    }
+    if ((m_read.contextLength != m_state.contextLength) || memcmp(m_read.context, m_state.context, m_read.contextLength))
+    {
+        m_state.contextLength = m_read.contextLength;
+        memcpy(m_state.context, m_read.context, m_read.contextLength);
+        fields |= Context;
+    }
+    if ((m_read.identityLength != m_state.identityLength) || memcmp(m_read.identity, m_state.identity, m_read.identityLength * sizeof(wchar_t)))
+    {
+        m_state.identityLength = m_read.identityLength;
+        memcpy(m_state.identity, m_read.identity, m_read.identityLength * sizeof(wchar_t));
+        fields |= Identity;
+    }
+    emit changed(fields);
+}
+
+//! Copies the fields into m_read; false if the game kept writing during every attempt
+bool MumbleLink::read(quint32 &count)
+{
+    for (int attempt = 0; attempt < READ_RETRIES; ++attempt)
+    {
+        const auto kCount = loadCount(m_lm);
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        memcpy(m_read.avatar, m_lm->fAvatarPosition, sizeof(m_lm->fAvatarPosition));
+        memcpy(m_read.avatar + 3, m_lm->fAvatarFront, sizeof(m_lm->fAvatarFront));
+        memcpy(m_read.avatar + 6, m_lm->fAvatarTop, sizeof(m_lm->fAvatarTop));
+
+        if (loadVersion(m_lm) == 2)
+        {
+            memcpy(m_read.camera, m_lm->fCameraPosition, sizeof(m_lm->fCameraPosition));
+            memcpy(m_read.camera + 3, m_lm->fCameraFront, sizeof(m_lm->fCameraFront));
+            memcpy(m_read.camera + 6, m_lm->fCameraTop, sizeof(m_lm->fCameraTop));
+
+            m_read.contextLength = qMin(m_lm->context_len, CONTEXT_LENGTH_MAX);
+            memcpy(m_read.context, m_lm->context, m_read.contextLength);
+
+            auto length = 0;
+            for (; (length < 256) && m_lm->identity[length]; ++length)
+                m_read.identity[length] = m_lm->identity[length];
+            m_read.identityLength = length;
+        }
+        else    // legacy: camera is the avatar, no context or identity
+        {
+            memcpy(m_read.camera, m_read.avatar, sizeof(m_read.camera));
+            m_read.contextLength = 0;
+            m_read.identityLength = 0;
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (loadCount(m_lm) == kCount)
+        {
+            count = kCount;
+            return true;
+        }
+    }
+    return false;
+}
+
+void MumbleLink::setInterval(int interval)
+{
+    if ((interval == m_interval) && (m_timerId != 0))
+        return;
+
+    if (m_timerId != 0)
+        killTimer(m_timerId);
+
+    m_interval = interval;
+    m_timerId = startTimer(interval, (interval < 20) ? Qt::PreciseTimer : Qt::CoarseTimer);
+}
+
+void MumbleLink::setLinked(bool val)
+{
+    m_isLinked = val;
+    if (val)
+        setInterval(qBound(POLL_INTERVAL_MIN, (int)(m_period / 2.0f), POLL_INTERVAL_MAX));
+    else
+        setInterval(SEARCH_INTERVAL);
+}
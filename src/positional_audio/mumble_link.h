@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QObject>
+#include <QSharedMemory>
+#include <QElapsedTimer>
+
+struct LinkedMem;
+
+//! Reads the MumbleLink shared memory the games write to
+/*!
+ * Games don't take QSharedMemory's semaphore, so neither does the reader: a snapshot is taken when the tick counter
+ * moved, and retaken if it moved during the copy. The long fields (name, description) are only read on link,
+ * identity only up to its terminator.
+ *
+ * While no game is linked the memory is checked once a second. Once linked, the poll interval follows the game's
+ * update rate, half its measured period within POLL_INTERVAL_MIN..POLL_INTERVAL_MAX.
+ */
+class MumbleLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Field
+    {
+        Avatar = 0x1,
+        Camera = 0x2,
+        Context = 0x4,
+        Identity = 0x8
+    };
+
+    static const int SEARCH_INTERVAL = 1000;
+    static const int POLL_INTERVAL_MIN = 4;
+    static const int POLL_INTERVAL_MAX = 50;
+    static const int TIMEOUT = 5000;
+
+    explicit MumbleLink(QObject *parent = 0);
+
+    bool open();
+    void close();
+    QString errorString() const {return m_errorString;}
+
+    //! Marks the memory as unused and goes back to searching for a game
+    void reset();
+
+    bool isLinked() const {return m_isLinked;}
+    quint32 getVersion() const {return m_version;}
+    int getPollInterval() const {return m_interval;}
+
+    // snapshot
+    const float* getAvatarPosition() const {return m_state.avatar;}
+    const float* getAvatarFront() const {return m_state.avatar + 3;}
+    const float* getAvatarTop() const {return m_state.avatar + 6;}
+    const float* getCameraPosition() const {return m_state.camera;}
+    const float* getCameraFront() const {return m_state.camera + 3;}
+    const float* getCameraTop() const {return m_state.camera + 6;}
+    QByteArray getContext() const;
+    QString getIdentity() const;
+
+signals:
+    void linked(QString name, QString description);
+    //! The game ticked; fields is a combination of Field, 0 if it ticked without changes
+    void changed(int fields);
+    void unlinked();
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    struct State
+    {
+        float avatar[9];
+        float camera[9];
+        quint32 contextLength;
+        unsigned char context[256];
+        int identityLength;
+        wchar_t identity[256];
+    };
+
+    void search();
+    void poll();
+    bool read(quint32 &count);
+    void setInterval(int interval);
+    void setLinked(bool val);
+
+    QSharedMemory* m_sharedMemory = nullptr;
+    LinkedMem* m_lm = nullptr;
+    QString m_errorString;
+
+    int m_timerId = 0;
+    int m_interval = 0;
+    bool m_isLinked = false;
+
+    quint32 m_version = 0;
+    quint32 m_lastCount = 0;
+    QElapsedTimer m_lastChange;
+    float m_period = 20.0f;     // msec, smoothed
+
+    State m_state;
+    State m_read;
+};
@@ -0,0 +1,154 @@
+#include "positional_wire.h"
+
+#include <math.h>
+
+namespace PositionalWire
+{
+    const float POSITION_SCALE = 64.0f;
+    const float ORIENTATION_SCALE = 127.0f;
+
+    const quint8 FLAG_KEY_FRAME = 0x1;
+    const int HEADER_SIZE = 2;
+    const int KEY_FRAME_SIZE = HEADER_SIZE + (3 * 4) + 3 + 3;
+    const int DELTA_FRAME_SIZE = HEADER_SIZE + (3 * 2) + 3 + 3;
+
+    const QByteArray::Base64Options BASE64 = QByteArray::Base64UrlEncoding | QByteArray::OmitTrailingEquals;
+
+    static qint32 quantisePosition(float val)
+    {
+        const auto kVal = roundf(val * POSITION_SCALE);
+        if (kVal >= 2147483520.0f)
+            return 2147483647;
+        if (kVal <= -2147483520.0f)
+            return -2147483647;
+        return (qint32)kVal;
+    }
+
+    static qint8 quantiseOrientation(float val)
+    {
+        const auto kVal = roundf(val * ORIENTATION_SCALE);
+        return (qint8)((kVal > 127.0f) ? 127.0f : ((kVal < -127.0f) ? -127.0f : kVal));
+    }
+
+    static void put16(char* &out, qint32 val)
+    {
+        *out++ = (char)(val & 0xFF);
+        *out++ = (char)((val >> 8) & 0xFF);
+    }
+
+    static void put32(char* &out, qint32 val)
+    {
+        put16(out, val);
+        put16(out, val >> 16);
+    }
+
+    static qint32 get16(const uchar* &in)
+    {
+        const auto kVal = (qint16)(in[0] | (in[1] << 8));
+        in += 2;
+        return kVal;
+    }
+
+    static qint32 get32(const uchar* &in)
+    {
+        const auto kVal = (qint32)((quint32)in[0] | ((quint32)in[1] << 8) | ((quint32)in[2] << 16) | ((quint32)in[3] << 24));
+        in += 4;
+        return kVal;
+    }
+}
+
+PositionalWire::Frame PositionalWire::Quantise(const TS3_VECTOR &position, const TS3_VECTOR &front, const TS3_VECTOR &top)
+{
+    Frame frame;
+    frame.isValid = true;
+    frame.position[0] = quantisePosition(position.x);
+    frame.position[1] = quantisePosition(position.y);
+    frame.position[2] = quantisePosition(position.z);
+    frame.front[0] = quantiseOrientation(front.x);
+    frame.front[1] = quantiseOrientation(front.y);
+    frame.front[2] = quantiseOrientation(front.z);
+    frame.top[0] = quantiseOrientation(top.x);
+    frame.top[1] = quantiseOrientation(top.y);
+    frame.top[2] = quantiseOrientation(top.z);
+    return frame;
+}
+
+void PositionalWire::Dequantise(const Frame &frame, TS3_VECTOR &position, TS3_VECTOR &front, TS3_VECTOR &top)
+{
+    position.x = frame.position[0] / POSITION_SCALE;
+    position.y = frame.position[1] / POSITION_SCALE;
+    position.z = frame.position[2] / POSITION_SCALE;
+    front.x = frame.front[0] / ORIENTATION_SCALE;
+    front.y = frame.front[1] / ORIENTATION_SCALE;
+    front.z = frame.front[2] / ORIENTATION_SCALE;
+    top.x = frame.top[0] / ORIENTATION_SCALE;
+    top.y = frame.top[1] / ORIENTATION_SCALE;
+    top.z = frame.top[2] / ORIENTATION_SCALE;
+}
+
+QByteArray PositionalWire::Encode(const Frame &frame, Frame &sent)
+{
+    auto isKeyFrame = (!sent.isValid || (sent.framesSinceKey + 1 >= KEY_FRAME_INTERVAL));
+    qint64 delta[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        delta[i] = (qint64)frame.position[i] - sent.position[i];
+        isKeyFrame |= ((delta[i] > 32767) || (delta[i] < -32767));
+    }
+
+    char data[KEY_FRAME_SIZE];
+    auto out = data;
+    *out++ = (char)((VERSION << 4) | (isKeyFrame ? FLAG_KEY_FRAME : 0));
+    *out++ = (char)(quint8)(sent.sequence + 1);
+    for (int i = 0; i < 3; ++i)
+    {
+        if (isKeyFrame)
+            put32(out, frame.position[i]);
+        else
+            put16(out, (qint32)delta[i]);
+    }
+    for (int i = 0; i < 3; ++i)
+        *out++ = (char)frame.front[i];
+    for (int i = 0; i < 3; ++i)
+        *out++ = (char)frame.top[i];
+
+    const auto kSequence = (quint8)(sent.sequence + 1);
+    const auto kFramesSinceKey = isKeyFrame ? 0 : sent.framesSinceKey + 1;
+    sent = frame;
+    sent.isValid = true;
+    sent.sequence = kSequence;
+    sent.framesSinceKey = kFramesSinceKey;
+
+    return QByteArray::fromRawData(data, (int)(out - data)).toBase64(BASE64);
+}
+
+bool PositionalWire::Decode(const QByteArray &data, Frame &received)
+{
+    const auto kBytes = QByteArray::fromBase64(data, BASE64);
+    if (kBytes.size() < HEADER_SIZE)
+        return false;
+
+    auto in = reinterpret_cast<const uchar*>(kBytes.constData());
+    if ((in[0] >> 4) != VERSION)
+        return false;
+
+    const auto kIsKeyFrame = (in[0] & FLAG_KEY_FRAME);
+    const auto kSequence = in[1];
+    if (kBytes.size() != (kIsKeyFrame ? KEY_FRAME_SIZE : DELTA_FRAME_SIZE))
+        return false;
+
+    if (!kIsKeyFrame && !(received.isValid && (kSequence == (quint8)(received.sequence + 1))))
+        return false;
+
+    in += HEADER_SIZE;
+    for (int i = 0; i < 3; ++i)
+        received.position[i] = kIsKeyFrame ? get32(in) : (qint32)((quint32)received.position[i] + (quint32)get16(in));
+    for (int i = 0; i < 3; ++i)
+        received.front[i] = (qint8)*in++;
+    for (int i = 0; i < 3; ++i)
+        received.top[i] = (qint8)*in++;
+
+    received.isValid = true;
+    received.sequence = kSequence;
+    return true;
+}
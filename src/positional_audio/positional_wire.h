@@ -0,0 +1,39 @@
+#pragma once
+
+#include <QByteArray>
+#include "teamspeak/public_definitions.h"
+
+//! Compact avatar frames for the "3DB" plugin command
+/*!
+ * Positions are quantised to 1/64 unit, orientations to 1/127. A key frame carries the absolute position,
+ * the frames in between carry the position as 16 bit delta to the previous frame, which the receiver can only
+ * apply on top of that very frame (consecutive sequence numbers); otherwise it waits for the next key frame.
+ *
+ * byte 0: VERSION << 4 | flags, byte 1: sequence,
+ * key frame: position 3 x int32, delta frame: position 3 x int16, then front 3 x int8, top 3 x int8; little endian.
+ * Base64url without padding on the wire.
+ */
+namespace PositionalWire
+{
+    const int VERSION = 1;
+    const int KEY_FRAME_INTERVAL = 10;  // frames
+
+    struct Frame
+    {
+        bool isValid = false;
+        quint8 sequence = 0;
+        int framesSinceKey = 0;
+        qint32 position[3] = {0, 0, 0};
+        qint8 front[3] = {0, 0, 0};
+        qint8 top[3] = {0, 0, 0};
+    };
+
+    Frame Quantise(const TS3_VECTOR &position, const TS3_VECTOR &front, const TS3_VECTOR &top);
+    void Dequantise(const Frame &frame, TS3_VECTOR &position, TS3_VECTOR &front, TS3_VECTOR &top);
+
+    //! Encodes frame against the last sent one, then makes it the last sent one
+    QByteArray Encode(const Frame &frame, Frame &sent);
+
+    //! Decodes on top of the last received frame; false if malformed, of another version or not following it
+    bool Decode(const QByteArray &data, Frame &received);
+}
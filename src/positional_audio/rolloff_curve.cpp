@@ -0,0 +1,133 @@
+#include "rolloff_curve.h"
+
+#include <QStringList>
+#include <db.h>
+
+// Monotone cubic Hermite (Fritsch-Carlson): no overshoot between the points, so a falling curve keeps falling
+static float splineDb(const QVector<QPointF> &points, float x)
+{
+    const auto kCount = points.size();
+    if (x <= points.at(0).x())
+        return (float)points.at(0).y();
+    if (x >= points.at(kCount - 1).x())
+        return (float)points.at(kCount - 1).y();
+
+    int i = 0;
+    while (x > points.at(i + 1).x())
+        ++i;
+
+    auto slope = [&points](int k) {return (points.at(k + 1).y() - points.at(k).y()) / (points.at(k + 1).x() - points.at(k).x());};
+    auto tangent = [&points, &slope, kCount](int k)
+    {
+        if (k == 0)
+            return slope(0);
+        if (k == kCount - 1)
+            return slope(kCount - 2);
+
+        const auto kLeft = slope(k - 1);
+        const auto kRight = slope(k);
+        if ((kLeft * kRight) <= 0.0)
+            return 0.0;
+        return 3.0 * (kLeft + kRight) / ((2.0 * kRight + kLeft) / kLeft + (kRight + 2.0 * kLeft) / kRight);   // weighted harmonic mean
+    };
+
+    const auto kH = points.at(i + 1).x() - points.at(i).x();
+    const auto kT = (x - points.at(i).x()) / kH;
+    const auto kT2 = kT * kT;
+    const auto kT3 = kT2 * kT;
+    return (float)(((2 * kT3 - 3 * kT2 + 1) * points.at(i).y())
+                 + ((kT3 - 2 * kT2 + kT) * kH * tangent(i))
+                 + ((-2 * kT3 + 3 * kT2) * points.at(i + 1).y())
+                 + ((kT3 - kT2) * kH * tangent(i + 1)));
+}
+
+RolloffCurve::RolloffCurve()
+{
+    for (auto &val : m_table)
+        val = 1.0f;
+}
+
+void RolloffCurve::build(int model, int distanceMin, int distanceMax, float rollOff, float rollOffMax, const QVector<QPointF> &spline)
+{
+    m_distanceMin = (float)distanceMin;
+    m_distanceMax = (float)distanceMax;
+
+    // where the curves end: distanceMax, else where Logarithmic reaches the floor
+    float range = MAX_RANGE;
+    if (distanceMax > 0)
+        range = (float)(distanceMax - distanceMin);
+    else if ((rollOff < 0.0f) && (rollOffMax < 0.0f))
+        range = powf(2.0f, rollOffMax / rollOff);
+    m_range = qMax(1.0f, range);
+
+    const auto kTableRange = qMin(m_range, (float)MAX_RANGE);
+    m_rangeInv = 1.0f / kTableRange;
+    m_isTableClipped = (m_range > kTableRange);
+
+    if ((model == Spline) && (spline.size() < 2))
+        model = Logarithmic;
+    m_model = model;
+
+    m_points.clear();
+    for (const auto &point : spline)
+        m_points.append(QPointF(point.x() * m_range, point.y()));
+
+    m_rollOff = rollOff;
+    m_floor = db2lin_alt2(rollOffMax);
+    m_inverse = (rollOff < 0.0f) ? (db2lin_alt2(-rollOff) - 1.0f) : 0.0f;
+    for (int i = 0; i < TABLE_SIZE; ++i)
+    {
+        const auto kX = (float)i / (TABLE_SIZE - 1);
+        m_table[i] = evaluate(kTableRange * kX * kX * kX * kX);
+    }
+}
+
+float RolloffCurve::evaluate(float distance) const
+{
+    float volume;
+    switch (m_model)
+    {
+    case Inverse:
+        volume = 1.0f / (1.0f + (m_inverse * distance));
+        break;
+    case Linear:
+        volume = 1.0f - ((1.0f - m_floor) * distance / m_range);
+        break;
+    case Spline:
+        volume = db2lin_alt2(splineDb(m_points, distance));
+        break;
+    default:
+        volume = (distance <= 1.0f) ? 1.0f : db2lin_alt2(log2f(distance) * m_rollOff);
+        break;
+    }
+    return qMax(volume, m_floor);
+}
+
+QVector<QPointF> RolloffCurve::parseSpline(const QString &val)
+{
+    QVector<QPointF> spline;
+    const auto kPoints = val.split(',', QString::SkipEmptyParts);
+    for (const auto &point : kPoints)
+    {
+        const auto kPair = point.split(':');
+        if (kPair.size() != 2)
+            return QVector<QPointF>();
+
+        bool isOkX, isOkY;
+        const auto kX = kPair.at(0).trimmed().toDouble(&isOkX);
+        const auto kY = kPair.at(1).trimmed().toDouble(&isOkY);
+        if (!isOkX || !isOkY || (!spline.isEmpty() && (kX <= spline.last().x())))
+            return QVector<QPointF>();  // x has to increase strictly
+
+        spline.append(QPointF(kX, kY));
+    }
+    return spline;
+}
+
+QString RolloffCurve::toString(const QVector<QPointF> &spline)
+{
+    QStringList points;
+    for (const auto &point : spline)
+        points.append(QString("%1:%2").arg(point.x()).arg(point.y()));
+    return points.join(',');
+}
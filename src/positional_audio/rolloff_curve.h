@@ -0,0 +1,74 @@
+#pragma once
+
+#include <QPointF>
+#include <QString>
+#include <QVector>
+#include <math.h>
+
+//! Distance attenuation, tabulated
+/*!
+ * The curve is evaluated into a table whenever a parameter changes; volume() is a table lookup with linear
+ * interpolation. Entries are spaced with the 4th power of the distance, so the steep start of the curves gets most of them.
+ * The table covers at most MAX_RANGE units; a curve reaching further is evaluated directly beyond that.
+ * All models run from full volume at distanceMin, are floored at rollOffMax and cut off at distanceMax (if > 0):
+ * - Logarithmic: rollOff dB per doubling of the distance beyond distanceMin
+ * - Inverse: 1 / (1 + k * distance), k such that one unit beyond distanceMin is rollOff dB down
+ * - Linear: linear in amplitude down to rollOffMax at distanceMax (or where Logarithmic would reach it)
+ * - Spline: monotone cubic through custom (fraction of that range, dB) points
+ */
+class RolloffCurve
+{
+public:
+    enum Model
+    {
+        Logarithmic = 0,
+        Inverse,
+        Linear,
+        Spline
+    };
+
+    static const int TABLE_SIZE = 512;
+    static const int MAX_RANGE = 8192;  // units beyond distanceMin that are tabulated
+
+    RolloffCurve();
+
+    void build(int model, int distanceMin, int distanceMax, float rollOff, float rollOffMax, const QVector<QPointF> &spline);
+
+    float volume(float distance) const
+    {
+        if ((m_distanceMax > 0.0f) && (distance >= m_distanceMax))
+            return 0.0f;
+
+        const auto kDistance = distance - m_distanceMin;
+        if (kDistance <= 0.0f)
+            return 1.0f;
+
+        const auto kX = sqrtf(sqrtf(kDistance * m_rangeInv)) * (TABLE_SIZE - 1);
+        if (kX >= (TABLE_SIZE - 1))
+            return m_isTableClipped ? evaluate(kDistance) : m_table[TABLE_SIZE - 1];
+
+        const auto kIndex = (int)kX;
+        const auto kFrac = kX - kIndex;
+        return m_table[kIndex] + ((m_table[kIndex + 1] - m_table[kIndex]) * kFrac);
+    }
+
+    //! "fraction:dB,fraction:dB,..."
+    static QVector<QPointF> parseSpline(const QString &val);
+    static QString toString(const QVector<QPointF> &spline);
+
+private:
+    float evaluate(float distance) const;    // beyond distanceMin
+
+    int m_model = Logarithmic;
+    float m_rollOff = 0.0f;
+    float m_floor = 0.0f;
+    float m_inverse = 0.0f;
+    float m_range = 1.0f;                   // where the curve ends
+    QVector<QPointF> m_points;              // spline, scaled to m_range
+
+    float m_distanceMin = 0.0f;
+    float m_distanceMax = 0.0f;
+    float m_rangeInv = 1.0f;                // of the tabulated range
+    bool m_isTableClipped = false;          // the curve reaches beyond MAX_RANGE
+    float m_table[TABLE_SIZE];
+};
@@ -39,11 +39,14 @@ void SettingsPositionalAudio::Init(PositionalAudio *positionalAudio)
 
     connect(this, &SettingsPositionalAudio::EnabledSet, positionalAudio, &PositionalAudio::setEnabled);
     connect(this, &SettingsPositionalAudio::UseCameraSet, positionalAudio, &PositionalAudio::setUseCamera);
+    connect(this, &SettingsPositionalAudio::BinauralEnabledSet, positionalAudio, &PositionalAudio::setBinauralEnabled);
     connect(this, &SettingsPositionalAudio::UseAttenuationSet, positionalAudio, &PositionalAudio::setUseAttenuation);
     connect(this, &SettingsPositionalAudio::DistanceMinChanged, positionalAudio, &PositionalAudio::setDistanceMin);
     connect(this, &SettingsPositionalAudio::DistanceMaxChanged, positionalAudio,&PositionalAudio::setDistanceMax);
     connect(this, &SettingsPositionalAudio::RollOffChanged, positionalAudio, &PositionalAudio::setRollOff);
     connect(this, &SettingsPositionalAudio::RollOffMaxChanged, positionalAudio, &PositionalAudio::setRollOffMax);
+    connect(this, &SettingsPositionalAudio::RollOffModelChanged, positionalAudio, &PositionalAudio::setRollOffModel);
+    connect(this, &SettingsPositionalAudio::RollOffSplineChanged, positionalAudio, &PositionalAudio::setRollOffSpline);
 
     connect(this, &SettingsPositionalAudio::ServerSettingsAdd, positionalAudio, &PositionalAudio::AddServerSetting);
     connect(this, &SettingsPositionalAudio::ServerSettingsRemove, positionalAudio, &PositionalAudio::RemoveServerSetting);
@@ -87,6 +90,7 @@ void SettingsPositionalAudio::Init(PositionalAudio *positionalAudio)
     cfg.endGroup();
 
     emit UseCameraSet(cfg.value("isUseCamera",true).toBool());
+    emit BinauralEnabledSet(cfg.value("binaural",false).toBool());
     emit EnabledSet(cfg.value("enabled",true).toBool());
     cfg.beginGroup("attenuation");
     emit UseAttenuationSet(cfg.value("enabled",false).toBool());
@@ -94,6 +98,8 @@ void SettingsPositionalAudio::Init(PositionalAudio *positionalAudio)
     emit DistanceMaxChanged(cfg.value("distance_max",0).toInt());
     emit RollOffChanged(cfg.value("rolloff",-6.0f).toFloat());
     emit RollOffMaxChanged(cfg.value("rolloff_max",-200.0f).toFloat());
+    emit RollOffModelChanged(cfg.value("rolloff_model",(int)RolloffCurve::Logarithmic).toInt());
+    emit RollOffSplineChanged(cfg.value("rolloff_spline").toString());
 
     cfg.endGroup();
     cfg.endGroup();
@@ -461,6 +467,7 @@ void SettingsPositionalAudio::saveSettings(int r)
     cfg.beginGroup(mP_positionalAudio.data()->objectName());
     cfg.setValue("enabled",mP_positionalAudio.data()->isEnabled());
     cfg.setValue("isUseCamera",mP_positionalAudio.data()->isUseCamera());
+    cfg.setValue("binaural",mP_positionalAudio.data()->isBinauralEnabled());
 
     cfg.beginGroup("attenuation");
     cfg.setValue("enabled",mP_positionalAudio.data()->isUseAttenuation());
@@ -468,6 +475,8 @@ void SettingsPositionalAudio::saveSettings(int r)
     cfg.setValue("distance_max",mP_positionalAudio.data()->getDistanceMax());
     cfg.setValue("rolloff",mP_positionalAudio.data()->getRollOff());
     cfg.setValue("rolloff_max",mP_positionalAudio.data()->getRollOffMax());
+    cfg.setValue("rolloff_model",mP_positionalAudio.data()->getRollOffModel());
+    cfg.setValue("rolloff_spline",mP_positionalAudio.data()->getRollOffSpline());
     cfg.endGroup();
 
     QMap<QString,PositionalAudio_ServerSettings> map = mP_positionalAudio.data()->getServerSettings();
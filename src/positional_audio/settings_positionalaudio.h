@@ -43,12 +43,15 @@ public:
 signals:
     void EnabledSet(bool);
     void UseCameraSet(bool);
+    void BinauralEnabledSet(bool);
     void UseAttenuationSet(bool);
     void AttenuationSet(bool);
     void DistanceMinChanged(int);
     void DistanceMaxChanged(int);
     void RollOffChanged(float);
     void RollOffMaxChanged(float);
+    void RollOffModelChanged(int);
+    void RollOffSplineChanged(QString);
 
     void ServerSettingsAdd(QString,QString);
     void ServerSettingsRemove(QString,QString);
@@ -0,0 +1,121 @@
+#include "spatial_grid.h"
+
+#include <math.h>
+
+const int CELL_COORD_LIMIT = (1 << 20) - 1;  // 21 bits per axis in the key
+
+SpatialGrid::SpatialGrid(float cellSize)
+    : m_cellSize(cellSize)
+{
+}
+
+void SpatialGrid::setCellSize(float cellSize)
+{
+    if (cellSize == m_cellSize)
+        return;
+
+    QVector<Entry> entries;
+    entries.reserve(m_cellOf.size());
+    for (const auto &cell : m_cells)
+        entries += cell;
+
+    clear();
+    m_cellSize = cellSize;
+    for (const auto &entry : entries)
+        update(entry.serverConnectionHandlerID, entry.clientID, entry.position);
+}
+
+int SpatialGrid::cellCoord(float val) const
+{
+    const auto kCoord = floorf(val / m_cellSize);
+    if (kCoord >= CELL_COORD_LIMIT)
+        return CELL_COORD_LIMIT;
+    if (kCoord <= -CELL_COORD_LIMIT)
+        return -CELL_COORD_LIMIT;
+    return (int)kCoord;
+}
+
+quint64 SpatialGrid::cellKey(int x, int y, int z)
+{
+    const quint64 kMask = (1 << 21) - 1;
+    return ((quint64)(x & kMask) << 42) | ((quint64)(y & kMask) << 21) | (quint64)(z & kMask);
+}
+
+void SpatialGrid::update(uint64 serverConnectionHandlerID, anyID clientID, const TS3_VECTOR &position)
+{
+    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
+    const auto kCell = cellKey(cellCoord(position.x), cellCoord(position.y), cellCoord(position.z));
+    const auto kOld = m_cellOf.constFind(kKey);
+    if (kOld != m_cellOf.constEnd())
+    {
+        if (*kOld == kCell)
+        {
+            for (auto &entry : m_cells[kCell])
+            {
+                if ((entry.serverConnectionHandlerID == serverConnectionHandlerID) && (entry.clientID == clientID))
+                {
+                    entry.position = position;
+                    return;
+                }
+            }
+        }
+        removeFromCell(*kOld, serverConnectionHandlerID, clientID);
+    }
+
+    Entry entry;
+    entry.serverConnectionHandlerID = serverConnectionHandlerID;
+    entry.clientID = clientID;
+    entry.position = position;
+    m_cells[kCell].append(entry);
+    m_cellOf.insert(kKey, kCell);
+}
+
+void SpatialGrid::remove(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
+    const auto kCell = m_cellOf.constFind(kKey);
+    if (kCell == m_cellOf.constEnd())
+        return;
+
+    removeFromCell(*kCell, serverConnectionHandlerID, clientID);
+    m_cellOf.remove(kKey);
+}
+
+void SpatialGrid::remove(uint64 serverConnectionHandlerID)
+{
+    QVector<anyID> clientIDs;
+    for (auto it = m_cellOf.constBegin(); it != m_cellOf.constEnd(); ++it)
+    {
+        if (it.key().first == serverConnectionHandlerID)
+            clientIDs.append(it.key().second);
+    }
+    for (auto clientID : clientIDs)
+        remove(serverConnectionHandlerID, clientID);
+}
+
+void SpatialGrid::clear()
+{
+    m_cells.clear();
+    m_cellOf.clear();
+}
+
+// swap-remove; drops the cell when it runs empty
+void SpatialGrid::removeFromCell(quint64 cell, uint64 serverConnectionHandlerID, anyID clientID)
+{
+    auto it = m_cells.find(cell);
+    if (it == m_cells.end())
+        return;
+
+    auto &entries = *it;
+    for (int i = 0; i < entries.size(); ++i)
+    {
+        if ((entries.at(i).serverConnectionHandlerID == serverConnectionHandlerID) && (entries.at(i).clientID == clientID))
+        {
+            entries[i] = entries.last();
+            entries.removeLast();
+            break;
+        }
+    }
+    if (entries.isEmpty())
+        m_cells.erase(it);
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include "teamspeak/public_definitions.h"
+
+//! Uniform hash grid over the remote avatars, for range queries around the listener
+/*!
+ * Entries move between cells as their positions arrive; a query visits only the cells overlapping the query's
+ * bounding box, so with the cell size near the query radius it costs 27 cell lookups plus the hits,
+ * independent of how many players are elsewhere on the map.
+ */
+class SpatialGrid
+{
+public:
+    explicit SpatialGrid(float cellSize = 64.0f);
+
+    float getCellSize() const {return m_cellSize;}
+    //! Redistributes all entries
+    void setCellSize(float cellSize);
+
+    void update(uint64 serverConnectionHandlerID, anyID clientID, const TS3_VECTOR &position);
+    void remove(uint64 serverConnectionHandlerID, anyID clientID);
+    void remove(uint64 serverConnectionHandlerID);
+    void clear();
+
+    int size() const {return m_cellOf.size();}
+
+    //! Calls f(serverConnectionHandlerID, clientID, position) for every entry within radius of center
+    template <typename F>
+    void query(const TS3_VECTOR &center, float radius, F f) const
+    {
+        const auto kRadius2 = radius * radius;
+        const int kMin[3] = {cellCoord(center.x - radius), cellCoord(center.y - radius), cellCoord(center.z - radius)};
+        const int kMax[3] = {cellCoord(center.x + radius), cellCoord(center.y + radius), cellCoord(center.z + radius)};
+        for (int x = kMin[0]; x <= kMax[0]; ++x)
+        {
+            for (int y = kMin[1]; y <= kMax[1]; ++y)
+            {
+                for (int z = kMin[2]; z <= kMax[2]; ++z)
+                {
+                    const auto kCell = m_cells.constFind(cellKey(x, y, z));
+                    if (kCell == m_cells.constEnd())
+                        continue;
+
+                    for (const auto &entry : *kCell)
+                    {
+                        const auto kDx = entry.position.x - center.x;
+                        const auto kDy = entry.position.y - center.y;
+                        const auto kDz = entry.position.z - center.z;
+                        if ((kDx * kDx) + (kDy * kDy) + (kDz * kDz) <= kRadius2)
+                            f(entry.serverConnectionHandlerID, entry.clientID, entry.position);
+                    }
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        uint64 serverConnectionHandlerID;
+        anyID clientID;
+        TS3_VECTOR position;
+    };
+
+    int cellCoord(float val) const;
+    static quint64 cellKey(int x, int y, int z);
+    void removeFromCell(quint64 cell, uint64 serverConnectionHandlerID, anyID clientID);
+
+    float m_cellSize;
+    QHash<quint64, QVector<Entry> > m_cells;
+    QHash<QPair<uint64, anyID>, quint64> m_cellOf;
+};
@@ -1,35 +1,127 @@
 #include "tsvr_universe.h"
 #include "teamspeak/clientlib_publicdefinitions.h"
+#include "teamspeak/public_errors.h"
+
+#include <string.h>
+
+#include "tsvr_obj.h"
+#include "guildwarstwo.h"
+#include "ts_helpers_qt.h"
+#include "ts_logging_qt.h"
+#include "../slot_table.h"
+
+const TsVrUniverse::Handle TsVrUniverse::INVALID_HANDLE;
+
+void TsVrPositionedSet::clear()
+{
+    memset(keys, 0, sizeof(keys));
+}
+
+void TsVrPositionedSet::insert(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    auto i = SlotTableHelpers::hashKey(serverConnectionHandlerID, clientID) & (TABLE_SIZE - 1);
+    while (keys[i] != 0)
+        i = (i + 1) & (TABLE_SIZE - 1);
+
+    keys[i] = TsVrUniverse::key(serverConnectionHandlerID, clientID);
+}
+
+bool TsVrPositionedSet::contains(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    const auto kKey = TsVrUniverse::key(serverConnectionHandlerID, clientID);
+    auto i = SlotTableHelpers::hashKey(serverConnectionHandlerID, clientID) & (TABLE_SIZE - 1);
+    while (keys[i] != 0)
+    {
+        if (keys[i] == kKey)
+            return true;
+
+        i = (i + 1) & (TABLE_SIZE - 1);
+    }
+    return false;
+}
 
 TsVrUniverse::TsVrUniverse(QObject *parent) :
     QObject(parent)
 {
+    m_strings.append(QString());    // id 0
+    m_stringIds.insert(QString(), 0);
 }
 
-//! Create and add a TsVR struct to the Universe map
+//! Create a player in a free slot
 /*!
  * \brief TsVrUniverse::Add Helper function
  * \param serverConnectionHandlerID the connection id of the server
  * \param clientID the client id
+ * \return the handle, valid until the player is removed
  */
-TsVrObjOther* TsVrUniverse::Add(uint64 serverConnectionHandlerID,anyID clientID)
+TsVrUniverse::Handle TsVrUniverse::Add(uint64 serverConnectionHandlerID, anyID clientID)
 {
-    TsVrObjOther* obj = new TsVrObjOther(this,serverConnectionHandlerID,clientID);
-    if (!(m_Map.contains(serverConnectionHandlerID))) //safety measurement
+    auto handle = Find(serverConnectionHandlerID, clientID);
+    if (handle != INVALID_HANDLE)
+        return handle;
+
+    if (m_freeHandles.isEmpty())
     {
-        auto ConnectionHandlerUniverse = new QMap<anyID,TsVrObjOther*>;
-        ConnectionHandlerUniverse->insert(clientID,obj);
-        m_Map.insert(serverConnectionHandlerID,ConnectionHandlerUniverse);
+        handle = m_isValid.size();
+        const auto kSize = handle + 1;
+        m_isValid.resize(kSize);
+        m_isInContext.resize(kSize);
+        m_avatarPosition.resize(kSize);
+        m_avatarFront.resize(kSize);
+        m_avatarTop.resize(kSize);
+        m_motion.resize(kSize);
+        m_vrId.resize(kSize);
+        m_contextId.resize(kSize);
+        m_serverConnectionHandlerID.resize(kSize);
+        m_clientID.resize(kSize);
+        m_clientUID.resize(kSize);
+        m_identityRaw.resize(kSize);
+        m_displayName.resize(kSize);
+        m_displayNameJson.resize(kSize);
+        m_customEnvironmentSupport.resize(kSize);
+        m_wireFrame.resize(kSize);
+        m_wireVersion.resize(kSize);
+        m_isWireVersionSent.resize(kSize);
     }
     else
     {
-        auto ConnectionHandlerUniverse = m_Map.value(serverConnectionHandlerID);
-        ConnectionHandlerUniverse->insert(clientID,obj);
+        handle = m_freeHandles.last();
+        m_freeHandles.removeLast();
     }
-    return obj;
+
+    const TS3_VECTOR kNullVector = {0.0f, 0.0f, 0.0f};
+    m_isValid[handle] = true;
+    m_isInContext[handle] = false;
+    m_avatarPosition[handle] = kNullVector;
+    m_avatarFront[handle] = kNullVector;
+    m_avatarTop[handle] = kNullVector;
+    m_motion[handle] = AvatarMotion();
+    m_vrId[handle] = 0;
+    m_contextId[handle] = 0;
+    m_serverConnectionHandlerID[handle] = serverConnectionHandlerID;
+    m_clientID[handle] = clientID;
+    m_identityRaw[handle].clear();
+    m_displayName[handle].clear();
+    m_displayNameJson[handle].clear();
+    m_customEnvironmentSupport[handle] = nullptr;
+    m_wireFrame[handle] = PositionalWire::Frame();
+    m_wireVersion[handle] = 0;
+    m_isWireVersionSent[handle] = false;
+
+    unsigned int error;
+    if ((error = TSHelpers::GetClientUID(serverConnectionHandlerID, clientID, m_clientUID[handle])) != ERROR_ok)
+        TSLogging::Error("(TsVrUniverse::Add)", serverConnectionHandlerID, error, true);
+
+    m_handles.insert(key(serverConnectionHandlerID, clientID), handle);
+    return handle;
+}
+
+TsVrUniverse::Handle TsVrUniverse::Find(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    return m_handles.value(key(serverConnectionHandlerID, clientID), INVALID_HANDLE);
 }
 
-//! Remove a specific object
+//! Remove a specific player
 /*!
  * \brief TsVrUniverse::Remove Helper function
  * \param serverConnectionHandlerID the connection id of the server
@@ -37,81 +129,271 @@ TsVrObjOther* TsVrUniverse::Add(uint64 serverConnectionHandlerID,anyID clientID)
  */
 void TsVrUniverse::Remove(uint64 serverConnectionHandlerID, anyID clientID)
 {
-    if (!(m_Map.contains(serverConnectionHandlerID)))
-        return;
-
-    auto ConnectionHandlerUniverse = m_Map.value(serverConnectionHandlerID);
-    if (!(ConnectionHandlerUniverse->contains(clientID)))
+    const auto kHandle = Find(serverConnectionHandlerID, clientID);
+    if (kHandle == INVALID_HANDLE)
         return;
 
-    auto removedObj = ConnectionHandlerUniverse->take(clientID);
-    auto clientUID = removedObj->getClientUID();
-    delete removedObj;
-    emit removed(clientUID);
+    m_handles.remove(key(serverConnectionHandlerID, clientID));
+    const auto kClientUID = m_clientUID.at(kHandle);
+    removeAt(kHandle);
+    emit removed(kClientUID);
 }
 
-//! Remove all TsVR objects of a server tab
+//! Remove all players of a server tab
 /*!
  * \brief TsVrUniverse::Remove Helper function
  * \param serverConnectionHandlerID the connection id of the server
  */
 void TsVrUniverse::Remove(uint64 serverConnectionHandlerID)
 {
-    if (!(m_Map.contains(serverConnectionHandlerID)))
-        return;
-
-    auto ConnectionHandlerUniverse = m_Map.take(serverConnectionHandlerID);
-    QMutableMapIterator<anyID,TsVrObjOther*> i(*ConnectionHandlerUniverse);
-    while (i.hasNext())
+    for (Handle handle = 0; handle < m_isValid.size(); ++handle)
     {
-        i.next();
-        delete ConnectionHandlerUniverse->take(i.key());
+        if (m_isValid.at(handle) && (m_serverConnectionHandlerID.at(handle) == serverConnectionHandlerID))
+        {
+            m_handles.remove(key(serverConnectionHandlerID, m_clientID.at(handle)));
+            const auto kClientUID = m_clientUID.at(handle);
+            removeAt(handle);
+            emit removed(kClientUID);
+        }
     }
-    m_Map.remove(serverConnectionHandlerID);
 }
 
-//! Remove all TsVR objects
+//! Remove all players
 /*!
  * \brief TsVrUniverse::Remove Helper function
  */
 void TsVrUniverse::Remove()
 {
-    if (m_Map.isEmpty())
+    for (Handle handle = 0; handle < m_isValid.size(); ++handle)
+    {
+        if (m_isValid.at(handle))
+            removeAt(handle);
+    }
+    m_handles.clear();
+}
+
+void TsVrUniverse::removeAt(Handle handle)
+{
+    setInContext(handle, false);
+    m_isValid[handle] = false;
+    m_clientUID[handle].clear();
+    m_identityRaw[handle].clear();
+    m_displayName[handle].clear();
+    m_displayNameJson[handle].clear();
+    if (m_customEnvironmentSupport.at(handle))
+    {
+        m_customEnvironmentSupport.at(handle)->deleteLater();
+        m_customEnvironmentSupport[handle] = nullptr;
+    }
+    m_freeHandles.append(handle);
+}
+
+bool TsVrUniverse::Contains(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    return m_handles.contains(key(serverConnectionHandlerID, clientID));
+}
+
+bool TsVrUniverse::setAvatar(Handle handle, const TS3_VECTOR &position, const TS3_VECTOR &front, const TS3_VECTOR &top)
+{
+    const auto kIsDirty = !((m_avatarPosition.at(handle) == position) && (m_avatarFront.at(handle) == front) && (m_avatarTop.at(handle) == top));
+    m_avatarPosition[handle] = position;
+    m_avatarFront[handle] = front;
+    m_avatarTop[handle] = top;
+    return kIsDirty;
+}
+
+bool TsVrUniverse::isInContext(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    const auto kHandle = Find(serverConnectionHandlerID, clientID);
+    return (kHandle != INVALID_HANDLE) && m_isInContext.at(kHandle);
+}
+
+void TsVrUniverse::setInContext(Handle handle, bool val)
+{
+    if (m_isInContext.at(handle) == val)
+        return;
+
+    m_isInContext[handle] = val;
+    m_contextCount += val ? 1 : -1;
+    schedulePublishPositioned();
+}
+
+void TsVrUniverse::clearContext()
+{
+    m_isInContext.fill(false);
+    m_contextCount = 0;
+    schedulePublishPositioned();
+}
+
+// playback / mixer thread of the reader
+bool TsVrUniverse::isPositioned(PositionedReader reader, uint64 serverConnectionHandlerID, anyID clientID)
+{
+    auto &positioned = m_positioned[reader];
+    positioned.update();
+    return positioned.front().contains(serverConnectionHandlerID, clientID);
+}
+
+//! Coalesces the context changes of an event loop pass into one publication
+void TsVrUniverse::schedulePublishPositioned()
+{
+    if (m_isPublishPositionedScheduled)
         return;
 
-    QMutableMapIterator<uint64, QMap<anyID,TsVrObjOther*>* > i(m_Map);
-    while (i.hasNext())
+    m_isPublishPositionedScheduled = true;
+    QMetaObject::invokeMethod(this, "publishPositioned", Qt::QueuedConnection);
+}
+
+void TsVrUniverse::publishPositioned()
+{
+    m_isPublishPositionedScheduled = false;
+
+    auto &set = m_positioned[0].back();
+    set.clear();
+    auto count = 0;
+    for (Handle handle = 0; (handle < m_isValid.size()) && (count < TsVrPositionedSet::CAPACITY); ++handle)
     {
-        i.next();
-        Remove(i.key());
+        if (m_isValid.at(handle) && m_isInContext.at(handle))
+        {
+            set.insert(m_serverConnectionHandlerID.at(handle), m_clientID.at(handle));
+            ++count;
+        }
     }
+
+    for (int reader = 1; reader < POSITIONED_READERS; ++reader)
+        m_positioned[reader].back() = set;
+
+    for (auto &positioned : m_positioned)
+        positioned.publish();
+}
+
+int TsVrUniverse::intern(const QString &val)
+{
+    const auto kIt = m_stringIds.constFind(val);
+    if (kIt != m_stringIds.constEnd())
+        return *kIt;
+
+    const auto kId = m_strings.size();
+    m_strings.append(val);
+    m_stringIds.insert(val, kId);
+    return kId;
+}
+
+//! Returns whether it changed
+bool TsVrUniverse::setVr(Handle handle, const QString &val)
+{
+    const auto kId = intern(val);
+    if (m_vrId.at(handle) == kId)
+        return false;
+
+    m_vrId[handle] = kId;
+
+    if (m_customEnvironmentSupport.at(handle))
+        m_customEnvironmentSupport.at(handle)->deleteLater();
+
+    if (val == "Guild Wars 2")
+        m_customEnvironmentSupport[handle] = new GuildWarsTwo(this);
+    else
+        m_customEnvironmentSupport[handle] = nullptr;
+
+    return true;
 }
 
-bool TsVrUniverse::Contains(uint64 serverConnectionHandlerID, anyID clientID)
+//! Returns whether it changed
+bool TsVrUniverse::setContext(Handle handle, const QString &val)
 {
-    if (!m_Map.contains(serverConnectionHandlerID))
+    const auto kId = intern(val);
+    if (m_contextId.at(handle) == kId)
         return false;
-    return m_Map.value(serverConnectionHandlerID)->contains(clientID);
+
+    m_contextId[handle] = kId;
+    return true;
 }
 
-TsVrObjOther* TsVrUniverse::Get(uint64 serverConnectionHandlerID, anyID clientID)
+QString TsVrUniverse::getIdentity(Handle handle) const
 {
-    if (!m_Map.contains(serverConnectionHandlerID))
-        return NULL;
-    if (!m_Map.value(serverConnectionHandlerID)->contains(clientID))
-        return NULL;
-    return m_Map.value(serverConnectionHandlerID)->value(clientID);
+    auto iCustomEnvironmentSupport = qobject_cast<CustomEnvironmentSupportInterface *>(m_customEnvironmentSupport.at(handle));
+    if (iCustomEnvironmentSupport)
+        return iCustomEnvironmentSupport->getIdentity();
+
+    return m_identityRaw.at(handle);
 }
 
-//bool TsVrUniverse::RegisterCustomEnvironmentSupport(QObject *p)
-//{
-//    CustomEnvironmentSupportInterface *iCustomEnvironmentSupport = qobject_cast<CustomEnvironmentSupportInterface *>(p);
-//    if (!iCustomEnvironmentSupport)
-//        return false;
+//! Returns whether it changed
+bool TsVrUniverse::setIdentityRaw(Handle handle, const QString &val)
+{
+    if (m_identityRaw.at(handle) == val)
+        return false;
 
-//    m_CustomEnvironmentSupportMap.insert(p->objectName(),p);
-//    return true;
-//}
+    m_identityRaw[handle] = val;
+
+    auto iCustomEnvironmentSupport = qobject_cast<CustomEnvironmentSupportInterface *>(m_customEnvironmentSupport.at(handle));
+    if (iCustomEnvironmentSupport)
+        iCustomEnvironmentSupport->onIdentityRawDirty(val);
+
+    return true;
+}
+
+bool TsVrUniverse::fetchDisplayName(Handle handle)
+{
+    if (!m_displayName.at(handle).isEmpty())
+        return true;
+
+    unsigned int error;
+    char name[512];
+    const auto kServerConnectionHandlerID = m_serverConnectionHandlerID.at(handle);
+    if ((error = ts3Functions.getClientDisplayName(kServerConnectionHandlerID, m_clientID.at(handle), name, 512)) != ERROR_ok)
+    {
+        TSLogging::Error("(TsVrUniverse::fetchDisplayName)", kServerConnectionHandlerID, error);
+        return false;
+    }
+
+    m_displayName[handle] = QString::fromUtf8(name);
+    auto displayNameJson = m_displayName.at(handle);
+    displayNameJson.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
+    displayNameJson.replace(QLatin1Char('"'), QLatin1String("\\\""));
+    m_displayNameJson[handle] = displayNameJson;
+    return true;
+}
+
+QString TsVrUniverse::getDisplayName(Handle handle)
+{
+    return fetchDisplayName(handle) ? m_displayName.at(handle) : QString();
+}
+
+QString TsVrUniverse::getDisplayNameJson(Handle handle)
+{
+    return fetchDisplayName(handle) ? m_displayNameJson.at(handle) : QString();
+}
+
+void TsVrUniverse::onClientDisplayNameChanged(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    const auto kHandle = Find(serverConnectionHandlerID, clientID);
+    if (kHandle != INVALID_HANDLE)
+    {
+        m_displayName[kHandle].clear();
+        m_displayNameJson[kHandle].clear();
+    }
+}
+
+//! Handles the ts_infodata_qt event for a player
+bool TsVrUniverse::onInfoDataChanged(Handle handle, QTextStream &data) const
+{
+    if (m_vrId.at(handle) == 0)
+        return false;
+
+    data << "Positional Audio: ";
+    data << "\nPlaying " << getVr(handle);
+    auto ident = getIdentity(handle);
+    if (!ident.isEmpty())
+    {
+        data << " as " << ident;
+
+        auto iCustomEnvironmentSupport = qobject_cast<CustomEnvironmentSupportInterface *>(m_customEnvironmentSupport.at(handle));
+        if (iCustomEnvironmentSupport)
+            iCustomEnvironmentSupport->onInfoData(data);
+    }
+    return true;
+}
 
 //! When disconnecting from a server tab, clean up
 /*!
@@ -124,7 +406,5 @@ void TsVrUniverse::onConnectStatusChanged(uint64 serverConnectionHandlerID, int
 {
     Q_UNUSED(errorNumber);
     if (newStatus==STATUS_DISCONNECTED)
-            Remove(serverConnectionHandlerID);
-    else if ((newStatus==STATUS_CONNECTION_ESTABLISHED) && !(m_Map.contains(serverConnectionHandlerID)))
-        m_Map.insert(serverConnectionHandlerID, new QMap<anyID,TsVrObjOther*>);
+        Remove(serverConnectionHandlerID);
 }
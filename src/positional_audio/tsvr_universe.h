@@ -1,25 +1,113 @@
 #pragma once
 
 #include <QObject>
-#include <QMap>
+#include <QHash>
+#include <QVector>
+#include <QTextStream>
 
-#include "tsvr_obj_other.h"
+#include "teamspeak/public_definitions.h"
+#include "positional_wire.h"
+#include "avatar_motion.h"
+#include "../triple_buffer.h"
 
+//! The players in my context, as handed to the audio callbacks
+struct TsVrPositionedSet
+{
+    static const int CAPACITY = 512;
+    static const int TABLE_SIZE = CAPACITY * 2;     // open addressing, load factor <= 0.5
+
+    void clear();
+    void insert(uint64 serverConnectionHandlerID, anyID clientID);
+    bool contains(uint64 serverConnectionHandlerID, anyID clientID) const;
+
+    quint64 keys[TABLE_SIZE] = {};                  // TsVrUniverse::key(), 0 is empty
+};
+
+//! The remote players, one contiguous store
+/*!
+ * Players live in slots; a Handle is the slot index and stays valid until the player is removed, after which the
+ * slot is reused. The per tick data (avatar, motion, context membership) is kept in parallel arrays, so the 3D
+ * update, the rolloff callback and the broadcasts walk flat memory instead of a map of heap objects.
+ * vr and context are interned: comparing them against my own is an int compare.
+ * Identities are unique per player, they are kept per slot as received.
+ * The store belongs to the gui thread. The audio callbacks ask isPositioned(), which reads a copy of the context
+ * membership published once per event loop pass after it changed; each callback thread has its own copy.
+ */
 class TsVrUniverse : public QObject
 {
     Q_OBJECT
 public:
+    typedef int Handle;
+    static const Handle INVALID_HANDLE = -1;
+
+    //! The audio callbacks reading isPositioned(), one reader thread each
+    enum PositionedReader
+    {
+        PostProcessReader = 0,
+        RolloffReader,
+        POSITIONED_READERS
+    };
+
     explicit TsVrUniverse(QObject *parent = 0);
-    
-    TsVrObjOther* Add(uint64 serverConnectionHandlerID, anyID clientID);
+
+    Handle Add(uint64 serverConnectionHandlerID, anyID clientID);
+    Handle Find(uint64 serverConnectionHandlerID, anyID clientID) const;
     void Remove(uint64 serverConnectionHandlerID, anyID clientID);
     void Remove(uint64 serverConnectionHandlerID);
     void Remove();
-    bool Contains(uint64 serverConnectionHandlerID, anyID clientID);
-    TsVrObjOther* Get(uint64 serverConnectionHandlerID, anyID clientID);
+    bool Contains(uint64 serverConnectionHandlerID, anyID clientID) const;
+
+    //! Handles are below capacity(); iterate with isValid()
+    int capacity() const {return m_isValid.size();}
+    bool isValid(Handle handle) const {return m_isValid.at(handle);}
+
+    uint64 getServerConnectionHandlerID(Handle handle) const {return m_serverConnectionHandlerID.at(handle);}
+    anyID getClientID(Handle handle) const {return m_clientID.at(handle);}
+    QString getClientUID(Handle handle) const {return m_clientUID.at(handle);}
+
+    const TS3_VECTOR &getAvatarPosition(Handle handle) const {return m_avatarPosition.at(handle);}
+    const TS3_VECTOR &getAvatarFront(Handle handle) const {return m_avatarFront.at(handle);}
+    const TS3_VECTOR &getAvatarTop(Handle handle) const {return m_avatarTop.at(handle);}
+    bool setAvatar(Handle handle, const TS3_VECTOR &position, const TS3_VECTOR &front, const TS3_VECTOR &top);
+
+    AvatarMotion &motion(Handle handle) {return m_motion[handle];}
+    PositionalWire::Frame &wireFrame(Handle handle) {return m_wireFrame[handle];}   // last "3DB" frame received
 
-//    bool RegisterCustomEnvironmentSupport(QObject *p);
-//    QMap<QString,QObject*> m_CustomEnvironmentSupportMap;
+    //! In my vr and context: positioned by us
+    bool isInContext(Handle handle) const {return m_isInContext.at(handle);}
+    bool isInContext(uint64 serverConnectionHandlerID, anyID clientID) const;
+    void setInContext(Handle handle, bool val);
+    void clearContext();
+    int getContextCount() const {return m_contextCount;}
+
+    //! In my context, for the audio callbacks; lock free, lags isInContext() by an event loop pass
+    bool isPositioned(PositionedReader reader, uint64 serverConnectionHandlerID, anyID clientID);
+
+    //! Interned ids, 0 for the empty string
+    int intern(const QString &val);
+    int getVrId(Handle handle) const {return m_vrId.at(handle);}
+    int getContextId(Handle handle) const {return m_contextId.at(handle);}
+    QString getVr(Handle handle) const {return m_strings.at(m_vrId.at(handle));}
+    QString getContext(Handle handle) const {return m_strings.at(m_contextId.at(handle));}
+    bool setVr(Handle handle, const QString &val);
+    bool setContext(Handle handle, const QString &val);
+
+    QString getIdentity(Handle handle) const;
+    QString getIdentityRaw(Handle handle) const {return m_identityRaw.at(handle);}
+    bool setIdentityRaw(Handle handle, const QString &val);
+
+    //! Fetched on first use, dropped on a display name change
+    QString getDisplayName(Handle handle);
+    QString getDisplayNameJson(Handle handle);  // escaped
+    void onClientDisplayNameChanged(uint64 serverConnectionHandlerID, anyID clientID);
+
+    //! "3DB" version agreed on, 0 for text only
+    int getWireVersion(Handle handle) const {return m_wireVersion.at(handle);}
+    void setWireVersion(Handle handle, int val) {m_wireVersion[handle] = (quint8)val;}
+    bool isWireVersionSent(Handle handle) const {return m_isWireVersionSent.at(handle);}
+    void setWireVersionSent(Handle handle, bool val) {m_isWireVersionSent[handle] = val;}
+
+    bool onInfoDataChanged(Handle handle, QTextStream &data) const;
 
 signals:
     void removed(QString);
@@ -27,6 +115,44 @@ signals:
 public slots:
     void onConnectStatusChanged(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber);
 
+private slots:
+    void publishPositioned();
+
 private:
-    QMap<uint64,QMap<anyID,TsVrObjOther*>* > m_Map;
+    friend struct TsVrPositionedSet;
+    static quint64 key(uint64 serverConnectionHandlerID, anyID clientID) {return (serverConnectionHandlerID << 16) | clientID;}
+    void removeAt(Handle handle);
+    bool fetchDisplayName(Handle handle);
+    void schedulePublishPositioned();
+
+    QHash<quint64, Handle> m_handles;
+    QVector<Handle> m_freeHandles;
+
+    // hot
+    QVector<bool> m_isValid;
+    QVector<bool> m_isInContext;
+    QVector<TS3_VECTOR> m_avatarPosition;
+    QVector<TS3_VECTOR> m_avatarFront;
+    QVector<TS3_VECTOR> m_avatarTop;
+    QVector<AvatarMotion> m_motion;
+    QVector<int> m_vrId;
+    QVector<int> m_contextId;
+    int m_contextCount = 0;
+    TripleBuffer<TsVrPositionedSet> m_positioned[POSITIONED_READERS];
+    bool m_isPublishPositionedScheduled = false;
+
+    // cold
+    QVector<uint64> m_serverConnectionHandlerID;
+    QVector<anyID> m_clientID;
+    QVector<QString> m_clientUID;
+    QVector<QString> m_identityRaw;
+    QVector<QString> m_displayName;
+    QVector<QString> m_displayNameJson;
+    QVector<QObject*> m_customEnvironmentSupport;   // children; per vr identity parsing, see CustomEnvironmentSupportInterface
+    QVector<PositionalWire::Frame> m_wireFrame;
+    QVector<quint8> m_wireVersion;
+    QVector<bool> m_isWireVersionSent;
+
+    QHash<QString, int> m_stringIds;
+    QVector<QString> m_strings;
 };
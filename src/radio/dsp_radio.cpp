@@ -1,24 +1,17 @@
 #include "dsp_radio.h"
 
 #include <QVarLengthArray>
+#include <algorithm>
 
-#ifndef M_PI
-#define M_PI    3.14159265358979323846f
-#endif
-const double TWO_PI_OVER_SAMPLE_RATE = 2*M_PI/48000;
+#include "dsp_kernels.h"
+
+const int SAMPLE_RATE = 48000;
+const int BANDPASS_ORDER = 4;
+const int BANDPASS_TRANSITION_SAMPLES = 1024;   // parameter changes glide over this many samples
 
 DspRadio::DspRadio(QObject *parent) :
     QObject(parent)
 {
-    Dsp::Params params;
-    params[0] = 48000; // sample rate
-    params[1] = 4; // order
-    params[2] = 1600; // center frequency
-    params[3] = 1300; // band width
-    f_m->setParams(params);
-    f_s->setParams(params);
-    f_m_o->setParams(params);
-    f_s_o->setParams(params);
 }
 
 void DspRadio::setEnabled(QString name, bool val)
@@ -47,10 +40,7 @@ void DspRadio::setBandpassEqInCenterFrequency(QString name, double val)
 {
     if (name.isEmpty() || (name == m_channel_type))
     {
-        if (f_m)
-            f_m->setParam(2,val);
-        if (f_s)
-            f_s->setParam(2,val);
+        m_eq_in.centerFrequency = val;
 
         emit bandpassEqInCenterFrequencyChanged(val);
     }
@@ -60,10 +50,7 @@ void DspRadio::setBandpassEqInBandWidth(QString name, double val)
 {
     if (name.isEmpty() || (name == m_channel_type))
     {
-        if (f_m)
-            f_m->setParam(3,val);
-        if (f_s)
-            f_s->setParam(3,val);
+        m_eq_in.bandWidth = val;
 
         emit bandpassEqInBandWidthChanged(val);
     }
@@ -99,10 +86,7 @@ void DspRadio::setBandpassEqOutCenterFrequency(QString name, double val)
 {
     if (name.isEmpty() || (name == m_channel_type))
     {
-        if (f_m_o)
-            f_m_o->setParam(2,val);
-        if (f_s_o)
-            f_s_o->setParam(2,val);
+        m_eq_out.centerFrequency = val;
 
         emit bandpassEqOutCenterFrequencyChanged(val);
     }
@@ -112,10 +96,7 @@ void DspRadio::setBandpassEqOutBandWidth(QString name, double val)
 {
     if (name.isEmpty() || (name == m_channel_type))
     {
-        if (f_m_o)
-            f_m_o->setParam(3,val);
-        if (f_s_o)
-            f_s_o->setParam(3,val);
+        m_eq_out.bandWidth = val;
 
         emit bandpassEqOutBandWidthChanged(val);
     }
@@ -126,7 +107,6 @@ void DspRadio::do_process(float *samples, int sampleCount, float &volFollow)
     // ALL INPUTS AND OUTPUTS IN THIS ARE -1.0f and +1.0f
     // Find volume of current block of frames...
     float vol = 0.0f;
- //   float min = 1.0f, max = -1.0f;
     for (int i = 0; i < sampleCount; i++)
     {
        vol += (samples[i] * samples[i]);
@@ -139,95 +119,141 @@ void DspRadio::do_process(float *samples, int sampleCount, float &volFollow)
     // Smooth follow from last frame, both multiplies add up to 1...
     volFollow = volFollow * 0.5f + vol * 0.5f;
 
-    // Between -1.0f and 1.0f...
-    float random = (((float)(rand()&32767)) / 16384.0f) - 1.0f;
+    // Noise table: a random value between -1.0f and 1.0f, held for 1 to 128 samples
+    QVarLengthArray<float,480> noise(sampleCount);
+    for (int i = 0; i < sampleCount;)
+    {
+        const auto kRandom = m_random.nextBipolar();
+        const auto kHold = qMin((int)(m_random.next() & 127) + 1, sampleCount - i);
+        std::fill(noise.data() + i, noise.data() + i + kHold, kRandom);
+        i += kHold;
+    }
 
-    // Between 1 and 128...
-    int count = (rand() & 127) + 1;
-    float temp;
-    for (int i = 0; i < sampleCount; i++)
+    // Add the noise * by current volume, quantise massively to 40 steps and mix it in by fudge
+    DspKernels::QuantiseMix(samples, noise.constData(), sampleCount, volFollow, 40.0f, 0.05f * (float)getFudge());
+}
+
+void DspRadio::do_process_ring_mod(float *samples, int sampleCount, DspOscillator &oscillator)
+{
+    const auto kModFreq = m_rm_mod_freq;
+    const auto kMix = m_rm_mix;
+    if ((kModFreq != 0.0f) && (kMix != 0.0f))
     {
-       if (!count--)
-       {
-//          // Between -1.0f and 1.0f...
-          random = (((float)(rand()&32767)) / 16384.0f) - 1.0f;
-//          // Between 1 and 128...
-          count = (rand() & 127) + 1;
-       }
-        // Add random to inputs * by current volume;
-       temp = samples[i] + random * volFollow;
-
-       // Make it an integer between -60 and 60
-       temp = (int)(temp * 40.0f);
-
-       // Drop it back down but massively quantised and too high
-       temp = (temp / 40.0f);
-       temp *= 0.05 * (float)getFudge();
-       temp += samples[i] * (1 - (0.05 * (float)getFudge()));
-       samples[i] = qBound(-1.0f,temp,1.0f);
+        if (oscillator.getFrequency() != kModFreq)
+            oscillator.setFrequency(kModFreq, SAMPLE_RATE);
+
+        QVarLengthArray<float,480> modulator(sampleCount);
+        oscillator.render(modulator.data(), sampleCount);
+        DspKernels::Modulate(samples, modulator.constData(), sampleCount, (float)kMix);
     }
 }
 
-void DspRadio::do_process_ring_mod(float *samples, int sampleCount, double &modAngle)
+//! Glides the current parameters towards the target and redesigns the sections if they moved
+void DspRadio::Bandpass::update(int sampleCount)
 {
-    if ((m_rm_mod_freq != 0.0f) && (m_rm_mix != 0.0f))
+    // read the targets once, the gui thread may change them meanwhile
+    const auto kCenterFrequency = centerFrequency;
+    const auto kBandWidth = bandWidth;
+
+    if (centerFrequencyCurrent < 0.0)
     {
-        for(int i=0; i<sampleCount; ++i)
+        centerFrequencyCurrent = kCenterFrequency;
+        bandWidthCurrent = kBandWidth;
+    }
+    else if ((kCenterFrequency == centerFrequencyCurrent) && (kBandWidth == bandWidthCurrent))
+        return;
+    else
+    {
+        // (re)start the transition from where we are when the target moved
+        if ((transitionRemaining == 0) || (kCenterFrequency != centerFrequencyTo) || (kBandWidth != bandWidthTo))
         {
-            float sample = samples[i];
-            sample = (sample * (1-m_rm_mix)) + (m_rm_mix * (sample * sin(modAngle)));
-            samples[i] = qBound(-1.0f,sample,1.0f);
-            modAngle += m_rm_mod_freq * TWO_PI_OVER_SAMPLE_RATE;
+            centerFrequencyFrom = centerFrequencyCurrent;
+            bandWidthFrom = bandWidthCurrent;
+            centerFrequencyTo = kCenterFrequency;
+            bandWidthTo = kBandWidth;
+            transitionRemaining = BANDPASS_TRANSITION_SAMPLES;
         }
+        transitionRemaining = qMax(0, transitionRemaining - sampleCount);
+
+        const double t = 1.0 - ((double)transitionRemaining / BANDPASS_TRANSITION_SAMPLES);
+        centerFrequencyCurrent = centerFrequencyFrom + (centerFrequencyTo - centerFrequencyFrom) * t;
+        bandWidthCurrent = bandWidthFrom + (bandWidthTo - bandWidthFrom) * t;
     }
+
+    Dsp::Butterworth::BandPass<BANDPASS_ORDER> design;
+    design.setup(BANDPASS_ORDER, SAMPLE_RATE, centerFrequencyCurrent, bandWidthCurrent);
+    cascade.setLane(0, design);
+    cascade.setLane(1, design);
 }
 
-void DspRadio::process(short *samples, int sampleCount, int channels)
+//! Packs the channels into the lanes of the cascade, filters them in one go and unpacks them
+void DspRadio::Bandpass::process(float **channelData, int channels, int sampleCount)
 {
-//    Dsp::Filter* f = (channels==1)?f_m:f_s;
+    const auto kLanes = BandpassCascade::Lanes;
+    QVarLengthArray<double, 480 * BandpassCascade::Lanes> frames(sampleCount * kLanes);
+    auto frame = frames.data();
+    for (int i = 0; i < sampleCount; ++i, frame += kLanes)
+    {
+        for (int lane = 0; lane < kLanes; ++lane)
+            frame[lane] = (lane < channels) ? channelData[lane][i] : 0.0;
+    }
+
+    cascade.process(sampleCount, frames.data());
 
+    frame = frames.data();
+    for (int i = 0; i < sampleCount; ++i, frame += kLanes)
+    {
+        for (int lane = 0; lane < channels; ++lane)
+            channelData[lane][i] = (float)frame[lane];
+    }
+}
+
+//! Runs the radio fx on the float bus of the voice chain
+/*!
+ * \brief DspRadio::process mono is filtered in place, stereo is split into planes and re-interleaved
+ * \param samples the interleaved float bus to manipulate, -1.0f...+1.0f
+ * \param sampleCount amount of samples per channel
+ * \param channels amount of channels
+ */
+void DspRadio::process(float *samples, int sampleCount, int channels)
+{
     if (!getEnabled())
         return;
 
+    m_eq_in.update(sampleCount);
+    m_eq_out.update(sampleCount);
+
     if (channels == 1)
     {
-        QVarLengthArray<float,480> data(sampleCount); //Test has been 480
-        for(int i=0; i<sampleCount; ++i)
-            data[i] = samples[i] / 32768.f;
-
         float* audioData[1];
-        audioData[0] = data.data();
-        f_m->process(sampleCount,audioData);
+        audioData[0] = samples;
+        m_eq_in.process(audioData, 1, sampleCount);
 
-        do_process_ring_mod(data.data(), sampleCount, m_rm_mod_angle);
+        do_process_ring_mod(samples, sampleCount, m_rm_osc);
 
         if (getFudge() > 0.0f)
-            do_process(data.data(),sampleCount, m_vol_follow);
-
-        f_m_o->process(sampleCount,audioData);
-
-        for(int i=0; i<sampleCount; ++i)
-            samples[i] = (short)(data[i] * 32768.f);
+            do_process(samples,sampleCount, m_vol_follow);
 
+        m_eq_out.process(audioData, 1, sampleCount);
     }
     else if (channels == 2)
     {
-        // Extract from interleaved and convert to QVarLengthArray<float>
+        // Extract from interleaved
         QVarLengthArray<float,480> c_data_left(sampleCount);
         QVarLengthArray<float,480> c_data_right(sampleCount);
         for(int i=0; i<sampleCount; ++i)
         {
-            c_data_left[i] = samples[i*2] / 32768.f;
-            c_data_right[i] = samples[1 + (i*2)] / 32768.f;
+            c_data_left[i] = samples[i*2];
+            c_data_right[i] = samples[1 + (i*2)];
         }
 
         float* audioData[2];
         audioData[0] = c_data_left.data();
         audioData[1] = c_data_right.data();
-        f_s->process(sampleCount,audioData);
+        m_eq_in.process(audioData, 2, sampleCount);
 
-        do_process_ring_mod(c_data_left.data(), sampleCount, m_rm_mod_angle);
-        do_process_ring_mod(c_data_right.data(), sampleCount, m_rm_mod_angle_r);
+        do_process_ring_mod(c_data_left.data(), sampleCount, m_rm_osc);
+        do_process_ring_mod(c_data_right.data(), sampleCount, m_rm_osc_r);
 
         if (getFudge() > 0.0f)
         {
@@ -235,12 +261,12 @@ void DspRadio::process(short *samples, int sampleCount, int channels)
             do_process(c_data_right.data(),sampleCount, m_vol_follow_r);
         }
 
-        f_s_o->process(sampleCount,audioData);
+        m_eq_out.process(audioData, 2, sampleCount);
 
         for(int i=0; i<sampleCount; ++i)
         {
-            samples[i*2] = (short)(c_data_left[i] * 32768.f);
-            samples[1 + (i*2)] = (short)(c_data_right[i] * 32768.f);
+            samples[i*2] = c_data_left[i];
+            samples[1 + (i*2)] = c_data_right[i];
         }
     }
 }
@@ -250,6 +276,12 @@ void DspRadio::setChannelType(QString name)
     m_channel_type = name;
 }
 
+//! Seeds the noise generator; the same seed and input give the same output
+void DspRadio::setSeed(quint32 seed)
+{
+    m_random.setSeed(seed);
+}
+
 float DspRadio::getFudge() const
 {
     return m_fudge;
@@ -257,22 +289,12 @@ float DspRadio::getFudge() const
 
 double DspRadio::getBandpassEqInCenterFrequency() const
 {
-    if (f_m)
-        return f_m->getParam(2);
-    else if (f_s)
-        return f_s->getParam(2);
-    else
-        return -1;
+    return m_eq_in.centerFrequency;
 }
 
 double DspRadio::getBandpassEqInBandWidth() const
 {
-    if (f_m)
-        return f_m->getParam(3);
-    else if (f_s)
-        return f_s->getParam(3);
-    else
-        return -1;
+    return m_eq_in.bandWidth;
 }
 
 double DspRadio::getRmModFreq() const
@@ -282,20 +304,10 @@ double DspRadio::getRmModFreq() const
 
 double DspRadio::getBandpassEqOutCenterFrequency() const
 {
-    if (f_m_o)
-        return f_m_o->getParam(2);
-    else if (f_s_o)
-        return f_s_o->getParam(2);
-    else
-        return -1;
+    return m_eq_out.centerFrequency;
 }
 
 double DspRadio::getBandpassEqOutBandWidth() const
 {
-    if (f_m_o)
-        return f_m_o->getParam(3);
-    else if (f_s_o)
-        return f_s_o->getParam(3);
-    else
-        return -1;
+    return m_eq_out.bandWidth;
 }
@@ -2,7 +2,9 @@
 
 #include <QObject>
 #include "DspFilters/Dsp.h"
-#include <memory>
+#include "DspFilters/SimdCascade.h"
+#include "dsp_random.h"
+#include "dsp_oscillator.h"
 
 class DspRadio : public QObject
 {
@@ -17,9 +19,10 @@ class DspRadio : public QObject
 public:
     explicit DspRadio(QObject *parent = 0);
     
-    void process(short* samples, int sampleCount, int channels);
+    void process(float* samples, int sampleCount, int channels);
 
     void setChannelType(QString name);
+    void setSeed(quint32 seed);
 
     bool getEnabled() const {return m_enabled;}
     float getFudge() const;
@@ -50,27 +53,45 @@ public slots:
     void setBandpassEqOutBandWidth(QString name, double val);
 
 private:
+    typedef Dsp::SimdCascade<4, double> BandpassCascade;   // 4th order band pass: 4 sections
+
+    //! Butterworth band pass running one channel per lane
+    struct Bandpass
+    {
+        double centerFrequency = 1600.0;    // target, set from the gui thread
+        double bandWidth = 1300.0;
+        double centerFrequencyCurrent = -1.0;   // playback thread, glides towards the target
+        double bandWidthCurrent = -1.0;
+        double centerFrequencyFrom = 0.0;    // transition
+        double bandWidthFrom = 0.0;
+        double centerFrequencyTo = 0.0;
+        double bandWidthTo = 0.0;
+        int transitionRemaining = 0;
+        BandpassCascade cascade;
+
+        void update(int sampleCount);
+        void process(float** channelData, int channels, int sampleCount);
+    };
+
     void do_process(float *samples, int sampleCount, float &volFollow);
-    void do_process_ring_mod(float *samples, int sampleCount, double &modAngle);
+    void do_process_ring_mod(float *samples, int sampleCount, DspOscillator &oscillator);
 
     QString m_channel_type;
 
+    DspRandom m_random;     // noise, playback thread
     float m_vol_follow = 0.0f;
     float m_vol_follow_r = 0.0f;
 
     bool m_enabled;
     double m_fudge = 0.0f;
 
-    std::unique_ptr<Dsp::Filter> f_m = std::make_unique< Dsp::SmoothedFilterDesign<Dsp::Butterworth::Design::BandPass <4>, 1, Dsp::DirectFormII> >(1024);
-    std::unique_ptr<Dsp::Filter> f_s = std::make_unique< Dsp::SmoothedFilterDesign<Dsp::Butterworth::Design::BandPass <4>, 2, Dsp::DirectFormII> >(1024);
-
-    std::unique_ptr<Dsp::Filter> f_m_o = std::make_unique< Dsp::SmoothedFilterDesign<Dsp::Butterworth::Design::BandPass <4>, 1, Dsp::DirectFormII> >(1024);
-    std::unique_ptr<Dsp::Filter> f_s_o = std::make_unique< Dsp::SmoothedFilterDesign<Dsp::Butterworth::Design::BandPass <4>, 2, Dsp::DirectFormII> >(1024);
+    Bandpass m_eq_in;
+    Bandpass m_eq_out;
 
     //RingMod
     double m_rm_mod_freq = 0.0f;
-    double m_rm_mod_angle = 0.0f;
-    double m_rm_mod_angle_r = 0.0f;
+    DspOscillator m_rm_osc;     // playback thread
+    DspOscillator m_rm_osc_r;
     double m_rm_mix = 0.0f;
 
 };
@@ -4,6 +4,7 @@
 #include "ts_serversinfo.h"
 #include "ts3_functions.h"
 #include "plugin.h"
+#include "voice_chain.h"
 #include "teamspeak/public_errors.h"
 
 Radio::Radio(QObject *parent)
@@ -190,12 +191,9 @@ void Radio::ToggleClientBlacklisted(uint64 serverConnectionHandlerID, anyID clie
     if (!(isRunning()))
         return;
 
-    if (!(m_talkers_dspradios.contains(serverConnectionHandlerID)))
-        return;
-
-    auto sDspRadios = m_talkers_dspradios.value(serverConnectionHandlerID);
-    if (sDspRadios->contains(clientID))
-        sDspRadios->value(clientID)->setEnabled(QString::null,!isClientBlacklisted(serverConnectionHandlerID,clientID));
+    auto dsp_obj = m_talkers_dspradios.value(serverConnectionHandlerID,clientID);
+    if (dsp_obj)
+        dsp_obj->setEnabled(QString::null,!isClientBlacklisted(serverConnectionHandlerID,clientID));
 }
 
 bool Radio::isClientBlacklisted(uint64 serverConnectionHandlerID, anyID clientID)
@@ -237,32 +235,24 @@ bool Radio::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bo
                 return false;
         }
 
-        DspRadio* dsp_obj;
-        auto isNewDspObj = true;
-        if (!(m_talkers_dspradios.contains(serverConnectionHandlerID)))
-        {
-            dsp_obj = new DspRadio(this);
-            auto sDspRadios = new QHash<anyID,DspRadio*>;
-            sDspRadios->insert(clientID,dsp_obj);
-            m_talkers_dspradios.insert(serverConnectionHandlerID,sDspRadios);
-        }
-        else
+        auto dsp_obj = m_talkers_dspradios.value(serverConnectionHandlerID,clientID);
+        auto isNewDspObj = (dsp_obj == nullptr);
+        if (isNewDspObj)
         {
-            auto sDspRadios = m_talkers_dspradios.value(serverConnectionHandlerID);
-            if (sDspRadios->contains(clientID))
-            {
-                dsp_obj = sDspRadios->value(clientID);
-                isNewDspObj = false;
-            }
-            else
+            if (m_talkers_dspradios.isFull())
             {
-                dsp_obj = new DspRadio(this);
-                sDspRadios->insert(clientID, dsp_obj);
+                this->Error("Too many talkers, skipping", serverConnectionHandlerID, NULL);
+                return false;
             }
+            dsp_obj = new DspRadio(this);
+            dsp_obj->setSeed(SlotTableHelpers::hashKey(serverConnectionHandlerID,clientID));    // no correlated noise across talkers
+            m_talkers_dspradios.insert(serverConnectionHandlerID,clientID,dsp_obj);
         }
 
         if (!isNewDspObj)
             this->disconnect(dsp_obj);
+        else
+            VoiceChain::instance()->Invalidate();
 
         RadioFX_Settings settings;
         if (isReceivedWhisper)
@@ -309,45 +299,31 @@ bool Radio::onTalkStatusChanged(uint64 serverConnectionHandlerID, int status, bo
     else if (status == STATUS_NOT_TALKING)
     {
         // Removing does not need to be robust against multiple STATUS_NOT_TALKING in a row, since that doesn't happen on user setting change
-        if (!m_talkers_dspradios.contains(serverConnectionHandlerID))
+        DspRadio* dsp_obj;
+        if (!m_talkers_dspradios.take(serverConnectionHandlerID,clientID,dsp_obj))
             return false;   // return silent bec. of ChannelMuter implementation
 
-        auto server_dsp_radios = m_talkers_dspradios.value(serverConnectionHandlerID);
-        if (!(server_dsp_radios->contains(clientID)))
-            return false;
-
-        auto dsp_obj = server_dsp_radios->value(clientID);
-        dsp_obj->blockSignals(true);
         const auto kIsEnabled = dsp_obj->getEnabled();
-        dsp_obj->deleteLater();
-        server_dsp_radios->remove(clientID);
+        VoiceChain::instance()->Retire(dsp_obj);
         return kIsEnabled;
     }
     return false;
 }
 
-//! Routes the arguments of the event to the corresponding volume object
+//! Hands the radio fx of the talkers to the voice chain
 /*!
- * \brief Radio::onEditPlaybackVoiceDataEvent pre-processing voice event
- * \param serverConnectionHandlerID the connection id of the server
- * \param clientID the client-side runtime-id of the sender
- * \param samples the sample array to manipulate
- * \param sampleCount amount of samples in the array
- * \param channels amount of channels
+ * \brief Radio::PopulateVoiceChain gui thread; called on every rebuild of the chain
+ * \param builder the chain under construction
  */
-void Radio::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+void Radio::PopulateVoiceChain(VoiceChainBuilder &builder) const
 {
     if (!(isRunning()))
         return;
 
-    if (!(m_talkers_dspradios.contains(serverConnectionHandlerID)))
-        return;
-
-    auto server_dsp_radios = m_talkers_dspradios.value(serverConnectionHandlerID);
-    if (!(server_dsp_radios->contains(clientID)))
-        return;
-
-    server_dsp_radios->value(clientID)->process(samples,sampleCount,channels);
+    m_talkers_dspradios.forEach([&builder](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspRadio*> &dsp_obj)
+    {
+        builder.node(serverConnectionHandlerID,clientID).radio = dsp_obj;
+    });
 }
 
 QHash<QString, RadioFX_Settings> Radio::GetSettingsMap() const
@@ -3,8 +3,12 @@
 #include <QObject>
 
 #include "module.h"
+#include "voice_chain.h"
 #include "talkers.h"
 #include "dsp_radio.h"
+#include "slot_table.h"
+
+const int RADIO_CAPACITY = 512;     // concurrent talkers
 
 struct RadioFX_Settings
 {
@@ -36,7 +40,7 @@ public:
     bool isClientBlacklisted(uint64 serverConnectionHandlerID, anyID clientID);
 
     // events forwarded from plugin.cpp
-    void onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels);
+    void PopulateVoiceChain(VoiceChainBuilder &builder) const;
 
     QHash<QString, RadioFX_Settings> GetSettingsMap() const;
     QHash<QString, RadioFX_Settings>& GetSettingsMapRef();
@@ -74,7 +78,7 @@ private:
     uint64 m_homeId = 0;
     Talkers* talkers;
 
-    QHash<uint64,QHash<anyID,DspRadio*>* > m_talkers_dspradios;
+    SlotTable<DspRadio*, RADIO_CAPACITY> m_talkers_dspradios;
 
     QHash<QString,RadioFX_Settings> m_SettingsMap;
 
@@ -34,6 +34,7 @@ void SettingsPositionSpread::Init(PositionSpread *positionSpread)
     positionSpread->setEnabled(cfg.value("stereo_position_spread_enabled",true).toBool());
     positionSpread->setSpreadWidth(cfg.value("stereo_position_spread_value",0.5f).toFloat());
     positionSpread->setExpertModeEnabled(cfg.value("stereo_position_spread_expert_enabled",false).toBool());
+    positionSpread->setSurroundEnabled(cfg.value("stereo_position_spread_surround_enabled",false).toBool());
     positionSpread->setRegionHomeTab(cfg.value("stereo_position_spread_region_home",1).toInt());
     positionSpread->setRegionWhisper(cfg.value("stereo_position_spread_region_whisper",2).toInt());
     positionSpread->setRegionOther(cfg.value("stereo_position_spread_region_other",0).toInt());
@@ -103,6 +104,7 @@ void SettingsPositionSpread::saveSettings(int r)
     cfg.setValue("stereo_position_spread_value",mP_positionSpread.data()->getSpreadWidth());
 
     cfg.setValue("stereo_position_spread_expert_enabled",mP_positionSpread.data()->isExpertModeEnabled());
+    cfg.setValue("stereo_position_spread_surround_enabled",mP_positionSpread.data()->isSurroundEnabled());
     cfg.setValue("stereo_position_spread_region_home",(int)(mP_positionSpread.data()->getRegionHomeTab()));
     cfg.setValue("stereo_position_spread_region_whisper",(int)(mP_positionSpread.data()->getRegionWhisper()));
     cfg.setValue("stereo_position_spread_region_other",(int)(mP_positionSpread.data()->getRegionOther()));
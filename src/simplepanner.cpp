@@ -1,5 +1,10 @@
 #include "simplepanner.h"
 
+#include "dsp_kernels.h"
+
+#include <QVarLengthArray>
+#include <algorithm>
+
 #include <math.h>
 
 #ifndef M_PI
@@ -177,31 +182,31 @@ void SimplePanner::setPanAdjustment(bool value)
 //    }
 //}
 
-void SimplePanner::process(int nSamples,
-                      QList<float> *pleft,
-                      QList<float> *pright,
-                      float balance // -1...+1
-                      )
+//! Linear channel gains for a balance
+/*!
+ * \brief SimplePanner::GetChannelGains constant power pan law
+ * \param balance -1...+1
+ * \param gainLeft receives the gain of the left channel
+ * \param gainRight receives the gain of the right channel
+ */
+void SimplePanner::GetChannelGains(float balance, float &gainLeft, float &gainRight)
 {
     balance = balance < -1 ? -1 : balance;
     balance = balance > 1 ? 1 : balance;
 
-    float p, gl, gr;
-
-    p=M_PI*(balance+1)/4;
-    gl=::cos(p);
-    gr=::sin(p);
-
-    for (int i = 0; i<nSamples;++i)
-    {
-        pleft->replace(i, (pleft->at(i) * gl));
-        pright->replace(i, (pright->at(i) * gr));
-    }
+    float p=M_PI*(balance+1)/4;
+    gainLeft=::cos(p);
+    gainRight=::sin(p);
 }
 
-void SimplePanner::process(short *samples, int sampleCount, int channels,int leftChannelNr, int rightChannelNr)
+//! Moves the current pan towards the desired one by the duration of a buffer
+/*!
+ * \brief SimplePanner::advancePan
+ * \param sampleCount amount of samples per channel of the buffer
+ * \return the pan of the buffer
+ */
+float SimplePanner::advancePan(int sampleCount)
 {
-    // Determine Pan for current buffer
     auto currentPan = getPanCurrent();
     auto desiredPan = getPanDesired();
     auto desiredPanByManual = getPanDesiredByManual();
@@ -235,7 +240,6 @@ void SimplePanner::process(short *samples, int sampleCount, int channels,int lef
                 currentPan = desiredPanByManual;
             }
         }
-        emit ChannelPanAdjusted(currentPan);
     }
     else if (currentPan != desiredPanByManual) {
         float fade_step = (PAN_FADE_RATE / sampleRate) * sampleCount;
@@ -250,39 +254,79 @@ void SimplePanner::process(short *samples, int sampleCount, int channels,int lef
         }
     }
     setPanCurrent(currentPan);
+    return currentPan;
+}
 
-    // End Determine Pan for current buffer
+void SimplePanner::process(short *samples, int sampleCount, int channels,int leftChannelNr, int rightChannelNr)
+{
+    const auto currentPan = advancePan(sampleCount);
+    isSurroundGainsPreviousValid = false;
 
-    // Extract from interleaved and convert to QList<float>
-    QList<float> float_data_left;
-    QList<float> float_data_right;
-    for(int i=0; i < sampleCount; ++i)
+    // Ramp from the gains of the previous buffer, so pan changes don't step
+    float gainLeft, gainRight;
+    GetChannelGains(currentPan, gainLeft, gainRight);
+    if (!isGainPreviousValid)
     {
-        float_data_left.insert(i,samples[leftChannelNr + (i*channels) ]);
-        float_data_right.insert(i,samples[rightChannelNr + (i*channels) ]);
+        gainLeftPrevious = gainLeft;
+        gainRightPrevious = gainRight;
+        isGainPreviousValid = true;
     }
 
-    //don't need to adjust the range to -1 - +1 do we?
+    DspKernels::PanInterleaved(samples, sampleCount, channels, leftChannelNr, rightChannelNr,
+                               gainLeftPrevious, gainRightPrevious, gainLeft, gainRight);
 
-    process(sampleCount,&float_data_left,&float_data_right,currentPan);
+    gainLeftPrevious = gainLeft;
+    gainRightPrevious = gainRight;
+}
 
-    // put it back into interleaved and Clip
+//! Pans across all speakers of a surround layout
+/*!
+ * \brief SimplePanner::processSurround the filled channels are downmixed to mono, then every channel of the layout is
+ * rewritten with its VBAP gain for the current pan, ramped from the gains of the previous buffer
+ * \param samples the interleaved sample array to manipulate
+ * \param sampleCount amount of samples per channel
+ * \param channels amount of channels
+ * \param vbap the layout, set up for channels
+ * \param channelFillMask the channels carrying data; receives the channels of the layout
+ */
+void SimplePanner::processSurround(short *samples, int sampleCount, int channels, const Vbap &vbap, unsigned int *channelFillMask)
+{
+    const auto currentPan = advancePan(sampleCount);
+    isGainPreviousValid = false;
+
+    if ((sampleCount <= 0) || (channels != vbap.getChannels()))
+        return;
+
+    float gains[Vbap::MAX_CHANNELS];
+    vbap.panGains(currentPan, gains);
+    if (!isSurroundGainsPreviousValid)
+    {
+        std::copy(gains, gains + channels, surroundGainsPrevious);
+        isSurroundGainsPreviousValid = true;
+    }
+
+    int filled[Vbap::MAX_CHANNELS];
+    int filledCount = 0;
+    for (int channel = 0; channel < channels; ++channel)
+    {
+        if (*channelFillMask & (1u << channel))
+            filled[filledCount++] = channel;
+    }
+    if (filledCount == 0)
+        return;
+
+    QVarLengthArray<float, 2048> mono(sampleCount);
+    const auto kScale = 1.0f / filledCount;
     for (int i = 0; i < sampleCount; ++i)
     {
-        auto left = float_data_left.at(i);
-        if (left > 32767.f)
-            samples[leftChannelNr + (i*channels) ] = 32767;
-        else if (left < -32768.f)
-            samples[leftChannelNr + (i*channels) ] = -32768;
-        else
-            samples[leftChannelNr + (i*channels) ] = (short)floor(.5+left);
-
-        float right = float_data_right.at(i);
-        if (right > 32767.f)
-            samples[rightChannelNr + (i*channels) ] = 32767;
-        else if (right < -32768.f)
-            samples[rightChannelNr + (i*channels) ] = -32768;
-        else
-            samples[rightChannelNr + (i*channels) ] = (short)floor(.5+right);
+        auto sum = 0.0f;
+        for (int j = 0; j < filledCount; ++j)
+            sum += samples[filled[j] + (i * channels)];
+        mono[i] = sum * kScale;
     }
+
+    DspKernels::MixMonoInterleaved(mono.constData(), samples, sampleCount, channels, surroundGainsPrevious, gains);
+    *channelFillMask |= vbap.getChannelMask();
+
+    std::copy(gains, gains + channels, surroundGainsPrevious);
 }
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QObject>
+#include "vbap.h"
 
 class SimplePanner : public QObject
 {
@@ -32,7 +33,6 @@ public:
 signals:
     void ApaAttackRateChanged(float);
     void ApaDecayRateChanged(float);
-    void ChannelPanAdjusted(float);
 
 public slots:
     void setApaAttackRate(float);
@@ -42,12 +42,21 @@ public slots:
 
 
     void process(short *samples, int sampleCount, int channels, int leftChannelNr, int rightChannelNr);
+    void processSurround(short *samples, int sampleCount, int channels, const Vbap &vbap, unsigned int *channelFillMask);
 
 private:
     //void process(int sampleCount, short *pleft, short *pright);
-    static void process(int nSamples, QList<float> *pleft, QList<float> *pright, float balance);
+    float advancePan(int sampleCount);
+    static void GetChannelGains(float balance, float &gainLeft, float &gainRight);
     unsigned short sampleRate = 48000;
 
+    // gains applied at the end of the previous buffer
+    float gainLeftPrevious = 0.0f;
+    float gainRightPrevious = 0.0f;
+    bool isGainPreviousValid = false;
+    float surroundGainsPrevious[Vbap::MAX_CHANNELS];
+    bool isSurroundGainsPreviousValid = false;
+
     bool panAdjustment = false;
 
     // Property Privates
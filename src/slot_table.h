@@ -0,0 +1,215 @@
+#pragma once
+
+#include <QAtomicInteger>
+#include "teamspeak/public_definitions.h"
+
+//! Reference to a slot, carrying the generation it was taken at
+/*!
+ * get() returns the value only while the slot has not been removed / reused since; safe to call from any thread.
+ */
+template <typename T>
+struct SlotRef
+{
+    T value = T();
+    const QAtomicInteger<quint32>* generation = nullptr;
+    quint32 expected = 0;
+
+    T get() const
+    {
+        return (generation && (generation->loadAcquire() == expected)) ? value : T();
+    }
+
+    template <typename U>
+    SlotRef<U> staticCast() const
+    {
+        SlotRef<U> ref;
+        ref.value = static_cast<U>(value);
+        ref.generation = generation;
+        ref.expected = expected;
+        return ref;
+    }
+};
+
+namespace SlotTableHelpers
+{
+    constexpr int nextPow2(int val, int pow = 1)
+    {
+        return (pow >= val) ? pow : nextPow2(val, pow * 2);
+    }
+
+    inline quint32 hashKey(uint64 serverConnectionHandlerID, anyID clientID)
+    {
+        quint64 key = (serverConnectionHandlerID << 16) ^ clientID;
+        key *= Q_UINT64_C(0x9E3779B97F4A7C15);    // fibonacci hashing
+        return (quint32)(key >> 32);
+    }
+}
+
+//! Fixed-capacity table of per client state, keyed by (server connection, client)
+/*!
+ * Storage and key index are allocated with the table; insert / remove never allocate and fail instead when the table is full.
+ * Every slot has a generation counter, odd while the slot is in use. It is bumped on insert and on remove,
+ * so a SlotRef taken before a removal can never see the next occupant of the slot.
+ * Structural changes belong to one thread (the gui thread), SlotRef::get may be called from any.
+ */
+template <typename T, int Capacity>
+class SlotTable
+{
+    static_assert((Capacity > 0) && (Capacity < 0xFFFF), "SlotTable capacity out of range");
+
+public:
+    SlotTable()
+    {
+        for (int i = 0; i < Capacity; ++i)
+            m_slots[i].nextFree = i + 1;
+
+        for (int i = 0; i < kIndexCapacity; ++i)
+            m_index[i] = 0;
+    }
+
+    int capacity() const {return Capacity;}
+    int size() const {return m_size;}
+    bool isEmpty() const {return (m_size == 0);}
+    bool isFull() const {return (m_size == Capacity);}
+
+    //! Stores a value for a key not yet in the table; returns an empty ref when the key exists or the table is full
+    SlotRef<T> insert(uint64 serverConnectionHandlerID, anyID clientID, const T& value)
+    {
+        if (isFull() || (findIndex(serverConnectionHandlerID, clientID) != -1))
+            return SlotRef<T>();
+
+        const auto kSlotNr = m_freeHead;
+        auto &slot = m_slots[kSlotNr];
+        m_freeHead = slot.nextFree;
+
+        slot.value = value;
+        slot.serverConnectionHandlerID = serverConnectionHandlerID;
+        slot.clientID = clientID;
+        slot.generation.storeRelease(slot.generation.load() + 1);    // odd: in use
+        ++m_size;
+
+        auto i = SlotTableHelpers::hashKey(serverConnectionHandlerID, clientID) & kIndexMask;
+        while (m_index[i] != 0)
+            i = (i + 1) & kIndexMask;
+
+        m_index[i] = kSlotNr + 1;
+        return ref(kSlotNr);
+    }
+
+    //! Returns a ref to the value of a key; empty if not found
+    SlotRef<T> find(uint64 serverConnectionHandlerID, anyID clientID) const
+    {
+        const auto kIndexNr = findIndex(serverConnectionHandlerID, clientID);
+        return (kIndexNr == -1) ? SlotRef<T>() : ref(m_index[kIndexNr] - 1);
+    }
+
+    bool contains(uint64 serverConnectionHandlerID, anyID clientID) const
+    {
+        return (findIndex(serverConnectionHandlerID, clientID) != -1);
+    }
+
+    T value(uint64 serverConnectionHandlerID, anyID clientID) const
+    {
+        const auto kIndexNr = findIndex(serverConnectionHandlerID, clientID);
+        return (kIndexNr == -1) ? T() : m_slots[m_index[kIndexNr] - 1].value;
+    }
+
+    //! Removes a key, handing out its value; returns false if not found
+    bool take(uint64 serverConnectionHandlerID, anyID clientID, T& value)
+    {
+        const auto kIndexNr = findIndex(serverConnectionHandlerID, clientID);
+        if (kIndexNr == -1)
+            return false;
+
+        const auto kSlotNr = m_index[kIndexNr] - 1;
+        auto &slot = m_slots[kSlotNr];
+        value = slot.value;
+        slot.value = T();
+        slot.generation.storeRelease(slot.generation.load() + 1);    // even: free, invalidates all refs
+        slot.nextFree = m_freeHead;
+        m_freeHead = kSlotNr;
+        --m_size;
+
+        removeIndex(kIndexNr);
+        return true;
+    }
+
+    //! Calls f(serverConnectionHandlerID, clientID, const SlotRef<T>&) for every value in the table
+    template <typename F>
+    void forEach(F f) const
+    {
+        if (m_size == 0)
+            return;
+
+        for (int i = 0; i < Capacity; ++i)
+        {
+            if (m_slots[i].generation.load() & 1)
+                f(m_slots[i].serverConnectionHandlerID, m_slots[i].clientID, ref(i));
+        }
+    }
+
+private:
+    static const int kIndexCapacity = SlotTableHelpers::nextPow2(Capacity * 2);  // load factor <= 0.5
+    static const quint32 kIndexMask = kIndexCapacity - 1;
+
+    struct Slot
+    {
+        T value = T();
+        uint64 serverConnectionHandlerID = 0;
+        anyID clientID = 0;
+        int nextFree = 0;
+        QAtomicInteger<quint32> generation;
+    };
+
+    SlotRef<T> ref(int slotNr) const
+    {
+        SlotRef<T> ref;
+        ref.value = m_slots[slotNr].value;
+        ref.generation = &m_slots[slotNr].generation;
+        ref.expected = m_slots[slotNr].generation.load();
+        return ref;
+    }
+
+    int findIndex(uint64 serverConnectionHandlerID, anyID clientID) const
+    {
+        auto i = SlotTableHelpers::hashKey(serverConnectionHandlerID, clientID) & kIndexMask;
+        while (m_index[i] != 0)
+        {
+            const auto &slot = m_slots[m_index[i] - 1];
+            if ((slot.serverConnectionHandlerID == serverConnectionHandlerID) && (slot.clientID == clientID))
+                return i;
+
+            i = (i + 1) & kIndexMask;
+        }
+        return -1;
+    }
+
+    // linear probing without tombstones: shift the following entries of the cluster back
+    void removeIndex(quint32 hole)
+    {
+        m_index[hole] = 0;
+        auto i = hole;
+        for (;;)
+        {
+            i = (i + 1) & kIndexMask;
+            if (m_index[i] == 0)
+                return;
+
+            const auto &slot = m_slots[m_index[i] - 1];
+            const auto kHome = SlotTableHelpers::hashKey(slot.serverConnectionHandlerID, slot.clientID) & kIndexMask;
+            // move if the home position is not within (hole, i]
+            const auto kIsInRange = (hole <= i) ? ((hole < kHome) && (kHome <= i)) : ((hole < kHome) || (kHome <= i));
+            if (!kIsInRange)
+            {
+                m_index[hole] = m_index[i];
+                m_index[i] = 0;
+                hole = i;
+            }
+        }
+    }
+
+    Slot m_slots[Capacity];
+    quint16 m_index[kIndexCapacity];   // slot number + 1, 0 is empty
+    int m_freeHead = 0;
+    int m_size = 0;
+};
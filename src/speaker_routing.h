@@ -0,0 +1,145 @@
+#pragma once
+
+#include <QtGlobal>
+#include "teamspeak/public_definitions.h"
+#include "vbap.h"
+
+//! Where the stereo panner writes to on the current playback device
+struct SpeakerRoute
+{
+    enum Mode
+    {
+        None = 0,       // no usable speakers, leave the block alone
+        Stereo,         // pan between left and right
+        CenterToFront,  // mono center, move it to front left / right, then pan
+        NoFront         // center only, but the layout has no front left / right to move it to
+    };
+
+    Mode mode = None;
+    int left = -1;
+    int right = -1;
+    int center = -1;
+    bool isSurround = false;    // speakers (not headphones) and SpeakerRouting::vbap() is valid
+};
+
+//! Caches the route for the speaker layout of the post process callback
+/*!
+ * The layout (channels, channelSpeakerArray, channelFillMask) only changes with the playback device,
+ * so the route and the VBAP base matrices are resolved once per layout; per block this is a hash of the speaker array
+ * and a compare.
+ * Not thread safe, owned by the consumer of the post process callback.
+ */
+class SpeakerRouting
+{
+public:
+    //! Updates the route if the layout differs from the last call
+    /*!
+     * \brief SpeakerRouting::update
+     * \param channels as in onEditPostProcessVoiceDataEvent
+     * \param channelSpeakerArray as in onEditPostProcessVoiceDataEvent
+     * \param channelFillMask as in onEditPostProcessVoiceDataEvent
+     * \return true if the route has been rebuilt
+     */
+    bool update(int channels, const unsigned int* channelSpeakerArray, unsigned int channelFillMask)
+    {
+        const auto kHash = hashSpeakers(channels, channelSpeakerArray);
+        if ((channels == m_channels) && (channelFillMask == m_fillMask) && (kHash == m_speakersHash))
+            return false;
+
+        m_channels = channels;
+        m_fillMask = channelFillMask;
+        m_speakersHash = kHash;
+        m_route = build(channels, channelSpeakerArray, channelFillMask);
+        const auto kHasSurround = m_vbap.setup(channels, channelSpeakerArray);
+        m_route.isSurround &= kHasSurround;
+        return true;
+    }
+
+    const SpeakerRoute& route() const {return m_route;}
+    const Vbap& vbap() const {return m_vbap;}
+
+private:
+    static quint32 hashSpeakers(int channels, const unsigned int* channelSpeakerArray)
+    {
+        // FNV-1a
+        auto hash = 2166136261u;
+        for (int i = 0; i < channels; ++i)
+        {
+            hash ^= channelSpeakerArray[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    //! Bit position of a single speaker flag, -1 for none / several
+    static int speakerBit(unsigned int speaker)
+    {
+        if ((speaker == 0) || (speaker & (speaker - 1)))
+            return -1;
+
+        auto bit = 0;
+        while ((1u << bit) != speaker)
+            ++bit;
+        return bit;
+    }
+
+    static SpeakerRoute build(int channels, const unsigned int* channelSpeakerArray, unsigned int channelFillMask)
+    {
+        // channel per speaker bit; later channels win like the former QMap::insert did
+        int filled[32];
+        int present[32];
+        for (int i = 0; i < 32; ++i)
+        {
+            filled[i] = -1;
+            present[i] = -1;
+        }
+
+        for (int i = 0; i < channels; ++i)
+        {
+            const auto kBit = speakerBit(channelSpeakerArray[i]);
+            if (kBit == -1)
+                continue;
+
+            if ((i < 32) && (channelFillMask & (1u << i)))
+                filled[kBit] = i;
+            if (present[kBit] == -1)
+                present[kBit] = i;
+        }
+
+        SpeakerRoute route;
+        const auto kHeadphonesLeft = filled[speakerBit(SPEAKER_HEADPHONES_LEFT)];
+        const auto kHeadphonesRight = filled[speakerBit(SPEAKER_HEADPHONES_RIGHT)];
+        const auto kFrontLeft = filled[speakerBit(SPEAKER_FRONT_LEFT)];
+        const auto kFrontCenter = filled[speakerBit(SPEAKER_FRONT_CENTER)];
+        if ((kHeadphonesLeft != -1) && (kHeadphonesRight != -1))
+        {
+            route.mode = SpeakerRoute::Stereo;
+            route.left = kHeadphonesLeft;
+            route.right = kHeadphonesRight;
+        }
+        else if (kFrontLeft != -1)
+        {
+            // a missing front right fell back to channel 0 before, keep it that way
+            route.mode = SpeakerRoute::Stereo;
+            route.isSurround = true;
+            route.left = kFrontLeft;
+            route.right = qMax(0, filled[speakerBit(SPEAKER_FRONT_RIGHT)]);
+        }
+        else if (kFrontCenter != -1)
+        {
+            // the front pair of the center fallback doesn't need to carry data
+            route.center = kFrontCenter;
+            route.left = present[speakerBit(SPEAKER_FRONT_LEFT)];
+            route.right = present[speakerBit(SPEAKER_FRONT_RIGHT)];
+            route.mode = ((route.left == -1) || (route.right == -1)) ? SpeakerRoute::NoFront : SpeakerRoute::CenterToFront;
+            route.isSurround = true;
+        }
+        return route;
+    }
+
+    int m_channels = -1;
+    unsigned int m_fillMask = 0;
+    quint32 m_speakersHash = 0;
+    SpeakerRoute m_route;
+    Vbap m_vbap;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QAtomicInteger>
+
+//! Lock-free ring buffer for exactly one producer thread and one consumer thread
+/*!
+ * Fixed capacity, no allocations after construction; push fails instead of blocking when the ring is full.
+ * Capacity must be a power of two.
+ */
+template <typename T, quint32 Capacity>
+class SpscRing
+{
+    static_assert((Capacity != 0) && ((Capacity & (Capacity - 1)) == 0), "SpscRing capacity must be a power of two");
+
+public:
+    // producer
+    bool push(const T& item)
+    {
+        const auto kHead = m_head.load();
+        if (kHead - m_tail.loadAcquire() >= Capacity)
+            return false;   // full
+
+        m_buffer[kHead & (Capacity - 1)] = item;
+        m_head.storeRelease(kHead + 1);
+        return true;
+    }
+
+    // consumer
+    bool pop(T& item)
+    {
+        const auto kTail = m_tail.load();
+        if (kTail == m_head.loadAcquire())
+            return false;   // empty
+
+        item = m_buffer[kTail & (Capacity - 1)];
+        m_tail.storeRelease(kTail + 1);
+        return true;
+    }
+
+private:
+    QAtomicInteger<quint32> m_head;  // written by the producer only
+    QAtomicInteger<quint32> m_tail;  // written by the consumer only
+    T m_buffer[Capacity];
+};
@@ -2,6 +2,22 @@
 
 #include "ts_logging_qt.h"
 
+namespace {
+
+const char *const kStreamPaths[SseServer::STREAM_COUNT] =
+{
+    "/positional_audio/stream",
+    "/talk_status/stream",
+    "/meters/stream"
+};
+
+const char kCorsHeaders[] =
+        "Access-Control-Allow-Origin: *\r\n"
+        "Access-Control-Allow-Headers: Cache-Control, Pragma, Origin, Authorization, Content-Type, X-Requested-With, Accept, Last-Event-ID\r\n"
+        "Access-Control-Allow-Methods: GET, OPTIONS\r\n";
+
+}
+
 SseServer::SseServer(QObject *parent, quint16 port) :
     QTcpServer(parent)
 {
@@ -9,7 +25,6 @@ SseServer::SseServer(QObject *parent, quint16 port) :
 //    setMaxPendingConnections(2);
     listen(QHostAddress::LocalHost, port);
     connect(this,SIGNAL(newConnection()),SLOT(onNewConnection()));
-    m_Sockets = new QSet<QTcpSocket*>;
     m_keepAlive = new QTimer(this);
     m_keepAlive->setSingleShot(false);
     m_keepAlive->setInterval(2000);
@@ -17,50 +32,121 @@ SseServer::SseServer(QObject *parent, quint16 port) :
     TSLogging::Log(this->objectName() + " started.");
 }
 
-void SseServer::Send(QTcpSocket *socket, QString val)
+void SseServer::Send(QString val)
 {
-    QTextStream os(socket);
-    os.setAutoDetectUnicode(true);
-    //os << //"HTTP/1.1 200 Ok\r\n"
-          //"Content-Type: text/event-stream\r\n"
-          //"Cache-Control: no-cache\r\n"
-          //"Access-Control-Allow-Origin: *\r\n"
-          //"Access-Control-Allow-Headers: Cache-Control, Pragma, Origin, Authorization, Content-Type, X-Requested-With\r\n"
-          //"Access-Control-Allow-Methods: GET, OPTIONS\r\n"
-          //"\r\n"
-     os <<     "data: "
-       << val << "\n\n";
-    os.flush();
+    Send(PositionalAudio, QString(), val.toUtf8());
 }
 
-void SseServer::Send(QString val)
+void SseServer::Send(int stream, const QString &key, const QByteArray &val)
+{
+    Send(stream, ++m_eventIds[stream], key, val);
+}
+
+//! Sends an event of UTF-8 data to the subscribers of a stream
+/*!
+ * The event is framed once; the subscribers' queues share its bytes.
+ * Browsers send the id of the last event they got as Last-Event-ID when reconnecting.
+ * The key names what the event is about (a player, a talker, a meter); see Enqueue.
+ */
+void SseServer::Send(int stream, quint64 id, const QString &key, const QByteArray &val)
 {
-    QSet<QTcpSocket*>::const_iterator i = m_Sockets->constBegin();
-    while (i != m_Sockets->constEnd())
+    if (m_subscriberCounts[stream] == 0)
+        return;
+
+    const auto kEvent = Frame(id, val);
+    QList<QTcpSocket*> overflowed;
+    for (auto it = m_Subscribers.begin(); it != m_Subscribers.end(); ++it)
     {
-        Send(*i,val);
-        ++i;
+        if ((it.value().stream == stream) && !Enqueue(it.key(), it.value(), key, kEvent))
+            overflowed.append(it.key());
     }
-//    QMap<QTcpSocket*,QTextStream*>::const_iterator i = m_SocketStreams.constBegin();
-//    while (i != m_SocketStreams.constEnd())
-//    {
-//        *i.value() << val;
-//        ++i;
-//    }
+
+    for (auto socket : overflowed)
+    {
+        TSLogging::Log(QString("%1: More than %2 events queued, disconnecting.").arg(socket->socketDescriptor()).arg(MAX_QUEUED_EVENTS), LogLevel_WARNING);
+        RemoveSubscriber(socket);
+        socket->abort();
+    }
+
+    DropStalled();
+
     if (m_keepAlive->isActive())
         m_keepAlive->start();
 }
 
-void SseServer::discardClient()
+QByteArray SseServer::Frame(quint64 id, const QByteArray &data)
 {
-    QTcpSocket* socket = (QTcpSocket*)sender();
-    if (m_Sockets->remove(socket))
+    const auto kId = QByteArray::number(id);
+    QByteArray event;
+    event.reserve(kId.size() + data.size() + 14);
+    event.append("id: ").append(kId).append("\ndata: ").append(data).append("\n\n");
+    return event;
+}
+
+//! Writes the event, or queues it while the socket is backed up; returns false if the queue overflowed
+/*!
+ * Keyless events (a catch-up) are always queued, see CoalescingQueue. Replaced events go out with their newer id,
+ * so ids may arrive out of order; resuming from an older one replays more, never less.
+ */
+bool SseServer::Enqueue(QTcpSocket *socket, Subscriber &subscriber, const QString &key, const QByteArray &event)
+{
+    subscriber.queue.send(socket, key, event);
+    if (subscriber.queue.isEmpty())
+        return true;
+
+    if (!subscriber.stalled.isValid())
+        subscriber.stalled.start();
+
+    return (subscriber.queue.size() <= MAX_QUEUED_EVENTS);
+}
+
+void SseServer::Pump(QTcpSocket *socket, Subscriber &subscriber)
+{
+    subscriber.queue.pump(socket);
+    if (subscriber.queue.isEmpty() && subscriber.stalled.isValid())
     {
-        TSLogging::Log("Socket removed from stream set.");
-        if (m_Sockets->isEmpty())
-            m_keepAlive->stop();
+        const auto kCoalesced = subscriber.queue.takeCoalesced();
+        if (kCoalesced > 0)
+            TSLogging::Log(QString("%1: Caught up, coalesced %2 events.").arg(socket->socketDescriptor()).arg(kCoalesced), LogLevel_INFO);
+
+        subscriber.stalled.invalidate();
     }
+}
 
+void SseServer::onBytesWritten()
+{
+    QTcpSocket* socket = (QTcpSocket*)sender();
+    auto it = m_Subscribers.find(socket);
+    if (it == m_Subscribers.end())
+        return;
+
+    if (it.value().stalled.isValid())  // slow is fine, as long as it reads
+        it.value().stalled.restart();
+
+    Pump(socket, it.value());
+}
+
+bool SseServer::RemoveSubscriber(QTcpSocket *socket)
+{
+    const auto kIt = m_Subscribers.constFind(socket);
+    if (kIt == m_Subscribers.constEnd())
+        return false;
+
+    --m_subscriberCounts[kIt.value().stream];
+    m_Subscribers.erase(kIt);
+
+    TSLogging::Log("Socket removed from stream set.");
+    if (m_Subscribers.isEmpty())
+        m_keepAlive->stop();
+
+    return true;
+}
+
+void SseServer::discardClient()
+{
+    QTcpSocket* socket = (QTcpSocket*)sender();
+    m_Connections.remove(socket);
+    RemoveSubscriber(socket);
 
 //    m_SocketStreams.remove(socket);
     int socketDesc = socket->socketDescriptor();
@@ -72,133 +158,207 @@ void SseServer::discardClient()
 void SseServer::onNewConnection()
 {
     QTcpSocket* socket = nextPendingConnection();
+    m_Connections.insert(socket, Connection());
     connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
     connect(socket, SIGNAL(disconnected()), this, SLOT(discardClient()));
     TSLogging::Log(QString("New connection established: %1").arg(socket->socketDescriptor()), LogLevel_INFO);
 }
 
+//! Comments the idle subscribers, disconnects the ones stalled for too long
 void SseServer::onKeepAlive()
 {
-    QSet<QTcpSocket*>::const_iterator i = m_Sockets->constBegin();
-    while (i != m_Sockets->constEnd())
+    static const QByteArray kKeepAlive(": Dont you die on me\n\n");
+
+    for (auto it = m_Subscribers.begin(); it != m_Subscribers.end(); ++it)
     {
-        QTextStream os(*i);
-        os.setAutoDetectUnicode(true);
-        os << ": Dont you die on me\n\n";
-        os.flush();
-        ++i;
+        if (!it.value().stalled.isValid())
+            it.key()->write(kKeepAlive);
     }
 //    TSLogging::Log("Sent KeepAlive.");
+
+    DropStalled();
+}
+
+void SseServer::DropStalled()
+{
+    QList<QTcpSocket*> stalled;
+    for (auto it = m_Subscribers.constBegin(); it != m_Subscribers.constEnd(); ++it)
+    {
+        if (it.value().stalled.isValid() && it.value().stalled.hasExpired(STALL_TIMEOUT_MSEC))
+            stalled.append(it.key());
+    }
+
+    for (auto socket : stalled)
+    {
+        TSLogging::Log(QString("%1: Stalled for %2ms, disconnecting.").arg(socket->socketDescriptor()).arg(m_Subscribers.value(socket).stalled.elapsed()), LogLevel_WARNING);
+        RemoveSubscriber(socket);
+        socket->abort();
+    }
 }
 
+//! Parses what arrived so far, answers every complete request
+/*!
+ * Requests may arrive in pieces or several at once (keep-alive, pipelining); the parser resumes where it stopped.
+ * Once a connection subscribed to a stream, anything else it sends is ignored.
+ */
 void SseServer::readClient()
 {
-    if (!m_isEnabled)
+    QTcpSocket* socket = (QTcpSocket*)sender();
+    auto it = m_Connections.find(socket);
+    if (!m_isEnabled || (it == m_Connections.end()))
+    {
+        socket->readAll();
         return;
+    }
 
-    // This slot is called when the client sent data to the server. The
-    // server looks if it was a get request and sends a very simple HTML
-    // document back.
-    QTcpSocket* socket = (QTcpSocket*)sender();
-    QStringList incoming;
-    while (socket->canReadLine())
+    auto &connection = it.value();
+    connection.buffer += socket->readAll();
+    while (!connection.buffer.isEmpty())
     {
-        QString line = QString(socket->readLine());
-        TSLogging::Log(QString("%1: %2").arg(socket->socketDescriptor()).arg(line.left(line.length()-2)));
-        incoming.append(line);
+        const auto kState = connection.parser.parse(connection.buffer);
+        if (kState == HttpRequestParser::Incomplete)
+            return;
+
+        if (kState == HttpRequestParser::Error)
+        {
+            TSLogging::Log(QString("%1: Bad request.").arg(socket->socketDescriptor()), LogLevel_INFO);
+            socket->write("HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n");
+            m_Connections.remove(socket);
+            socket->disconnectFromHost();
+            return;
+        }
+
+        if (!Route(socket, connection.parser))
+        {
+            m_Connections.remove(socket);   // may be gone already, if the reply closed it
+            return;
+        }
+
+        connection.buffer.remove(0, connection.parser.requestLength());
+        connection.parser.reset();
     }
+}
+
+//! Answers a complete request; returns whether the connection takes further requests
+bool SseServer::Route(QTcpSocket *socket, const HttpRequestParser &request)
+{
+    const auto kMethod = request.method();
+    const auto kPath = request.path();
+    TSLogging::Log(QString("%1: %2 %3").arg(socket->socketDescriptor()).arg(QString::fromLatin1(kMethod)).arg(QString::fromLatin1(request.target())), LogLevel_DEVEL);
 
-    QStringList tokens = incoming[0].split(QRegExp("[ \r\n][ \r\n]*"));
-    if (tokens[0] == "GET")
+    auto stream = -1;
+    for (int i = 0; i < STREAM_COUNT; ++i)
     {
-        if (tokens[1].startsWith("/positional_audio/stream"))
+        if (kPath == kStreamPaths[i])
         {
-            TSLogging::Log("Get request for positional audio stream");
-            if (m_Sockets->isEmpty())
-                m_keepAlive->start(2000);
-
-            m_Sockets->insert(socket);
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true);
-            os << "HTTP/1.1 200 Ok\r\n"
-                  "Content-Type: text/event-stream\r\n"
-                  "Cache-Control: no-cache\r\n"
-                  "Access-Control-Allow-Origin: *\r\n"
-                  "Access-Control-Allow-Headers: Cache-Control, Pragma, Origin, Authorization, Content-Type, X-Requested-With, Accept\r\n"
-                  "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
-                  "\r\n";
-            os.flush();
-//            TSLogging::Log(QString("%1: Short stream sent.").arg(socket->socketDescriptor()));
-//            Send(socket, QDateTime::currentDateTime().toString());
-            //socket->close();
+            stream = i;
+            break;
         }
+    }
+
+    if ((kMethod == "GET") && (stream >= 0))
+    {
+        Subscribe(socket, stream, request);
+        return false;
+    }
+
+    const auto kIsGet = (kMethod == "GET") || (kMethod == "HEAD");
+    if (kIsGet && (stream >= 0))
+        Reply(socket, "200 Ok", "Content-Type: text/event-stream\r\n", QByteArray(), request);
+    else if (kMethod == "OPTIONS")        // LUCKILY WITH THE PROPER POLYFILL NOT USED :D
+    {
+        if (stream >= 0)
+            Reply(socket, "200 Ok", QByteArray(kCorsHeaders).append("Access-Control-Allow-Credentials: true\r\nAllow: GET, HEAD, OPTIONS\r\n"), QByteArray(), request);
         else
-        {
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true);
-            if (tokens[1] == "/")
-            {
-                os << "HTTP/1.1 200 Ok\r\n"
-                    "Content-Type: text/html; charset=\"utf-8\"\r\n"
-                    "\r\n"
-                    "<html><body>"
+            Reply(socket, "404 Not Found", QByteArray(), QByteArray(), request);
+    }
+    else if (kIsGet && (kPath == "/"))
+    {
+        QByteArray body;
+        body.append("<html><body>"
                     "<h1>CrossTalk</h1>\n"
-                    //<< QDateTime::currentDateTime().toString() << "\n";
                     "<div id=\"result\">Waiting\n</div>\n"
                     "<script>\n"
                         "if(typeof(EventSource)!==\"undefined\") {\n"
-                            "var source=new EventSource(\"http://localhost:" << this->serverPort() <<"/positional_audio/stream\");\n"
+                            "var source=new EventSource(\"http://localhost:").append(QByteArray::number(serverPort())).append("/positional_audio/stream\");\n"
                             "source.onmessage=function(event)\n"
                             "{document.getElementById(\"result\").innerHTML+=event.data + \"<br>\";};\n"
                         "}else{document.getElementById(\"result\").innerHTML=\"Sorry, your browser does not support server-sent events...\";}"
-                    "</script></body></html>\n";
-
-                TSLogging::Log(QString("Sent Homepage to client %1").arg(socket->socketDescriptor()));
-                socket->close();
-            }
-            else
-            {
-                os << "HTTP/1.1 404 Not found.";
-                TSLogging::Log(QString("Told client %1 404 not found.").arg(socket->socketDescriptor()));
-                socket->close();
-            }
-            //TSLogging::Log("Wrote to client.");
-        }
+                    "</script></body></html>\n");
+        Reply(socket, "200 Ok", "Content-Type: text/html; charset=\"utf-8\"\r\n", body, request);
     }
-    else if (tokens[0] == "OPTIONS")        // LUCKILY WITH THE PROPER POLYFILL NOT USED :D
+    else if (kIsGet)
+        Reply(socket, "404 Not Found", QByteArray(), QByteArray(), request);
+    else
+        Reply(socket, "405 Method Not Allowed", "Allow: GET, HEAD, OPTIONS\r\n", QByteArray(), request);
+
+    return request.isKeepAlive();
+}
+
+void SseServer::Reply(QTcpSocket *socket, const char *status, const QByteArray &headers, const QByteArray &body, const HttpRequestParser &request)
+{
+    const auto kIsKeepAlive = request.isKeepAlive();
+    QByteArray response;
+    response.reserve(128 + headers.size() + body.size());
+    response.append("HTTP/1.1 ").append(status).append("\r\n")
+            .append(headers)
+            .append("Content-Length: ").append(QByteArray::number(body.size())).append("\r\n")
+            .append(kIsKeepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n");
+    if (request.method() != "HEAD")
+        response.append(body);
+
+    socket->write(response);
+    if (!kIsKeepAlive)
+        socket->disconnectFromHost();
+}
+
+void SseServer::Subscribe(QTcpSocket *socket, int stream, const HttpRequestParser &request)
+{
+    if (m_Subscribers.isEmpty())
+        m_keepAlive->start(2000);
+
+    Subscriber subscriber;
+    subscriber.stream = stream;
+    bool ok;
+    const auto kLastEventId = request.header("Last-Event-ID").toULongLong(&ok);
+    if (ok)
+        subscriber.lastEventId = kLastEventId;
+
+    m_Subscribers.insert(socket, subscriber);
+    ++m_subscriberCounts[stream];
+    connect(socket, SIGNAL(bytesWritten(qint64)), this, SLOT(onBytesWritten()), Qt::UniqueConnection);
+
+    static const QByteArray kStreamHeader = QByteArray("HTTP/1.1 200 Ok\r\n"
+                                                       "Content-Type: text/event-stream\r\n"
+                                                       "Cache-Control: no-cache\r\n")
+                                                       .append(kCorsHeaders)
+                                                       .append("\r\n");
+    socket->write(kStreamHeader);
+
+    // catch up: what was missed, or the current state
+    const auto kHistory = m_histories[stream];
+    if (!kHistory)
     {
-        if (tokens[1] == "/positional_audio/stream")
-        {
-            QTextStream os(socket);
-            os.setAutoDetectUnicode(true);
-            os << "HTTP/1.1 200 Ok\r\n"
-                  //"Content-Type: text/event-stream\r\n"
-                  //"Cache-Control: no-cache\r\n"
-                  "Access-Control-Allow-Origin: *\r\n"
-                  "Access-Control-Allow-Headers: Cache-Control, Pragma, Origin, Authorization, Content-Type, X-Requested-With, Accept\r\n"
-                  "Access-Control-Allow-Methods: GET, OPTIONS\r\n"
-                  "Access-Control-Allow-Credentials: true\r\n"
-                  "Allow: GET, HEAD, OPTIONS\r\n"
-                  "Connection: close\r\n"
-                  "\r\n";
-            os.flush();
-            TSLogging::Log(QString("%1: Reply to OPTIONS for %2 sent.").arg(socket->socketDescriptor()).arg(tokens[1]));
-        }
+        TSLogging::Log(QString("%1: Subscribed to %2.").arg(socket->socketDescriptor()).arg(kStreamPaths[stream]), LogLevel_INFO);
+        return;
     }
 
-    if (socket->state() == QTcpSocket::UnconnectedState)
+    auto &subscribed = m_Subscribers[socket];
+    QVector<EventHistory::Event> missed;
+    if (ok && kHistory->since(kLastEventId, missed))
     {
-        if (m_Sockets->remove(socket))
-        {
-            TSLogging::Log("Socket removed from stream set.");
-            if (m_Sockets->isEmpty())
-                m_keepAlive->stop();
-        }
-//                m_SocketStreams.remove(socket);
-        int socketDesc = socket->socketDescriptor();
-        delete socket;
+        for (const auto &event : missed)
+            Enqueue(socket, subscribed, QString(), Frame(event.id, event.data));
+
+        TSLogging::Log(QString("%1: Subscribed to %2, replayed %3 events.").arg(socket->socketDescriptor()).arg(kStreamPaths[stream]).arg(missed.size()), LogLevel_INFO);
+    }
+    else
+    {
+        const auto kSnapshot = kHistory->snapshot();
+        for (const auto &event : kSnapshot)
+            Enqueue(socket, subscribed, QString(), Frame(kHistory->getLastId(), event));
 
-        TSLogging::Log(QString("Connection closed: %1").arg(socketDesc));
+        TSLogging::Log(QString("%1: Subscribed to %2, sent snapshot.").arg(socket->socketDescriptor()).arg(kStreamPaths[stream]), LogLevel_INFO);
     }
 }
 
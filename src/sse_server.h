@@ -4,16 +4,36 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 #include <QTimer>
+#include <QElapsedTimer>
+#include <QHash>
+
+#include "http_request_parser.h"
+#include "event_history.h"
+#include "coalescing_queue.h"
 
 class SseServer : public QTcpServer
 {
     Q_OBJECT
 public:
+    //! The event streams, one endpoint each
+    enum Stream
+    {
+        PositionalAudio = 0,    // /positional_audio/stream
+        TalkStatus,             // /talk_status/stream
+        Meters,                 // /meters/stream
+        STREAM_COUNT
+    };
+
     explicit SseServer(QObject *parent = 0, quint16 port = 64736);
 //    void pause();
 //    void resume();
-    void Send(QTcpSocket* socket, QString val);
-    void Send(QString val);
+    void Send(QString val);                     // positional audio
+    void Send(int stream, const QString &key, const QByteArray &val);
+    void Send(int stream, quint64 id, const QString &key, const QByteArray &val);  // id from the stream's history
+    bool hasSubscribers(int stream) const {return m_subscriberCounts[stream] > 0;}
+
+    //! Lets subscribers of a stream resume with Last-Event-ID, or start from its snapshot
+    void setHistory(int stream, const EventHistory *history) {m_histories[stream] = history;}
 
 signals:
 
@@ -25,12 +45,45 @@ private slots:
 
     void onNewConnection();
     void onKeepAlive();
+    void onBytesWritten();
 
 private:
+    //! A stream client; events wait in its queue while the socket is backed up
+    struct Subscriber
+    {
+        int stream = PositionalAudio;
+        quint64 lastEventId = 0;    // Last-Event-ID the client resumed with
+        CoalescingQueue<QString> queue;     // keyed like Send()
+        QElapsedTimer stalled;      // since the last progress, valid while events are queued
+    };
+
+    static const int MAX_QUEUED_EVENTS = 2048;          // per subscriber, beyond it's disconnected (a catch-up is up to EventHistory::CAPACITY)
+    static const int STALL_TIMEOUT_MSEC = 15000;        // a subscriber not reading for that long is disconnected
+
+    //! A connection that hasn't subscribed (yet)
+    struct Connection
+    {
+        QByteArray buffer;
+        HttpRequestParser parser;
+    };
+
 //    void incomingConnection(int socket);
+    bool Route(QTcpSocket* socket, const HttpRequestParser &request);
+    void Reply(QTcpSocket* socket, const char *status, const QByteArray &headers, const QByteArray &body, const HttpRequestParser &request);
+    void Subscribe(QTcpSocket* socket, int stream, const HttpRequestParser &request);
+    static QByteArray Frame(quint64 id, const QByteArray &data);
+    bool Enqueue(QTcpSocket* socket, Subscriber &subscriber, const QString &key, const QByteArray &event);
+    void Pump(QTcpSocket* socket, Subscriber &subscriber);
+    bool RemoveSubscriber(QTcpSocket* socket);
+    void DropStalled();
+
     bool m_isEnabled = true;
 
-    QSet<QTcpSocket*>* m_Sockets;
+    QHash<QTcpSocket*, Connection> m_Connections;
+    QHash<QTcpSocket*, Subscriber> m_Subscribers;
+    int m_subscriberCounts[STREAM_COUNT] = {};
+    quint64 m_eventIds[STREAM_COUNT] = {};    // of the last event sent per stream without a history
+    const EventHistory *m_histories[STREAM_COUNT] = {};
     QMap<QTcpSocket*,QTextStream*> m_SocketStreams;
     QTimer* m_keepAlive;
 };
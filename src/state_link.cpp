@@ -0,0 +1,175 @@
+#include "state_link.h"
+
+#include <atomic>
+#include <stddef.h>
+#include <string.h>
+
+static_assert(sizeof(StateLinkPlayer) == 160, "StateLinkPlayer layout");
+static_assert(sizeof(StateLinkTalker) == 40, "StateLinkTalker layout");
+static_assert(offsetof(StateLinkMem, players) == 32, "StateLinkMem layout");
+
+static void storeSequence(StateLinkMem* mem, quint32 val)
+{
+    *static_cast<volatile quint32*>(&mem->sequence) = val;
+}
+
+StateLink::StateLink(QObject *parent)
+    : QObject(parent)
+{
+    memset(&m_local, 0, sizeof(m_local));
+    m_local.magic = STATE_LINK_MAGIC;
+    m_local.version = STATE_LINK_VERSION;
+}
+
+bool StateLink::open()
+{
+    if (m_mem)
+        return true;
+
+    if (!m_sharedMemory)
+    {
+        m_sharedMemory = new QSharedMemory(this);
+        m_sharedMemory->setNativeKey("CrossTalkStateLink");
+    }
+
+    // readers may keep a former segment alive; take it over
+    if (!m_sharedMemory->create(sizeof(StateLinkMem), QSharedMemory::ReadWrite))
+    {
+        if (m_sharedMemory->error() != QSharedMemory::AlreadyExists)
+        {
+            m_errorString = QString("Could not create shared memory: %1").arg(m_sharedMemory->errorString());
+            return false;
+        }
+        if (!m_sharedMemory->attach(QSharedMemory::ReadWrite))
+        {
+            m_errorString = QString("Could not attach to shared memory: %1").arg(m_sharedMemory->errorString());
+            return false;
+        }
+        if (m_sharedMemory->size() < (int)sizeof(StateLinkMem))
+        {
+            m_sharedMemory->detach();
+            m_errorString = "Shared memory of a former layout is still in use.";
+            return false;
+        }
+    }
+
+    m_mem = static_cast<StateLinkMem*>(m_sharedMemory->data());
+    m_local.sequence = m_mem->sequence & ~1u;  // continue the sequence readers may have seen
+    publish();
+    return true;
+}
+
+void StateLink::close()
+{
+    if (!m_mem)
+        return;
+
+    clearPlayers();
+    m_local.talkerCount = 0;
+    publish();
+
+    m_mem = nullptr;
+    m_sharedMemory->detach();
+}
+
+void StateLink::clearPlayers()
+{
+    m_local.playerCount = 0;
+    schedule();
+}
+
+StateLinkPlayer* StateLink::addPlayer()
+{
+    if (m_local.playerCount >= (quint32)STATE_LINK_MAX_PLAYERS)
+        return nullptr;
+
+    auto player = &m_local.players[m_local.playerCount++];
+    memset(player, 0, sizeof(StateLinkPlayer));
+    schedule();
+    return player;
+}
+
+//! Talkers are listed while they talk
+void StateLink::setTalkStatus(uint64 serverConnectionHandlerID, anyID clientID, bool isTalking, bool isWhispering, bool isMe)
+{
+    auto index = findTalker(serverConnectionHandlerID, clientID);
+    if (!isTalking)
+    {
+        if (index < 0)
+            return;
+
+        m_local.talkers[index] = m_local.talkers[--m_local.talkerCount];
+        schedule();
+        return;
+    }
+
+    if (index < 0)
+    {
+        if (m_local.talkerCount >= (quint32)STATE_LINK_MAX_TALKERS)
+            return;
+
+        index = m_local.talkerCount++;
+        memset(&m_local.talkers[index], 0, sizeof(StateLinkTalker));
+        m_local.talkers[index].serverConnectionHandlerID = serverConnectionHandlerID;
+        m_local.talkers[index].clientID = clientID;
+    }
+    m_local.talkers[index].flags = (isMe ? StateLinkTalker::Me : 0) | (isWhispering ? StateLinkTalker::Whispering : 0);
+    schedule();
+}
+
+void StateLink::setMeter(uint64 serverConnectionHandlerID, anyID clientID, int type, float value)
+{
+    if ((type < 0) || (type >= STATE_LINK_METER_COUNT))
+        return;
+
+    const auto kIndex = findTalker(serverConnectionHandlerID, clientID);
+    if (kIndex < 0)     // trailing samples after the talker stopped
+        return;
+
+    m_local.talkers[kIndex].meters[type] = value;
+    schedule();
+}
+
+int StateLink::findTalker(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    for (quint32 i = 0; i < m_local.talkerCount; ++i)
+    {
+        if ((m_local.talkers[i].serverConnectionHandlerID == serverConnectionHandlerID) && (m_local.talkers[i].clientID == clientID))
+            return (int)i;
+    }
+    return -1;
+}
+
+void StateLink::schedule()
+{
+    if (!m_mem || m_isPublishPending)
+        return;
+
+    m_isPublishPending = true;
+    QMetaObject::invokeMethod(this, "publish", Qt::QueuedConnection);
+}
+
+//! Seqlock write: odd sequence, the used part of the tables, even sequence
+void StateLink::publish()
+{
+    m_isPublishPending = false;
+    if (!m_mem)
+        return;
+
+    const auto kSequence = m_local.sequence;
+    storeSequence(m_mem, kSequence + 1);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    ++m_local.tick;
+    m_mem->magic = m_local.magic;
+    m_mem->version = m_local.version;
+    m_mem->playerCount = m_local.playerCount;
+    m_mem->talkerCount = m_local.talkerCount;
+    m_mem->tick = m_local.tick;
+    memcpy(m_mem->players, m_local.players, m_local.playerCount * sizeof(StateLinkPlayer));
+    memcpy(m_mem->talkers, m_local.talkers, m_local.talkerCount * sizeof(StateLinkTalker));
+
+    std::atomic_thread_fence(std::memory_order_release);
+    storeSequence(m_mem, kSequence + 2);
+    m_local.sequence = kSequence + 2;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <QObject>
+#include <QSharedMemory>
+#include "teamspeak/public_definitions.h"
+
+//! Layout of the shared memory, for readers to include; all offsets are fixed, native byte order
+/*!
+ * Reading (seqlock, no locks, no syscalls once mapped):
+ * 1. s1 = sequence; if odd, the plugin is writing: retry
+ * 2. copy the counts and tables, acquire fence
+ * 3. s2 = sequence; if s2 != s1 the copy may be torn: retry
+ * Check magic and version before anything else; a version bump means an incompatible layout.
+ */
+const quint32 STATE_LINK_MAGIC = 0x4b4c5443;    // "CTLK"
+const quint32 STATE_LINK_VERSION = 1;
+const int STATE_LINK_MAX_PLAYERS = 256;
+const int STATE_LINK_MAX_TALKERS = 64;
+const int STATE_LINK_METER_COUNT = 6;           // one per TelemetryType
+
+struct StateLinkPlayer
+{
+    enum Flag
+    {
+        Me = 0x1,
+        InContext = 0x2     // in my vr and context, positioned by us
+    };
+
+    quint64 serverConnectionHandlerID;  // 0 for myself
+    quint16 clientID;
+    quint16 flags;
+    quint32 reserved;
+    float position[3];                  // game units, as sent
+    float front[3];
+    char uid[32];                       // UTF-8, 0 terminated
+    char name[88];                      // UTF-8, 0 terminated, cut at 87 bytes
+};
+
+struct StateLinkTalker
+{
+    enum Flag
+    {
+        Me = 0x1,
+        Whispering = 0x2
+    };
+
+    quint64 serverConnectionHandlerID;
+    quint16 clientID;
+    quint16 flags;
+    quint32 reserved;
+    float meters[STATE_LINK_METER_COUNT];   // latest value per TelemetryType, 0 until one arrived
+};
+
+struct StateLinkMem
+{
+    quint32 magic;
+    quint32 version;
+    quint32 sequence;       // odd while the plugin writes
+    quint32 playerCount;
+    quint32 talkerCount;
+    quint32 reserved;
+    quint64 tick;           // increments with every publication
+    StateLinkPlayer players[STATE_LINK_MAX_PLAYERS];
+    StateLinkTalker talkers[STATE_LINK_MAX_TALKERS];  // the ones talking right now
+};
+
+//! Publishes the live players, talk states and meters to local overlays
+/*!
+ * Overlays (OBS sources, map tools) map the "CrossTalkStateLink" shared memory and read it at their own frame rate,
+ * without the serialisation and syscalls of the text transports. Updates go to a local copy; it's published once
+ * per event loop pass, whatever number of updates came in.
+ */
+class StateLink : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit StateLink(QObject *parent = 0);
+
+    bool open();
+    void close();
+    QString errorString() const {return m_errorString;}
+
+    // players; the table is rebuilt as a whole
+    void clearPlayers();
+    StateLinkPlayer* addPlayer();   // zeroed, nullptr when full
+
+    void setTalkStatus(uint64 serverConnectionHandlerID, anyID clientID, bool isTalking, bool isWhispering, bool isMe);
+    void setMeter(uint64 serverConnectionHandlerID, anyID clientID, int type, float value);
+
+private slots:
+    void publish();
+
+private:
+    void schedule();
+    int findTalker(uint64 serverConnectionHandlerID, anyID clientID) const;
+
+    QSharedMemory* m_sharedMemory = nullptr;
+    StateLinkMem* m_mem = nullptr;
+    QString m_errorString;
+
+    StateLinkMem m_local;
+    bool m_isPublishPending = false;
+};
@@ -156,6 +156,8 @@ bool Talkers::onTalkStatusChangeEvent(uint64 serverConnectionHandlerID, int stat
         return false;
     }
 
+    emit TalkStatusChanged(serverConnectionHandlerID, status, isReceivedWhisper, clientID, (clientID == myID));
+
     if (clientID == myID)
     {
         m_meTalkingIsWhisper = isReceivedWhisper;
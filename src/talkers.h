@@ -64,6 +64,7 @@ public:
     //    int RegisterEventTalkStatusChange(QObject *p, int priority, bool isRegister);
 signals:
     void ConnectStatusChanged(uint64 serverConnectionHandlerID, int newStatus, unsigned int errorNumber);
+    void TalkStatusChanged(uint64 serverConnectionHandlerID, int status, bool isReceivedWhisper, anyID clientID, bool isMe);
 public slots:
     
 private:
@@ -0,0 +1,89 @@
+#include "telemetry.h"
+
+#include <QTimerEvent>
+#include <QThread>
+
+#include "ts_logging_qt.h"
+
+const int DRAIN_TIMER_INTERVAL = 33;    // ~30 fps is plenty for faders and meters
+
+Telemetry* Telemetry::m_Instance = 0;
+
+Telemetry::Telemetry()
+{
+    this->setObjectName(QStringLiteral("Telemetry"));
+}
+
+void Telemetry::Start()
+{
+#ifndef QT_NO_DEBUG
+    for (auto &thread : m_producerThreads)   // the client may have reopened its devices
+        thread.store(nullptr);
+#endif
+    if (m_drainTimerId == -1)
+        m_drainTimerId = this->startTimer(DRAIN_TIMER_INTERVAL);
+}
+
+void Telemetry::Stop()
+{
+    if (m_drainTimerId != -1)
+    {
+        this->killTimer(m_drainTimerId);
+        m_drainTimerId = -1;
+    }
+    Drain();
+}
+
+//! Hands a snapshot over to the gui thread
+/*!
+ * \brief Telemetry::Push audio thread; wait-free, no allocations
+ * \param producer the calling callback; a debug build asserts it stays on one thread
+ * \param type what the value describes
+ * \param serverConnectionHandlerID the connection id of the server
+ * \param clientID the client-side runtime-id
+ * \param value the snapshot
+ */
+void Telemetry::Push(Producer producer, TelemetryType type, uint64 serverConnectionHandlerID, anyID clientID, float value)
+{
+#ifndef QT_NO_DEBUG
+    const auto kThread = (void*)QThread::currentThreadId();
+    m_producerThreads[producer].testAndSetRelaxed(nullptr, kThread);
+    Q_ASSERT_X(m_producerThreads[producer].load() == kThread, "Telemetry::Push", "a second thread pushes into a single producer ring");
+#endif
+
+    TelemetrySample sample;
+    sample.serverConnectionHandlerID = serverConnectionHandlerID;
+    sample.clientID = clientID;
+    sample.type = type;
+    sample.value = value;
+    if (!m_rings[producer].push(sample))
+        m_dropped.fetchAndAddRelaxed(1);
+}
+
+void Telemetry::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() == m_drainTimerId)
+        Drain();
+}
+
+void Telemetry::Drain()
+{
+    TelemetrySample sample;
+    for (auto &ring : m_rings)
+    {
+        while (ring.pop(sample))
+        {
+            const auto kKey = (sample.serverConnectionHandlerID << 24) | ((quint64)sample.clientID << 8) | (quint64)sample.type;
+            m_latest.insert(kKey, sample);
+        }
+    }
+
+    for (auto i = m_latest.constBegin(); i != m_latest.constEnd(); ++i)
+        emit Updated((int)i.value().type, i.value().serverConnectionHandlerID, i.value().clientID, i.value().value);
+
+    m_latest.clear();
+
+    const auto kDropped = m_dropped.fetchAndStoreRelaxed(0);
+    if (kDropped > 0)
+        TSLogging::Log(QString("Telemetry: dropped %1 samples").arg(kDropped), LogLevel_DEBUG);
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QAtomicPointer>
+#include "teamspeak/public_definitions.h"
+#include "spsc_ring.h"
+
+//! What a telemetry sample describes
+enum class TelemetryType : quint8
+{
+    MuterGain = 0,      // dB
+    AgmuGain,           // dB
+    AgmuPeak,           // int16 peak
+    DuckerGlobalGain,   // dB
+    DuckerChannelGain,  // dB
+    Pan                 // -1...+1
+};
+
+struct TelemetrySample
+{
+    uint64 serverConnectionHandlerID;
+    anyID clientID;
+    TelemetryType type;
+    float value;
+};
+
+//! Audio to ui telemetry channel
+/*!
+ * The audio callbacks push gain / pan / meter snapshots into lock-free rings without touching Qt's signal machinery;
+ * the gui thread drains them at display rate, keeps the latest value per talker and type and emits those.
+ * The callbacks may run on different threads, so each one pushes into its own single producer ring.
+ */
+class Telemetry : public QObject
+{
+    Q_OBJECT
+
+public:
+    //! The audio callbacks pushing samples, one producer thread each
+    enum Producer
+    {
+        PlaybackProducer = 0,       // onEditPlaybackVoiceDataEvent
+        PostProcessProducer,        // onEditPostProcessVoiceDataEvent
+        PRODUCERS
+    };
+
+    static Telemetry* instance() {
+        static QMutex mutex;
+        if(!m_Instance) {
+            mutex.lock();
+
+            if(!m_Instance)
+                m_Instance = new Telemetry;
+
+            mutex.unlock();
+        }
+        return m_Instance;
+    }
+
+    static void drop() {
+        static QMutex mutex;
+        mutex.lock();
+        delete m_Instance;
+        m_Instance = 0;
+        mutex.unlock();
+    }
+
+    // gui thread
+    void Start();
+    void Stop();
+
+    // the producer's audio thread; drops the sample when its ring is full
+    void Push(Producer producer, TelemetryType type, uint64 serverConnectionHandlerID, anyID clientID, float value);
+
+signals:
+    void Updated(int type, uint64 serverConnectionHandlerID, anyID clientID, float value);
+
+protected:
+    void timerEvent(QTimerEvent *event);
+
+private:
+    //singleton
+    explicit Telemetry();
+    ~Telemetry() = default;
+    static Telemetry* m_Instance;
+    Telemetry(const Telemetry &);
+    Telemetry& operator=(const Telemetry &);
+
+    void Drain();
+
+    SpscRing<TelemetrySample, 8192> m_rings[PRODUCERS];
+    QAtomicInt m_dropped;
+#ifndef QT_NO_DEBUG
+    QAtomicPointer<void> m_producerThreads[PRODUCERS];   // the thread pushing into each ring since Start()
+#endif
+
+    int m_drainTimerId = -1;
+    QHash<quint64, TelemetrySample> m_latest;   // coalescing; only the newest value per talker and type is emitted
+};
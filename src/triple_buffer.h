@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QAtomicInt>
+
+//! Hands the latest value from exactly one writer thread to exactly one reader thread
+/*!
+ * Three fixed buffers rotate: the writer fills its back buffer and publishes it, the reader swaps in the latest
+ * published one when there is a new one. Neither side blocks or allocates; values published in between two reads
+ * are skipped, the reader always gets the newest.
+ */
+template <typename T>
+class TripleBuffer
+{
+public:
+    // writer
+    T& back() {return m_buffers[m_back];}
+
+    void publish()
+    {
+        m_back = m_middle.fetchAndStoreAcqRel(m_back | kFresh) & kIndexMask;
+    }
+
+    // reader
+    //! Takes over the latest published value if there is one; returns true if front() changed
+    bool update()
+    {
+        if (!(m_middle.loadAcquire() & kFresh))
+            return false;
+
+        m_front = m_middle.fetchAndStoreAcqRel(m_front) & kIndexMask;
+        return true;
+    }
+
+    const T& front() const {return m_buffers[m_front];}
+
+private:
+    static const int kIndexMask = 3;
+    static const int kFresh = 4;
+
+    T m_buffers[3];
+    int m_back = 0;             // writer only
+    int m_front = 1;            // reader only
+    QAtomicInt m_middle {2};    // buffer index | kFresh
+};
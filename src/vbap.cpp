@@ -0,0 +1,173 @@
+#include "vbap.h"
+
+#include <math.h>
+#include <algorithm>
+
+#include "teamspeak/public_definitions.h"
+
+const float DEG_TO_RAD = 3.14159265358979323846f / 180.0f;
+const float MAX_SPAN = 150.0f;
+
+float Vbap::speakerAzimuth(unsigned int speaker, bool hasSideSpeakers)
+{
+    switch (speaker)
+    {
+    case SPEAKER_FRONT_LEFT:
+        return -30.0f;
+    case SPEAKER_FRONT_RIGHT:
+        return 30.0f;
+    case SPEAKER_FRONT_CENTER:
+        return 0.0f;
+    case SPEAKER_FRONT_LEFT_OF_CENTER:
+        return -15.0f;
+    case SPEAKER_FRONT_RIGHT_OF_CENTER:
+        return 15.0f;
+    case SPEAKER_SIDE_LEFT:
+        return -90.0f;
+    case SPEAKER_SIDE_RIGHT:
+        return 90.0f;
+    // 5.1 puts its surrounds on the back flags
+    case SPEAKER_BACK_LEFT:
+        return (hasSideSpeakers) ? -150.0f : -110.0f;
+    case SPEAKER_BACK_RIGHT:
+        return (hasSideSpeakers) ? 150.0f : 110.0f;
+    case SPEAKER_BACK_CENTER:
+        return 180.0f;
+    default:
+        return NAN;
+    }
+}
+
+bool Vbap::setup(int channels, const unsigned int* channelSpeakerArray)
+{
+    m_channels = 0;
+    m_channelMask = 0;
+    m_span = 0.0f;
+    m_pairCount = 0;
+
+    if ((channels <= 0) || (channels > MAX_CHANNELS))
+        return false;
+
+    auto hasSideSpeakers = false;
+    for (int i = 0; i < channels; ++i)
+        hasSideSpeakers |= ((channelSpeakerArray[i] == SPEAKER_SIDE_LEFT) || (channelSpeakerArray[i] == SPEAKER_SIDE_RIGHT));
+
+    struct Speaker
+    {
+        float azimuth;
+        int channel;
+    };
+    Speaker speakers[MAX_CHANNELS];
+    int speakerCount = 0;
+    for (int i = 0; i < channels; ++i)
+    {
+        const auto kAzimuth = speakerAzimuth(channelSpeakerArray[i], hasSideSpeakers);
+        if (isnan(kAzimuth))
+            continue;
+
+        auto isDuplicate = false;
+        for (int j = 0; j < speakerCount; ++j)
+            isDuplicate |= (speakers[j].azimuth == kAzimuth);
+        if (isDuplicate)
+            continue;
+
+        speakers[speakerCount++] = {kAzimuth, i};
+        m_channelMask |= (1u << i);
+        m_span = std::max(m_span, std::min(fabsf(kAzimuth), MAX_SPAN));
+    }
+
+    if (speakerCount < 3)
+    {
+        m_channelMask = 0;
+        return false;
+    }
+
+    // insertion sort by azimuth; at most MAX_CHANNELS speakers
+    for (int i = 1; i < speakerCount; ++i)
+    {
+        const auto kSpeaker = speakers[i];
+        auto j = i;
+        for (; (j > 0) && (speakers[j - 1].azimuth > kSpeaker.azimuth); --j)
+            speakers[j] = speakers[j - 1];
+        speakers[j] = kSpeaker;
+    }
+
+    // adjacent speakers around the circle; a pair spanning 180 degrees or more has no base, that direction stays unreachable
+    for (int i = 0; i < speakerCount; ++i)
+    {
+        const auto& a = speakers[i];
+        const auto& b = speakers[(i + 1) % speakerCount];
+        auto gap = b.azimuth - a.azimuth;
+        if (gap <= 0.0f)
+            gap += 360.0f;
+        if (gap >= 179.9f)
+            continue;
+
+        // rows are the speaker directions (x front, y right); g = p * L^-1
+        const auto kAx = cosf(a.azimuth * DEG_TO_RAD);
+        const auto kAy = sinf(a.azimuth * DEG_TO_RAD);
+        const auto kBx = cosf(b.azimuth * DEG_TO_RAD);
+        const auto kBy = sinf(b.azimuth * DEG_TO_RAD);
+        const auto kDet = (kAx * kBy) - (kAy * kBx);
+
+        auto& pair = m_pairs[m_pairCount++];
+        pair.channelA = a.channel;
+        pair.channelB = b.channel;
+        pair.inverse[0] = kBy / kDet;
+        pair.inverse[1] = -kAy / kDet;
+        pair.inverse[2] = -kBx / kDet;
+        pair.inverse[3] = kAx / kDet;
+    }
+
+    m_channels = channels;
+    return isValid();
+}
+
+void Vbap::gains(float azimuth, float* channelGains) const
+{
+    for (int i = 0; i < m_channels; ++i)
+        channelGains[i] = 0.0f;
+
+    if (!isValid())
+        return;
+
+    const auto kPx = cosf(azimuth * DEG_TO_RAD);
+    const auto kPy = sinf(azimuth * DEG_TO_RAD);
+
+    // the enclosing pair is the one without a negative gain; else take the least negative (a gap in the layout)
+    auto best = -1;
+    auto bestMin = -INFINITY;
+    float bestA = 0.0f;
+    float bestB = 0.0f;
+    for (int i = 0; i < m_pairCount; ++i)
+    {
+        const auto& pair = m_pairs[i];
+        const auto kGainA = (kPx * pair.inverse[0]) + (kPy * pair.inverse[2]);
+        const auto kGainB = (kPx * pair.inverse[1]) + (kPy * pair.inverse[3]);
+        const auto kMin = std::min(kGainA, kGainB);
+        if (kMin > bestMin)
+        {
+            best = i;
+            bestMin = kMin;
+            bestA = kGainA;
+            bestB = kGainB;
+        }
+        if (kMin >= -1e-6f)
+            break;
+    }
+
+    bestA = std::max(bestA, 0.0f);
+    bestB = std::max(bestB, 0.0f);
+    const auto kPower = sqrtf((bestA * bestA) + (bestB * bestB));
+    if (kPower <= 0.0f)
+        return;
+
+    channelGains[m_pairs[best].channelA] = bestA / kPower;
+    channelGains[m_pairs[best].channelB] = bestB / kPower;
+}
+
+void Vbap::panGains(float pan, float* channelGains) const
+{
+    pan = std::min(std::max(pan, -1.0f), 1.0f);
+    gains(pan * m_span, channelGains);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QtGlobal>
+
+//! Constant power vector base amplitude panning (2D) over the horizontal speakers of a playback device
+/*!
+ * setup() resolves the speaker azimuths of a layout and precomputes the inverted base matrix of every pair of
+ * adjacent speakers; gains() then only looks up the pair enclosing a direction and applies its matrix.
+ * Height and LFE speakers don't take part. Azimuths are in degrees, 0 is front, positive is right.
+ */
+class Vbap
+{
+public:
+    //! Channels the gain vectors cover, 7.1
+    static const int MAX_CHANNELS = 8;
+
+    //! Resolves the speakers of a layout
+    /*!
+     * \brief Vbap::setup
+     * \param channels as in onEditPostProcessVoiceDataEvent
+     * \param channelSpeakerArray as in onEditPostProcessVoiceDataEvent
+     * \return true if the layout has at least three horizontal speakers within MAX_CHANNELS channels
+     */
+    bool setup(int channels, const unsigned int* channelSpeakerArray);
+
+    bool isValid() const {return (m_pairCount > 0);}
+    int getChannels() const {return m_channels;}
+
+    //! the channels of the speakers taking part
+    unsigned int getChannelMask() const {return m_channelMask;}
+
+    //! the largest speaker azimuth on either side, the pan range is mapped onto it
+    float getSpan() const {return m_span;}
+
+    //! Gains for a direction
+    /*!
+     * \brief Vbap::gains unit power across the (at most two) active speakers
+     * \param azimuth degrees
+     * \param channelGains receives getChannels() gains
+     */
+    void gains(float azimuth, float* channelGains) const;
+
+    //! Gains for a pan position -1...+1, spread over the span of the layout
+    void panGains(float pan, float* channelGains) const;
+
+    //! Azimuth of a speaker flag, NaN for speakers that aren't on the horizontal plane
+    static float speakerAzimuth(unsigned int speaker, bool hasSideSpeakers);
+
+private:
+    struct Pair
+    {
+        int channelA;
+        int channelB;
+        float inverse[4];   // row major 2x2
+    };
+
+    int m_channels = 0;
+    unsigned int m_channelMask = 0;
+    float m_span = 0.0f;
+    int m_pairCount = 0;
+    Pair m_pairs[MAX_CHANNELS];
+};
@@ -0,0 +1,250 @@
+#include "voice_chain.h"
+
+#include <QTimer>
+#include <QVarLengthArray>
+
+#include "dsp_volume.h"
+#include "dsp_volume_agmu.h"
+#include "dsp_volume_ducker.h"
+#include "mod_muter_channel.h"
+#include "mod_agmu.h"
+#include "mod_ducker_global.h"
+#include "mod_ducker_channel.h"
+#include "telemetry.h"
+
+#ifdef USE_RADIO
+#include "dsp_radio.h"
+#include "mod_radio.h"
+#endif
+
+const int RECLAIM_RETRY_MSEC = 20;
+const int BUS_PREALLOC = 4096;    // 10ms of 48kHz up to 8 channels without touching the heap
+
+VoiceChain* VoiceChain::m_Instance = 0;
+
+VoiceChain::VoiceChain()
+{
+    this->setObjectName(QStringLiteral("VoiceChain"));
+}
+
+VoiceChainNode& VoiceChainBuilder::node(uint64 serverConnectionHandlerID, anyID clientID)
+{
+    auto &node = m_nodes[qMakePair(serverConnectionHandlerID,clientID)];
+    if (node.serverConnectionHandlerID == 0)
+    {
+        node.serverConnectionHandlerID = serverConnectionHandlerID;
+        node.clientID = clientID;
+
+        const auto kSeed = SlotTableHelpers::hashKey(serverConnectionHandlerID,clientID);
+        for (auto &lane : node.dither.lanes)
+        {
+            lane ^= kSeed;
+            if (lane == 0)  // xorshift would stay at 0
+                lane = 1;
+        }
+    }
+    return node;
+}
+
+const VoiceChainNode* VoiceChainSnapshot::find(uint64 serverConnectionHandlerID, anyID clientID) const
+{
+    if (table.isEmpty())
+        return nullptr;
+
+    auto i = SlotTableHelpers::hashKey(serverConnectionHandlerID,clientID) & mask;
+    const auto kTable = table.constData();
+    while (kTable[i].serverConnectionHandlerID != 0)
+    {
+        if ((kTable[i].serverConnectionHandlerID == serverConnectionHandlerID) && (kTable[i].clientID == clientID))
+            return &kTable[i];
+
+        i = (i + 1) & mask;
+    }
+    return nullptr;
+}
+
+void VoiceChain::Init(ChannelMuter *muter, Radio *radio, Agmu *agmu, Ducker_Global *duckerGlobal, Ducker_Channel *duckerChannel)
+{
+    m_muter = muter;
+    m_radio = radio;
+    m_agmu = agmu;
+    m_duckerGlobal = duckerGlobal;
+    m_duckerChannel = duckerChannel;
+    Invalidate();
+}
+
+//! Schedules a rebuild of the chain; coalesces multiple changes within one event loop iteration
+void VoiceChain::Invalidate()
+{
+    if (m_isDirty)
+        return;
+
+    m_isDirty = true;
+    QMetaObject::invokeMethod(this, "Rebuild", Qt::QueuedConnection);
+}
+
+//! Rebuild right away, for events after which voice data is to be expected immediately
+void VoiceChain::RebuildIfDirty()
+{
+    Rebuild();
+}
+
+//! Hands over a dsp object the chain may still reference
+/*!
+ * \brief VoiceChain::Retire The object is deleted once no playback thread can see it anymore
+ * \param obj the object the owning module has already removed from its own book keeping
+ */
+void VoiceChain::Retire(QObject *obj)
+{
+    if (!obj)
+        return;
+
+    obj->blockSignals(true);
+    m_retiredObjects.append(obj);
+    Invalidate();
+}
+
+void VoiceChain::Rebuild()
+{
+    if (!m_isDirty)
+        return;
+
+    m_isDirty = false;
+
+    VoiceChainBuilder builder;
+    if (m_muter)
+        m_muter->PopulateVoiceChain(builder);
+#ifdef USE_RADIO
+    if (m_radio)
+        m_radio->PopulateVoiceChain(builder);
+#endif
+    if (m_agmu)
+        m_agmu->PopulateVoiceChain(builder);
+    if (m_duckerGlobal)
+        m_duckerGlobal->PopulateVoiceChain(builder);
+    if (m_duckerChannel)
+        m_duckerChannel->PopulateVoiceChain(builder);
+
+    auto snapshot = new VoiceChainSnapshot;
+    if (!builder.m_nodes.isEmpty())
+    {
+        int capacity = 16;
+        while (capacity < builder.m_nodes.size() * 2)   // keep the load factor below 0.5
+            capacity <<= 1;
+
+        snapshot->table.resize(capacity);
+        snapshot->mask = capacity - 1;
+        for (auto i = builder.m_nodes.constBegin(); i != builder.m_nodes.constEnd(); ++i)
+        {
+            auto slot = SlotTableHelpers::hashKey(i.value().serverConnectionHandlerID,i.value().clientID) & snapshot->mask;
+            while (snapshot->table.at(slot).serverConnectionHandlerID != 0)
+                slot = (slot + 1) & snapshot->mask;
+
+            snapshot->table[slot] = i.value();
+        }
+    }
+
+    auto old = m_active.fetchAndStoreOrdered(snapshot);
+    if (old)
+        m_pendingSnapshots.append(old);
+
+    m_pendingObjects.append(m_retiredObjects);
+    m_retiredObjects.clear();
+    if (!m_isReclaimScheduled)
+        Reclaim();
+}
+
+//! Frees unlinked snapshots and objects after every reader that could have seen them has left
+void VoiceChain::Reclaim()
+{
+    m_isReclaimScheduled = false;
+    if (m_pendingSnapshots.isEmpty() && m_pendingObjects.isEmpty())
+        return;
+
+    if (m_readers.loadAcquire() != 0)
+    {
+        m_isReclaimScheduled = true;
+        QTimer::singleShot(RECLAIM_RETRY_MSEC, this, SLOT(Reclaim()));
+        return;
+    }
+
+    qDeleteAll(m_pendingSnapshots);
+    m_pendingSnapshots.clear();
+
+    for (auto obj : m_pendingObjects)
+        obj->deleteLater();
+
+    m_pendingObjects.clear();
+}
+
+// process a volume, report gain changes to the ui
+static inline void processVolume(DspVolume* vol, TelemetryType type, uint64 serverConnectionHandlerID, anyID clientID, float *samples, int sampleCount, int channels)
+{
+    const auto kGainBefore = vol->getGainCurrent();
+    vol->process(samples,sampleCount,channels);
+    const auto kGainAfter = vol->getGainCurrent();
+    if (kGainAfter != kGainBefore)
+        Telemetry::instance()->Push(Telemetry::PlaybackProducer, type, serverConnectionHandlerID, clientID, kGainAfter);
+}
+
+//! Runs the resolved chain of a talker
+/*!
+ * \brief VoiceChain::onEditPlaybackVoiceDataEvent pre-processing voice event; no allocations, locks or lookups in module containers
+ * The block is converted once into a float bus, every stage runs on it, and it's dithered / saturated back to int16 once at the end.
+ * \param serverConnectionHandlerID the connection id of the server
+ * \param clientID the client-side runtime-id of the sender
+ * \param samples the sample array to manipulate
+ * \param sampleCount amount of samples in the array
+ * \param channels amount of channels
+ */
+void VoiceChain::onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short *samples, int sampleCount, int channels)
+{
+    m_readers.fetchAndAddOrdered(1);
+
+    auto snapshot = m_active.loadAcquire();
+    auto node = (snapshot) ? snapshot->find(serverConnectionHandlerID,clientID) : nullptr;
+    if (node)
+    {
+        const auto kBusSize = sampleCount * channels;
+        QVarLengthArray<float,BUS_PREALLOC> bus(kBusSize);
+        auto data = bus.data();
+        DspKernels::Int16ToFloat(samples, data, kBusSize);
+
+        auto isMuted = false;
+        if (auto muter = node->muter.get())
+        {
+            processVolume(muter, TelemetryType::MuterGain, serverConnectionHandlerID, clientID, data, sampleCount, channels);
+            isMuted = muter->isMuted();
+        }
+
+        if (!isMuted)
+        {
+#ifdef USE_RADIO
+            if (auto radio = node->radio.get())
+                radio->process(data,sampleCount,channels);
+#endif
+            if (auto agmu = node->agmu.get())
+            {
+                const auto kPeakBefore = agmu->GetPeak();
+                processVolume(agmu, TelemetryType::AgmuGain, serverConnectionHandlerID, clientID, data, sampleCount, channels);
+                if (agmu->GetPeak() != kPeakBefore)
+                    Telemetry::instance()->Push(Telemetry::PlaybackProducer, TelemetryType::AgmuPeak, serverConnectionHandlerID, clientID, agmu->GetPeak());
+            }
+
+            auto isGlobalDucked = false;
+            if (auto duckerGlobal = node->duckerGlobal.get())
+            {
+                processVolume(duckerGlobal, TelemetryType::DuckerGlobalGain, serverConnectionHandlerID, clientID, data, sampleCount, channels);
+                isGlobalDucked = (duckerGlobal->isProcessing() && duckerGlobal->getGainAdjustment());
+            }
+
+            auto duckerChannel = node->duckerChannel.get();
+            if (duckerChannel && !isGlobalDucked)
+                processVolume(duckerChannel, TelemetryType::DuckerChannelGain, serverConnectionHandlerID, clientID, data, sampleCount, channels);
+        }
+
+        DspKernels::FloatToInt16(data, samples, kBusSize, node->dither);
+    }
+
+    m_readers.fetchAndAddOrdered(-1);
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <QObject>
+#include <QMutex>
+#include <QHash>
+#include <QVector>
+#include <QList>
+#include <QAtomicInt>
+#include <QAtomicPointer>
+#include "teamspeak/public_definitions.h"
+#include "slot_table.h"
+#include "dsp_kernels.h"
+
+class DspVolume;
+class DspVolumeAGMU;
+class DspVolumeDucker;
+class DspRadio;
+
+class ChannelMuter;
+class Radio;
+class Agmu;
+class Ducker_Global;
+class Ducker_Channel;
+
+//! The resolved processing chain of one talker
+/*!
+ * Every stage is optional; an empty ref means the module does not process this talker.
+ * Nodes are built on the gui thread and only read on the playback thread. The slot generation
+ * is checked per block, so a stage removed by its module stops before the chain is rebuilt.
+ * The dither state is the exception: it's the talker's, advanced by its blocks like the stages' own state.
+ */
+struct VoiceChainNode
+{
+    uint64 serverConnectionHandlerID = 0;   // 0 marks an empty slot
+    anyID clientID = 0;
+    SlotRef<DspVolume*> muter;
+    SlotRef<DspRadio*> radio;
+    SlotRef<DspVolumeAGMU*> agmu;
+    SlotRef<DspVolumeDucker*> duckerGlobal;
+    SlotRef<DspVolumeDucker*> duckerChannel;
+    mutable DspKernels::DitherState dither;    // seeded per talker, so the talkers' dither doesn't correlate in the mix
+};
+
+//! Collects the nodes while the modules are asked to populate the chain
+class VoiceChainBuilder
+{
+public:
+    VoiceChainNode& node(uint64 serverConnectionHandlerID, anyID clientID);
+
+private:
+    friend class VoiceChain;
+    QHash<QPair<uint64,anyID>,VoiceChainNode> m_nodes;
+};
+
+//! Immutable, pre-allocated lookup table handed to the playback thread
+struct VoiceChainSnapshot
+{
+    QVector<VoiceChainNode> table;  // open addressing, size is a power of two
+    quint32 mask = 0;
+
+    const VoiceChainNode* find(uint64 serverConnectionHandlerID, anyID clientID) const;
+};
+
+class VoiceChain : public QObject
+{
+    Q_OBJECT
+
+public:
+    static VoiceChain* instance() {
+        static QMutex mutex;
+        if(!m_Instance) {
+            mutex.lock();
+
+            if(!m_Instance)
+                m_Instance = new VoiceChain;
+
+            mutex.unlock();
+        }
+        return m_Instance;
+    }
+
+    static void drop() {
+        static QMutex mutex;
+        mutex.lock();
+        delete m_Instance;
+        m_Instance = 0;
+        mutex.unlock();
+    }
+
+    void Init(ChannelMuter* muter, Radio* radio, Agmu* agmu, Ducker_Global* duckerGlobal, Ducker_Channel* duckerChannel);
+
+    // gui thread
+    void Invalidate();
+    void RebuildIfDirty();
+    void Retire(QObject* obj);
+
+    // playback thread
+    void onEditPlaybackVoiceDataEvent(uint64 serverConnectionHandlerID, anyID clientID, short* samples, int sampleCount, int channels);
+
+private slots:
+    void Rebuild();
+    void Reclaim();
+
+private:
+    //singleton
+    explicit VoiceChain();
+    ~VoiceChain() = default;
+    static VoiceChain* m_Instance;
+    VoiceChain(const VoiceChain &);
+    VoiceChain& operator=(const VoiceChain &);
+
+    ChannelMuter* m_muter = nullptr;
+    Radio* m_radio = nullptr;
+    Agmu* m_agmu = nullptr;
+    Ducker_Global* m_duckerGlobal = nullptr;
+    Ducker_Channel* m_duckerChannel = nullptr;
+
+    QAtomicPointer<VoiceChainSnapshot> m_active;
+    QAtomicInt m_readers;   // playback threads currently inside the chain
+
+    bool m_isDirty = false;
+    bool m_isReclaimScheduled = false;
+    QList<QObject*> m_retiredObjects;           // still reachable from the active snapshot
+    QList<VoiceChainSnapshot*> m_pendingSnapshots;  // unlinked, waiting for the readers to leave
+    QList<QObject*> m_pendingObjects;
+};
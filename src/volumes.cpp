@@ -1,9 +1,12 @@
 #include "volumes.h"
 
+#include <QVarLengthArray>
+
 #include "ts_logging_qt.h"
 
 #include "dsp_volume_ducker.h"
 #include "dsp_volume_agmu.h"
+#include "voice_chain.h"
 
 Volumes::Volumes(QObject *parent, Volume_Type volume_type) :
     QObject(parent)
@@ -17,10 +20,20 @@ Volumes::Volumes(QObject *parent, Volume_Type volume_type) :
  * \brief Volumes::AddVolume Helper function
  * \param serverConnectionHandlerID the connection id of the server
  * \param clientID the client id
+ * \return the new volume object, the existing one if there already is one, nullptr if the table is full
  */
 DspVolume* Volumes::AddVolume(uint64 serverConnectionHandlerID,anyID clientID)
 {
-    DspVolume* dsp_obj;
+    auto dsp_obj = m_volumes.value(serverConnectionHandlerID, clientID);
+    if (dsp_obj)
+        return dsp_obj;
+
+    if (m_volumes.isFull())
+    {
+        TSLogging::Error(QString("%1: Volume table full, not adding %2").arg(this->parent()->objectName()).arg(clientID), serverConnectionHandlerID, NULL);
+        return nullptr;
+    }
+
     if (m_volume_type == Volume_Type::DUCKER)
         dsp_obj = new DspVolumeDucker(this);
     else if (m_volume_type == Volume_Type::AGMU)
@@ -28,10 +41,8 @@ DspVolume* Volumes::AddVolume(uint64 serverConnectionHandlerID,anyID clientID)
     else
         dsp_obj = new DspVolume(this);
 
-    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
-    if (!m_volumes.contains(kKey))
-        m_volumes.insert(kKey, dsp_obj);
-
+    m_volumes.insert(serverConnectionHandlerID, clientID, dsp_obj);
+    VoiceChain::instance()->Invalidate();
     return dsp_obj;
 }
 
@@ -62,8 +73,7 @@ void Volumes::DeleteVolume(DspVolume *dspObj)
     if (m_volume_type == Volume_Type::DUCKER)   //should be unnecessary
         ((DspVolumeDucker*)dspObj)->setGainAdjustment(false);
 
-    dspObj->blockSignals(true);
-    dspObj->deleteLater();
+    VoiceChain::instance()->Retire(dspObj);   // the playback thread may still hold it
 }
 
 //! Remove a specific Volume object from the ServerChannelVolumes map
@@ -74,12 +84,9 @@ void Volumes::DeleteVolume(DspVolume *dspObj)
  */
 void Volumes::RemoveVolume(uint64 serverConnectionHandlerID, anyID clientID)
 {
-    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
-    if (!(m_volumes.contains(kKey)))
-        return;
-
-    auto dsp_obj = m_volumes.take(kKey);
-    DeleteVolume(dsp_obj);
+    DspVolume* dsp_obj;
+    if (m_volumes.take(serverConnectionHandlerID, clientID, dsp_obj))
+        DeleteVolume(dsp_obj);
 }
 
 //! Remove all Volume objects of a server
@@ -92,14 +99,16 @@ void Volumes::RemoveVolumes(uint64 serverConnectionHandlerID)
     if (m_volumes.isEmpty())
         return;
 
-    for (auto i = m_volumes.begin(); i != m_volumes.end(); ++i)
+    QVarLengthArray<anyID, 512> clients;
+    m_volumes.forEach([&](uint64 sc, anyID clientID, const SlotRef<DspVolume*>&)
     {
-        if (i.key().first == serverConnectionHandlerID)
-        {
-            auto dsp_obj = m_volumes.take(i.key());
-            DeleteVolume(dsp_obj);
-        }
-    }
+        if (sc == serverConnectionHandlerID)
+            clients.append(clientID);
+    });
+
+    for (auto clientID : clients)
+        RemoveVolume(serverConnectionHandlerID, clientID);
+
     //TSLogging::Log("Volumes: Server Volumes cleared",serverConnectionHandlerID,LogLevel_INFO);
 }
 
@@ -112,20 +121,27 @@ void Volumes::RemoveVolumes()
     if (m_volumes.isEmpty())
         return;
 
-    for (auto i = m_volumes.begin(); i != m_volumes.end(); ++i)
-        DeleteVolume(i.value());
+    QVarLengthArray<QPair<uint64,anyID>, 512> keys;
+    m_volumes.forEach([&](uint64 serverConnectionHandlerID, anyID clientID, const SlotRef<DspVolume*>&)
+    {
+        keys.append(qMakePair(serverConnectionHandlerID, clientID));
+    });
 
-    m_volumes.clear();
+    for (const auto &key : keys)
+        RemoveVolume(key.first, key.second);
 }
 
 bool Volumes::ContainsVolume(uint64 serverConnectionHandlerID, anyID clientID)
 {
-    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
-    return m_volumes.contains(kKey);
+    return m_volumes.contains(serverConnectionHandlerID, clientID);
 }
 
 DspVolume* Volumes::GetVolume(uint64 serverConnectionHandlerID, anyID clientID)
 {
-    const auto kKey = qMakePair(serverConnectionHandlerID, clientID);
-    return m_volumes.contains(kKey) ? m_volumes[kKey] : nullptr;
+    return m_volumes.value(serverConnectionHandlerID, clientID);
+}
+
+const VolumeTable& Volumes::GetVolumes() const
+{
+    return m_volumes;
 }
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <QObject>
-#include <QHash>
 #include "teamspeak/public_definitions.h"
 //#include "simple_volume.h"
 #include "dsp_volume.h"
+#include "slot_table.h"
+
+const int VOLUMES_CAPACITY = 4096;   // per module; the channel muter holds every member of my channel on every tab, 4 tabs of 500 fill half
+typedef SlotTable<DspVolume*, VOLUMES_CAPACITY> VolumeTable;
 
 class Volumes : public QObject
 {
@@ -28,6 +31,7 @@ public:
     void RemoveVolumes();
     bool ContainsVolume(uint64 serverConnectionHandlerID, anyID clientID);
     DspVolume* GetVolume(uint64 serverConnectionHandlerID, anyID clientID);
+    const VolumeTable& GetVolumes() const;
 
 signals:
 
@@ -36,6 +40,6 @@ public slots:
 protected:
 
 private:
-    QHash<QPair<uint64,anyID>, QPointer<DspVolume> > m_volumes;
+    VolumeTable m_volumes;
     Volume_Type m_volume_type;
 };